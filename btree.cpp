@@ -0,0 +1,388 @@
+#include "btree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "value.h"
+
+namespace {
+
+// 叶子 32 个条目约 800 字节，一次查找只触及树高个节点
+constexpr std::size_t MAX_KEYS = 32;
+
+// 节点中连续存放的排序数值：数字键取其值，字符串键统一为 +inf，
+// 数值相同时才需要解引用键本身比较
+double sortNumber(const ValuePtr& key) {
+    return key->isNumber() ? key->asNumber()
+                           : std::numeric_limits<double>::infinity();
+}
+
+}  // namespace
+
+struct BTreeMap::Node {
+    explicit Node(bool isLeaf) : leaf(isLeaf) {}
+
+    bool leaf;
+    std::size_t count = 0;
+    double numbers[MAX_KEYS];
+    ValuePtr keys[MAX_KEYS];
+};
+
+struct BTreeMap::Leaf : Node {
+    Leaf() : Node(true) {}
+
+    ValuePtr values[MAX_KEYS];
+    Leaf* prev = nullptr;
+    Leaf* next = nullptr;
+};
+
+// children[i] 中的键都小于 keys[i]，children[i + 1] 中的键都不小于 keys[i]
+struct BTreeMap::Internal : Node {
+    Internal() : Node(false) {}
+
+    Node* children[MAX_KEYS + 1];
+};
+
+namespace {
+
+using Node = BTreeMap::Node;
+using Leaf = BTreeMap::Leaf;
+using Internal = BTreeMap::Internal;
+
+void destroy(Node* node) {
+    if (node->leaf) {
+        delete static_cast<Leaf*>(node);
+        return;
+    }
+    auto internal = static_cast<Internal*>(node);
+    for (std::size_t i = 0; i <= internal->count; i++) {
+        destroy(internal->children[i]);
+    }
+    delete internal;
+}
+
+int compareAt(const Node& node, std::size_t index, double number,
+              const ValuePtr& key) {
+    if (node.numbers[index] < number) return -1;
+    if (node.numbers[index] > number) return 1;
+    return BTreeMap::compareKeys(node.keys[index], key);
+}
+
+// 第一个不小于（strict 时为大于）探测键的下标
+std::size_t searchNode(const Node& node, double number, const ValuePtr& key,
+                       bool strict) {
+    std::size_t low = 0;
+    std::size_t high = node.count;
+    while (low < high) {
+        std::size_t mid = (low + high) / 2;
+        int order = compareAt(node, mid, number, key);
+        if (order < 0 || (strict && order == 0)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// 沿内部节点下降到可能含有该键的叶子
+const Leaf* descend(const Node* node, double number, const ValuePtr& key) {
+    while (!node->leaf) {
+        auto internal = static_cast<const Internal*>(node);
+        node = internal->children[searchNode(*node, number, key, true)];
+    }
+    return static_cast<const Leaf*>(node);
+}
+
+// 在 index 处腾出一个键位置
+void openKeySlot(Node& node, std::size_t index) {
+    std::copy_backward(node.numbers + index, node.numbers + node.count,
+                       node.numbers + node.count + 1);
+    std::move_backward(node.keys + index, node.keys + node.count,
+                       node.keys + node.count + 1);
+}
+
+void closeKeySlot(Node& node, std::size_t index) {
+    std::copy(node.numbers + index + 1, node.numbers + node.count,
+              node.numbers + index);
+    std::move(node.keys + index + 1, node.keys + node.count,
+              node.keys + index);
+    node.keys[node.count - 1] = nullptr;
+}
+
+// 把 from 中 [begin, from.count) 的键移到 to 的开头
+void moveKeys(Node& from, std::size_t begin, Node& to) {
+    std::size_t n = from.count - begin;
+    std::copy(from.numbers + begin, from.numbers + from.count, to.numbers);
+    std::move(from.keys + begin, from.keys + from.count, to.keys);
+    to.count = n;
+    from.count = begin;
+}
+
+void insertIntoLeaf(Leaf& leaf, std::size_t index, double number,
+                    const ValuePtr& key, const ValuePtr& value) {
+    openKeySlot(leaf, index);
+    std::move_backward(leaf.values + index, leaf.values + leaf.count,
+                       leaf.values + leaf.count + 1);
+    leaf.numbers[index] = number;
+    leaf.keys[index] = key;
+    leaf.values[index] = value;
+    leaf.count++;
+}
+
+void insertIntoInternal(Internal& node, std::size_t index, double number,
+                        const ValuePtr& key, Node* right) {
+    openKeySlot(node, index);
+    std::copy_backward(node.children + index + 1,
+                       node.children + node.count + 1,
+                       node.children + node.count + 2);
+    node.numbers[index] = number;
+    node.keys[index] = key;
+    node.children[index + 1] = right;
+    node.count++;
+}
+
+// 子节点分裂后需要插入父节点的分隔键和右半节点
+struct Split {
+    Node* right = nullptr;
+    double number = 0;
+    ValuePtr key;
+};
+
+bool insertInto(Node* node, double number, const ValuePtr& key,
+                const ValuePtr& value, Split& split) {
+    if (node->leaf) {
+        auto leaf = static_cast<Leaf*>(node);
+        std::size_t index = searchNode(*leaf, number, key, false);
+        if (index < leaf->count &&
+            compareAt(*leaf, index, number, key) == 0) {
+            leaf->values[index] = value;
+            return false;
+        }
+        if (leaf->count < MAX_KEYS) {
+            insertIntoLeaf(*leaf, index, number, key, value);
+            return true;
+        }
+
+        // 叶子已满：对半分开，链入右侧，再插入对应的一半
+        auto right = new Leaf();
+        std::size_t half = MAX_KEYS / 2;
+        std::move(leaf->values + half, leaf->values + leaf->count,
+                  right->values);
+        moveKeys(*leaf, half, *right);
+        right->next = leaf->next;
+        right->prev = leaf;
+        if (leaf->next) leaf->next->prev = right;
+        leaf->next = right;
+        if (index <= half) {
+            insertIntoLeaf(*leaf, index, number, key, value);
+        } else {
+            insertIntoLeaf(*right, index - half, number, key, value);
+        }
+        split = {right, right->numbers[0], right->keys[0]};
+        return true;
+    }
+
+    auto internal = static_cast<Internal*>(node);
+    std::size_t index = searchNode(*internal, number, key, true);
+    Split child;
+    bool added = insertInto(internal->children[index], number, key, value,
+                            child);
+    if (!child.right) return added;
+    if (internal->count < MAX_KEYS) {
+        insertIntoInternal(*internal, index, child.number, child.key,
+                           child.right);
+        return added;
+    }
+
+    // 内部节点已满：中间的键上移，右半的键和子节点移到新节点
+    auto right = new Internal();
+    std::size_t mid = MAX_KEYS / 2;
+    split.number = internal->numbers[mid];
+    split.key = internal->keys[mid];
+    std::copy(internal->children + mid + 1,
+              internal->children + internal->count + 1, right->children);
+    moveKeys(*internal, mid + 1, *right);
+    internal->keys[mid] = nullptr;
+    internal->count = mid;
+    if (index <= mid) {
+        insertIntoInternal(*internal, index, child.number, child.key,
+                           child.right);
+    } else {
+        insertIntoInternal(*right, index - mid - 1, child.number, child.key,
+                           child.right);
+    }
+    split.right = right;
+    return added;
+}
+
+}  // namespace
+
+BTreeMap::BTreeMap() : root_(new Leaf()) {}
+
+BTreeMap::~BTreeMap() {
+    destroy(root_);
+}
+
+bool BTreeMap::isValidKey(const Value& key) {
+    if (key.isNumber()) return !std::isnan(key.asNumber());
+    return key.isString();
+}
+
+int BTreeMap::compareKeys(const ValuePtr& a, const ValuePtr& b) {
+    bool numberA = a->isNumber();
+    bool numberB = b->isNumber();
+    if (numberA != numberB) return numberA ? -1 : 1;
+    if (numberA) {
+        double x = a->asNumber();
+        double y = b->asNumber();
+        return x < y ? -1 : (x > y ? 1 : 0);
+    }
+    return static_cast<const StringValue&>(*a).view().compare(
+        static_cast<const StringValue&>(*b).view());
+}
+
+const ValuePtr* BTreeMap::find(const ValuePtr& key) const {
+    double number = sortNumber(key);
+    const Leaf* leaf = descend(root_, number, key);
+    std::size_t index = searchNode(*leaf, number, key, false);
+    if (index < leaf->count && compareAt(*leaf, index, number, key) == 0) {
+        return &leaf->values[index];
+    }
+    return nullptr;
+}
+
+bool BTreeMap::insert(const ValuePtr& key, const ValuePtr& value) {
+    Split split;
+    bool added = insertInto(root_, sortNumber(key), key, value, split);
+    if (split.right) {
+        // 根分裂，树增高一层
+        auto root = new Internal();
+        root->numbers[0] = split.number;
+        root->keys[0] = split.key;
+        root->children[0] = root_;
+        root->children[1] = split.right;
+        root->count = 1;
+        root_ = root;
+    }
+    if (added) {
+        size_++;
+        version_++;
+    }
+    return added;
+}
+
+bool BTreeMap::erase(const ValuePtr& key) {
+    double number = sortNumber(key);
+    std::vector<std::pair<Internal*, std::size_t>> path;
+    Node* node = root_;
+    while (!node->leaf) {
+        auto internal = static_cast<Internal*>(node);
+        std::size_t index = searchNode(*internal, number, key, true);
+        path.emplace_back(internal, index);
+        node = internal->children[index];
+    }
+    auto leaf = static_cast<Leaf*>(node);
+    std::size_t index = searchNode(*leaf, number, key, false);
+    if (index >= leaf->count || compareAt(*leaf, index, number, key) != 0) {
+        return false;
+    }
+    std::move(leaf->values + index + 1, leaf->values + leaf->count,
+              leaf->values + index);
+    leaf->values[leaf->count - 1] = nullptr;
+    closeKeySlot(*leaf, index);
+    leaf->count--;
+    size_--;
+    version_++;
+    if (leaf->count > 0 || path.empty()) return true;
+
+    // 叶子变空：从链表和父节点中摘除，父节点因此变空时继续向上
+    if (leaf->prev) leaf->prev->next = leaf->next;
+    if (leaf->next) leaf->next->prev = leaf->prev;
+    delete leaf;
+    while (true) {
+        auto [parent, child] = path.back();
+        path.pop_back();
+        if (parent->count > 0) {
+            // 删除子节点 child 及其左侧（child 为 0 时为右侧）的分隔键
+            closeKeySlot(*parent, child > 0 ? child - 1 : 0);
+            std::copy(parent->children + child + 1,
+                      parent->children + parent->count + 1,
+                      parent->children + child);
+            parent->count--;
+            break;
+        }
+        // 唯一的子节点已删除
+        delete parent;
+        if (path.empty()) {
+            root_ = new Leaf();
+            return true;
+        }
+    }
+    // 根只剩一个子节点时降低树高
+    while (!root_->leaf && root_->count == 0) {
+        auto old = static_cast<Internal*>(root_);
+        root_ = old->children[0];
+        delete old;
+    }
+    return true;
+}
+
+void BTreeMap::clear() {
+    destroy(root_);
+    root_ = new Leaf();
+    size_ = 0;
+    version_++;
+}
+
+BTreeMap::Position BTreeMap::first() const {
+    const Node* node = root_;
+    while (!node->leaf) node = static_cast<const Internal*>(node)->children[0];
+    if (node->count == 0) return {};
+    return {static_cast<const Leaf*>(node), 0};
+}
+
+BTreeMap::Position BTreeMap::last() const {
+    const Node* node = root_;
+    while (!node->leaf) {
+        auto internal = static_cast<const Internal*>(node);
+        node = internal->children[internal->count];
+    }
+    if (node->count == 0) return {};
+    return {static_cast<const Leaf*>(node), node->count - 1};
+}
+
+BTreeMap::Position BTreeMap::lowerBound(const ValuePtr& key,
+                                       bool strict) const {
+    double number = sortNumber(key);
+    const Leaf* leaf = descend(root_, number, key);
+    std::size_t index = searchNode(*leaf, number, key, strict);
+    if (index < leaf->count) return {leaf, index};
+    // 该叶子中的键都更小，答案是下一个叶子的第一个条目
+    return leaf->next ? Position{leaf->next, 0} : Position{};
+}
+
+BTreeMap::Position BTreeMap::next(Position position) const {
+    if (position.index + 1 < position.leaf->count) {
+        return {position.leaf, position.index + 1};
+    }
+    return position.leaf->next ? Position{position.leaf->next, 0}
+                               : Position{};
+}
+
+const ValuePtr& BTreeMap::keyAt(Position position) const {
+    return position.leaf->keys[position.index];
+}
+
+const ValuePtr& BTreeMap::valueAt(Position position) const {
+    return position.leaf->values[position.index];
+}
+
+void BTreeMap::forEach(
+    const std::function<void(const ValuePtr&, const ValuePtr&)>& fn) const {
+    for (Position at = first(); at.valid(); at = next(at)) {
+        fn(keyAt(at), valueAt(at));
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef BTREE_H
+#define BTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+class Value;
+template <typename T>
+class Ref;
+using ValuePtr = Ref<Value>;
+
+// 以数字或字符串为键的 B+ 树：条目只存放在叶子中，叶子按键序双向链接，
+// 区间扫描只需顺着链表前进。每个节点最多 32 个键，键的数值与键本身
+// 分别连续存放，数字键比较时不必解引用。
+// 顺序：所有数字排在所有字符串之前，数字按数值、字符串按字典序比较。
+// 删除时不合并节点，叶子变空才从树中摘除，因此节点可能不满
+class BTreeMap {
+public:
+    struct Node;
+    struct Leaf;
+    struct Internal;
+
+    // 指向某个条目的位置，leaf 为空表示结尾。
+    // 树发生结构修改（插入新键或删除）后，旧的位置失效
+    struct Position {
+        const Leaf* leaf = nullptr;
+        std::size_t index = 0;
+
+        bool valid() const {
+            return leaf != nullptr;
+        }
+    };
+
+    BTreeMap();
+    ~BTreeMap();
+    BTreeMap(const BTreeMap&) = delete;
+    BTreeMap& operator=(const BTreeMap&) = delete;
+
+    // 键必须是数字（不能是 NaN）或字符串
+    static bool isValidKey(const Value& key);
+
+    std::size_t size() const {
+        return size_;
+    }
+    // 每次结构修改后递增，用于判断保存的 Position 是否仍然有效
+    std::uint64_t version() const {
+        return version_;
+    }
+
+    // 找不到时返回 nullptr
+    const ValuePtr* find(const ValuePtr& key) const;
+    // 键已存在时替换值并返回 false
+    bool insert(const ValuePtr& key, const ValuePtr& value);
+    bool erase(const ValuePtr& key);
+    void clear();
+
+    Position first() const;
+    Position last() const;
+    // 第一个不小于 key（strict 时为大于 key）的条目
+    Position lowerBound(const ValuePtr& key, bool strict = false) const;
+    Position next(Position position) const;
+    const ValuePtr& keyAt(Position position) const;
+    const ValuePtr& valueAt(Position position) const;
+    // a < b 时返回负数，相等时返回 0
+    static int compareKeys(const ValuePtr& a, const ValuePtr& b);
+
+    // 按键序访问每个条目，回调中不能修改本树
+    void forEach(
+        const std::function<void(const ValuePtr&, const ValuePtr&)>& fn) const;
+
+private:
+    Node* root_;
+    std::size_t size_ = 0;
+    std::uint64_t version_ = 0;
+};
+
+#endif  // BTREE_H
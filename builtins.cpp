@@ -1,10 +1,19 @@
 #include "builtins.h"
 #include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <cmath>
 #include <cstdlib>
-#include <iostream>
+#include <limits>
 
 #include "error.h"
+#include "matrix.h"
+#include "parser.h"
+#include "port.h"
+#include "printer.h"
+#include "simd.h"
+#include "sort.h"
+#include "strsearch.h"
 
     // ========== 辅助函数 ==========
 double asNumber(ValuePtr arg) {
@@ -39,28 +48,52 @@ ValuePtr applyFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
     }
 
     // 4. 将列表参数展开
-    auto lastArgs = lastArg->toVector();
-    appliedArgs.insert(appliedArgs.end(), lastArgs.begin(), lastArgs.end());
+    for (auto& item : ListView(lastArg)) {
+        appliedArgs.push_back(item);
+    }
 
     // 5. 执行函数调用
     return env.apply(proc, appliedArgs);
 }
-ValuePtr display(const std::vector<ValuePtr>& args, EvalEnv& env) {
-    if (args.empty()) return std::make_shared<NilValue>();
+// args[index] 存在时必须是输出端口，否则使用当前输出端口
+static OutputPort& outputPortArgument(const std::vector<ValuePtr>& args,
+                                      size_t index, const char* who) {
+    if (index >= args.size()) return *OutputPort::current();
+    auto port = dynamic_cast<const PortValue*>(args[index].get());
+    if (!port) {
+        throw LispError(std::string(who) + ": expected an output port, got " +
+                        args[index]->toString());
+    }
+    return *port->getPort();
+}
 
-    if (auto str = std::dynamic_pointer_cast<StringValue>(args[0])) {
-        std::cout << str->getStringValue();
+// 字符串按原样写出，其他值写出其外部表示
+static void writeDisplay(OutputPort& port, const ValuePtr& value) {
+    if (auto str = dynamic_cast<const StringValue*>(value.get())) {
+        port.write(str->view());
     } else {
-        std::cout << args[0]->toString();
+        printValue(port, *value);
     }
+}
 
-    return std::make_shared<NilValue>();
+ValuePtr display(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (display obj [port])
+    if (args.empty()) return makeNil();
+    if (args.size() > 2) {
+        throw LispError("display requires one or two arguments");
+    }
+    writeDisplay(outputPortArgument(args, 1, "display"), args[0]);
+    return makeNil();
 }
 
 ValuePtr displayln(const std::vector<ValuePtr>& args, EvalEnv& env) {
-    display(args, env);
-    std::cout << std::endl;
-    return std::make_shared<NilValue>();
+    if (args.size() > 2) {
+        throw LispError("displayln requires one or two arguments");
+    }
+    OutputPort& port = outputPortArgument(args, 1, "displayln");
+    if (!args.empty()) writeDisplay(port, args[0]);
+    port.put('\n');
+    return makeNil();
 }
 
 ValuePtr error(const std::vector<ValuePtr>& args, EvalEnv& env) {
@@ -81,19 +114,26 @@ ValuePtr exitFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (!args.empty()) {
         code = static_cast<int>(args[0]->asNumber());
     }
+    // atexit 回调也会刷新，这里先刷新以免其他回调中途终止进程
+    OutputPort::flushAll();
     std::exit(code);
 }
 
 ValuePtr newline(const std::vector<ValuePtr>& args, EvalEnv& env) {
-    std::cout << std::endl;
-    return std::make_shared<NilValue>();
+    if (args.size() > 1) {
+        throw LispError("newline requires at most one argument");
+    }
+    outputPortArgument(args, 0, "newline").put('\n');
+    return makeNil();
 }
 
 ValuePtr print(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    OutputPort& port = *OutputPort::current();
     for (auto& arg : args) {
-        std::cout << arg->toString() << std::endl;
+        printValue(port, *arg);
+        port.put('\n');
     }
-    return std::make_shared<NilValue>();
+    return makeNil();
 }
 
 // ========== 类型检查库 ==========
@@ -109,18 +149,18 @@ ValuePtr isAtom(const std::vector<ValuePtr>& args, EvalEnv& env) {
     // 排除过程类型
     if (value->isProcedure()) isAtom = false;
 
-    return std::make_shared<BooleanValue>(isAtom);
+    return makeBoolean(isAtom);
 }
 ValuePtr isBoolean(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() != 1) throw LispError("boolean? requires one argument");
-    return std::make_shared<BooleanValue>(args[0]->isBoolean());
+    return makeBoolean(args[0]->isBoolean());
 }
 
 ValuePtr isInteger(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() != 1) throw LispError("integer? requires one argument");
-    if (!args[0]->isNumber()) return std::make_shared<BooleanValue>(false);
+    if (!args[0]->isNumber()) return makeBoolean(false);
     double num = args[0]->asNumber();
-    return std::make_shared<BooleanValue>(std::floor(num) == num);
+    return makeBoolean(std::floor(num) == num);
 }
 
 ValuePtr isList(const std::vector<ValuePtr>& args, EvalEnv& env) {
@@ -128,10 +168,10 @@ ValuePtr isList(const std::vector<ValuePtr>& args, EvalEnv& env) {
 
     ValuePtr obj = args[0];
     // 空列表是列表
-    if (obj->isNil()) return std::make_shared<BooleanValue>(true);
+    if (obj->isNil()) return makeBoolean(true);
 
     // 非pair类型不是列表
-    if (!obj->isPair()) return std::make_shared<BooleanValue>(false);
+    if (!obj->isPair()) return makeBoolean(false);
 
     // 检查是否以空列表结尾
     ValuePtr current = obj;
@@ -140,58 +180,50 @@ ValuePtr isList(const std::vector<ValuePtr>& args, EvalEnv& env) {
     }
 
     // 只有以空列表结尾的才是正确列表
-    return std::make_shared<BooleanValue>(current->isNil());
+    return makeBoolean(current->isNil());
 }
 
 ValuePtr isNumber(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() != 1) throw LispError("number? requires one argument");
-    return std::make_shared<BooleanValue>(args[0]->isNumber());
+    return makeBoolean(args[0]->isNumber());
 }
 
 ValuePtr isNull(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() != 1) throw LispError("null? requires one argument");
-    return std::make_shared<BooleanValue>(args[0]->isNil());
+    // 空表只有一个实例
+    return makeBoolean(args[0] == makeNil());
 }
 
 ValuePtr isPair(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() != 1) throw LispError("pair? requires one argument");
-    return std::make_shared<BooleanValue>(args[0]->isPair());
+    return makeBoolean(args[0]->isPair());
 }
 
 ValuePtr isProcedure(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() != 1) throw LispError("procedure? requires one argument");
-    return std::make_shared<BooleanValue>(args[0]->isProcedure());
+    return makeBoolean(args[0]->isProcedure());
 }
 
 ValuePtr isString(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() != 1) throw LispError("string? requires one argument");
 
-    // 核心修复：直接检查类型标签
-    return std::make_shared<BooleanValue>(
-        args[0]->toString().starts_with("\"") ||  // 快速检查引号
-        args[0]->isString()                       // 确保类型系统正确识别
-    );
+    return makeBoolean(args[0]->isString());
 }
 
 ValuePtr isSymbol(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() != 1) throw LispError("symbol? requires one argument");
-    return std::make_shared<BooleanValue>(args[0]->isSymbol());
+    return makeBoolean(args[0]->isSymbol());
 }
 
 // ========== 列表操作库 ==========
 ValuePtr append(const std::vector<ValuePtr>& args, EvalEnv& env) {
-    ValuePtr result = std::make_shared<NilValue>();
     std::vector<ValuePtr> elements;
-
     for (auto& list : args) {
-        auto vec = list->toVector();
-        elements.insert(elements.end(), vec.begin(), vec.end());
-    }
-
-    for (auto it = elements.rbegin(); it != elements.rend(); ++it) {
-        result = std::make_shared<PairValue>(*it, result);
+        for (auto& item : ListView(list)) {
+            elements.push_back(item);
+        }
     }
-    return result;
+    return CompactListValue::fromVector(std::move(elements));
 }
 
 ValuePtr car(const std::vector<ValuePtr>& args, EvalEnv& env) {
@@ -212,31 +244,34 @@ ValuePtr cdr(const std::vector<ValuePtr>& args, EvalEnv& env) {
 
 ValuePtr cons(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() != 2) throw LispError("cons requires two arguments");
-    return std::make_shared<PairValue>(args[0], args[1]);
+    return makeValue<PairValue>(args[0], args[1]);
 }
 
 ValuePtr length(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() != 1) throw LispError("length requires one argument");
 
-    int count = 0;
+    size_t count = 0;
     auto current = args[0];
     while (!current->isNil()) {
-        if (current->isPair()) {
+        if (auto range = dynamic_cast<RangeValue*>(current.get())) {
+            count += range->size();
+            break;
+        } else if (auto compact =
+                       dynamic_cast<CompactListValue*>(current.get())) {
+            count += compact->size();
+            current = compact->getTail();
+        } else if (current->isPair()) {
             count++;
             current = current->getCdr();
         } else {
             throw LispError("Argument to length must be a list");
         }
     }
-    return std::make_shared<NumericValue>(count);
+    return makeNumber(static_cast<double>(count));
 }
 
 ValuePtr list(const std::vector<ValuePtr>& args, EvalEnv& env) {
-    ValuePtr result = std::make_shared<NilValue>();
-    for (auto it = args.rbegin(); it != args.rend(); ++it) {
-        result = std::make_shared<PairValue>(*it, result);
-    }
-    return result;
+    return CompactListValue::fromVector(args);
 }
 
 ValuePtr mapFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
@@ -244,23 +279,24 @@ ValuePtr mapFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
 
     auto proc = args[0];
     auto listArg = args[1];
+    if (auto vector = dynamic_cast<VectorValue*>(listArg.get())) {
+        std::vector<ValuePtr> result;
+        result.reserve(vector->size());
+        for (size_t i = 0; i < vector->size(); i++) {
+            result.push_back(env.apply(proc, {vector->at(i)}));
+        }
+        return makePooledValue<VectorValue>(std::move(result));
+    }
     if (!listArg->isList()) {
         throw LispError("Second argument to map must be a list");
     }
 
-    auto elements = listArg->toVector();
     std::vector<ValuePtr> result;
-
-    for (auto& item : elements) {
-        auto mapped = env.apply(proc, {item});
-        result.push_back(mapped);
+    for (auto& item : ListView(listArg)) {
+        result.push_back(env.apply(proc, {item}));
     }
 
-    ValuePtr resultList = std::make_shared<NilValue>();
-    for (auto it = result.rbegin(); it != result.rend(); ++it) {
-        resultList = std::make_shared<PairValue>(*it, resultList);
-    }
-    return resultList;
+    return CompactListValue::fromVector(std::move(result));
 }
 
 ValuePtr filter(const std::vector<ValuePtr>& args, EvalEnv& env) {
@@ -268,25 +304,30 @@ ValuePtr filter(const std::vector<ValuePtr>& args, EvalEnv& env) {
 
     auto proc = args[0];
     auto listArg = args[1];
+    if (auto vector = dynamic_cast<VectorValue*>(listArg.get())) {
+        std::vector<ValuePtr> result;
+        for (size_t i = 0; i < vector->size(); i++) {
+            ValuePtr item = vector->at(i);
+            auto test = env.apply(proc, {item});
+            if (!test->isNil() && (!test->isBoolean() || test->getValue())) {
+                result.push_back(std::move(item));
+            }
+        }
+        return makePooledValue<VectorValue>(std::move(result));
+    }
     if (!listArg->isList()) {
         throw LispError("Second argument to filter must be a list");
     }
 
-    auto elements = listArg->toVector();
     std::vector<ValuePtr> result;
-
-    for (auto& item : elements) {
+    for (auto& item : ListView(listArg)) {
         auto test = env.apply(proc, {item});
         if (!test->isNil() && (!test->isBoolean() || test->getValue())) {
             result.push_back(item);
         }
     }
 
-    ValuePtr resultList = std::make_shared<NilValue>();
-    for (auto it = result.rbegin(); it != result.rend(); ++it) {
-        resultList = std::make_shared<PairValue>(*it, resultList);
-    }
-    return resultList;
+    return CompactListValue::fromVector(std::move(result));
 }
 
 ValuePtr reduce(const std::vector<ValuePtr>& args, EvalEnv& env) {
@@ -294,19 +335,141 @@ ValuePtr reduce(const std::vector<ValuePtr>& args, EvalEnv& env) {
 
     auto proc = args[0];
     auto listArg = args[1];
-    if (!listArg->isList()) {
+    ValuePtr result;
+    if (auto vector = dynamic_cast<VectorValue*>(listArg.get())) {
+        for (size_t i = 0; i < vector->size(); i++) {
+            ValuePtr item = vector->at(i);
+            result = result ? env.apply(proc, {result, item}) : item;
+        }
+    } else if (listArg->isList()) {
+        for (auto& item : ListView(listArg)) {
+            result = result ? env.apply(proc, {result, item}) : item;
+        }
+    } else {
         throw LispError("Second argument to reduce must be a list");
     }
-
-    auto elements = listArg->toVector();
-    if (elements.empty()) {
+    if (!result) {
         throw LispError("reduce requires non-empty list");
     }
+    return result;
+}
+
+// 元素个数必须能用 size_t 表示，否则转换没有定义
+static size_t toElementCount(double count) {
+    if (!std::isfinite(count) ||
+        count >= static_cast<double>(std::numeric_limits<size_t>::max())) {
+        throw LispError("range is too large");
+    }
+    return count > 0 ? static_cast<size_t>(count) : 0;
+}
+
+static size_t rangeCount(double start, double end, double step) {
+    if (step == 0) throw LispError("range step cannot be zero");
+    return toElementCount(std::ceil((end - start) / step));
+}
+
+static ValuePtr makeRange(double start, double step, size_t count) {
+    if (count == 0) return makeNil();
+    return makeValue<RangeValue>(start, step, count);
+}
+
+ValuePtr range(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (range end) / (range start end) / (range start end step)
+    if (args.empty() || args.size() > 3) {
+        throw LispError("range requires one to three arguments");
+    }
+    double start = args.size() == 1 ? 0 : asNumber(args[0]);
+    double end = asNumber(args.size() == 1 ? args[0] : args[1]);
+    double step = args.size() == 3 ? asNumber(args[2]) : 1;
+    return makeRange(start, step, rangeCount(start, end, step));
+}
+
+ValuePtr iota(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (iota count [start [step]])
+    if (args.empty() || args.size() > 3) {
+        throw LispError("iota requires one to three arguments");
+    }
+    double count = asNumber(args[0]);
+    if (count < 0 || std::floor(count) != count) {
+        throw LispError("iota count must be a non-negative integer");
+    }
+    double start = args.size() > 1 ? asNumber(args[1]) : 0;
+    double step = args.size() > 2 ? asNumber(args[2]) : 1;
+    return makeRange(start, step, toElementCount(count));
+}
+
+// ========== 转换器库 ==========
+static bool isTruthy(const ValuePtr& value) {
+    return !value->isNil() && (!value->isBoolean() || value->getValue());
+}
+
+// 单遍执行 map/filter 流水线，每个通过全部阶段的元素交给 sink，不构造中间列表
+static void runPipeline(const std::vector<TransducerValue::Stage>& stages,
+                        const ValuePtr& source, EvalEnv& env,
+                        const std::function<void(const ValuePtr&)>& sink) {
+    for (auto& element : ListView(source)) {
+        ValuePtr item = element;
+        bool keep = true;
+        for (auto& stage : stages) {
+            if (stage.kind == TransducerValue::Stage::Kind::Map) {
+                item = env.apply(stage.proc, {item});
+            } else if (!isTruthy(env.apply(stage.proc, {item}))) {
+                keep = false;
+                break;
+            }
+        }
+        if (keep) sink(item);
+    }
+}
+
+ValuePtr mapping(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("mapping requires one argument");
+    if (!args[0]->isProcedure()) {
+        throw LispError("Argument to mapping must be a procedure");
+    }
+    return makeValue<TransducerValue>(
+        std::vector<TransducerValue::Stage>{
+            {TransducerValue::Stage::Kind::Map, args[0]}});
+}
+
+ValuePtr filtering(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("filtering requires one argument");
+    if (!args[0]->isProcedure()) {
+        throw LispError("Argument to filtering must be a procedure");
+    }
+    return makeValue<TransducerValue>(
+        std::vector<TransducerValue::Stage>{
+            {TransducerValue::Stage::Kind::Filter, args[0]}});
+}
+
+ValuePtr composeFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (compose xf1 xf2 ...)：元素先经过 xf1，再经过 xf2
+    std::vector<TransducerValue::Stage> stages;
+    for (auto& arg : args) {
+        auto xf = dynamic_cast<TransducerValue*>(arg.get());
+        if (!xf) throw LispError("compose requires transducer arguments");
+        stages.insert(stages.end(), xf->getStages().begin(),
+                      xf->getStages().end());
+    }
+    return makeValue<TransducerValue>(std::move(stages));
+}
 
-    ValuePtr result = elements[0];
-    for (size_t i = 1; i < elements.size(); i++) {
-        result = env.apply(proc, {result, elements[i]});
+ValuePtr transduce(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 4) throw LispError("transduce requires four arguments");
+
+    auto xf = dynamic_cast<TransducerValue*>(args[0].get());
+    if (!xf) {
+        throw LispError("First argument to transduce must be a transducer");
+    }
+    auto proc = args[1];
+    if (!args[3]->isList()) {
+        throw LispError("Fourth argument to transduce must be a list");
     }
+
+    ValuePtr result = args[2];
+    runPipeline(xf->getStages(), args[3], env, [&](const ValuePtr& item) {
+        result = env.apply(proc, {result, item});
+    });
     return result;
 }
 
@@ -316,19 +479,19 @@ ValuePtr add(const std::vector<ValuePtr>& args, EvalEnv& env) {
     for (const auto& arg : args) {
         result += asNumber(arg);
     }
-    return std::make_shared<NumericValue>(result);
+    return makeNumber(result);
 }
 
 ValuePtr subtract(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.empty()) throw LispError("- requires at least one argument");
 
     double result = asNumber(args[0]);
-    if (args.size() == 1) return std::make_shared<NumericValue>(-result);
+    if (args.size() == 1) return makeNumber(-result);
 
     for (size_t i = 1; i < args.size(); i++) {
         result -= asNumber(args[i]);
     }
-    return std::make_shared<NumericValue>(result);
+    return makeNumber(result);
 }
 
 ValuePtr multiply(const std::vector<ValuePtr>& args, EvalEnv& env) {
@@ -336,33 +499,33 @@ ValuePtr multiply(const std::vector<ValuePtr>& args, EvalEnv& env) {
     for (const auto& arg : args) {
         result *= asNumber(arg);
     }
-    return std::make_shared<NumericValue>(result);
+    return makeNumber(result);
 }
 
 ValuePtr divide(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.empty()) throw LispError("/ requires at least one argument");
 
     double result = asNumber(args[0]);
-    if (args.size() == 1) return std::make_shared<NumericValue>(1.0 / result);
+    if (args.size() == 1) return makeNumber(1.0 / result);
 
     for (size_t i = 1; i < args.size(); i++) {
         double divisor = asNumber(args[i]);
         if (divisor == 0) throw LispError("Division by zero");
         result /= divisor;
     }
-    return std::make_shared<NumericValue>(result);
+    return makeNumber(result);
 }
 
 ValuePtr absFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() != 1) throw LispError("abs requires one argument");
-    return std::make_shared<NumericValue>(std::abs(asNumber(args[0])));
+    return makeNumber(std::abs(asNumber(args[0])));
 }
 
 ValuePtr expt(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() != 2) throw LispError("expt requires two arguments");
     double base = asNumber(args[0]);
     double exponent = asNumber(args[1]);
-    return std::make_shared<NumericValue>(std::pow(base, exponent));
+    return makeNumber(std::pow(base, exponent));
 }
 
 ValuePtr quotient(const std::vector<ValuePtr>& args, EvalEnv& env) {
@@ -370,7 +533,7 @@ ValuePtr quotient(const std::vector<ValuePtr>& args, EvalEnv& env) {
     double dividend = asNumber(args[0]);
     double divisor = asNumber(args[1]);
     if (divisor == 0) throw LispError("Division by zero");
-    return std::make_shared<NumericValue>(std::trunc(dividend / divisor));
+    return makeNumber(std::trunc(dividend / divisor));
 }
 
 ValuePtr modulo(const std::vector<ValuePtr>& args, EvalEnv& env) {
@@ -398,7 +561,7 @@ ValuePtr modulo(const std::vector<ValuePtr>& args, EvalEnv& env) {
         }
     }
 
-    return std::make_shared<NumericValue>(result);
+    return makeNumber(result);
 }
 
 ValuePtr remainderFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
@@ -418,31 +581,24 @@ ValuePtr remainderFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
         }
     }
 
-    return std::make_shared<NumericValue>(result);
+    return makeNumber(result);
 }
 
 // ========== 比较库 ==========
 ValuePtr eqFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() != 2) throw LispError("eq? requires two arguments");
 
+    // 同一对象（包括共享的空表、布尔值和小整数）直接成立
+    if (args[0] == args[1]) return makeBoolean(true);
 
     if (args[0]->isSymbol() && args[1]->isSymbol()) {
-        return std::make_shared<BooleanValue>(*args[0]->asSymbol() ==
-                                              *args[1]->asSymbol());
+        return makeBoolean(*args[0]->asSymbol() == *args[1]->asSymbol());
     }
-    // 数字和空列表特殊处理
+    // 数字特殊处理
     if (args[0]->isNumber() && args[1]->isNumber()) {
-        return std::make_shared<BooleanValue>(args[0]->asNumber() ==
-                                              args[1]->asNumber());
-    }
-
-    // 空列表处理
-    if (args[0]->isNil() && args[1]->isNil()) {
-        return std::make_shared<BooleanValue>(true);
+        return makeBoolean(args[0]->asNumber() == args[1]->asNumber());
     }
-
-    // 默认比较对象地址
-    return std::make_shared<BooleanValue>(args[0].get() == args[1].get());
+    return makeBoolean(false);
 }
 
 ValuePtr notFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
@@ -452,9 +608,9 @@ ValuePtr notFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
     // 使用 isBoolean() 和 toString() 结合判断
     if (args[0]->isBoolean()) {
         // 通过字符串表示判断布尔值
-        return std::make_shared<BooleanValue>(args[0]->toString() == "#f");
+        return makeBoolean(args[0]->toString() == "#f");
     }
-    return std::make_shared<BooleanValue>(false);
+    return makeBoolean(false);
 }
 
 
@@ -463,98 +619,82 @@ ValuePtr numEqual(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() < 2) throw LispError("= requires at least two arguments");
     for (size_t i = 0; i < args.size() - 1; i++) {
         if (asNumber(args[i]) != asNumber(args[i + 1])) {
-            return std::make_shared<BooleanValue>(false);
+            return makeBoolean(false);
         }
     }
-    return std::make_shared<BooleanValue>(true);
+    return makeBoolean(true);
 }
 
 ValuePtr lessThan(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() < 2) throw LispError("< requires at least two arguments");
     for (size_t i = 0; i < args.size() - 1; i++) {
         if (asNumber(args[i]) >= asNumber(args[i + 1])) {
-            return std::make_shared<BooleanValue>(false);
+            return makeBoolean(false);
         }
     }
-    return std::make_shared<BooleanValue>(true);
+    return makeBoolean(true);
 }
 
 ValuePtr greaterThan(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() < 2) throw LispError("> requires at least two arguments");
     for (size_t i = 0; i < args.size() - 1; i++) {
         if (asNumber(args[i]) <= asNumber(args[i + 1])) {
-            return std::make_shared<BooleanValue>(false);
+            return makeBoolean(false);
         }
     }
-    return std::make_shared<BooleanValue>(true);
+    return makeBoolean(true);
 }
 
 ValuePtr lessOrEqual(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() < 2) throw LispError("<= requires at least two arguments");
     for (size_t i = 0; i < args.size() - 1; i++) {
         if (asNumber(args[i]) > asNumber(args[i + 1])) {
-            return std::make_shared<BooleanValue>(false);
+            return makeBoolean(false);
         }
     }
-    return std::make_shared<BooleanValue>(true);
+    return makeBoolean(true);
 }
 
 ValuePtr greaterOrEqual(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() < 2) throw LispError(">= requires at least two arguments");
     for (size_t i = 0; i < args.size() - 1; i++) {
         if (asNumber(args[i]) < asNumber(args[i + 1])) {
-            return std::make_shared<BooleanValue>(false);
+            return makeBoolean(false);
         }
     }
-    return std::make_shared<BooleanValue>(true);
+    return makeBoolean(true);
 }
 
 ValuePtr evenPred(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() != 1) throw LispError("even? requires one argument");
     double n = asNumber(args[0]);
-    return std::make_shared<BooleanValue>(static_cast<int>(n) % 2 == 0);
+    return makeBoolean(static_cast<int>(n) % 2 == 0);
 }
 
 ValuePtr oddPred(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() != 1) throw LispError("odd? requires one argument");
     double n = asNumber(args[0]);
-    return std::make_shared<BooleanValue>(static_cast<int>(n) % 2 != 0);
+    return makeBoolean(static_cast<int>(n) % 2 != 0);
 }
 
 ValuePtr zeroPred(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() != 1) throw LispError("zero? requires one argument");
     double n = asNumber(args[0]);
-    return std::make_shared<BooleanValue>(n == 0.0);
+    return makeBoolean(n == 0.0);
 }
 
 ValuePtr equalFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() != 2) throw LispError("equal? requires two arguments");
+    return makeBoolean(valuesEqual(args[0], args[1]));
+}
 
-    // 使用 std::function 代替 auto 声明递归函数
-    std::function<bool(ValuePtr, ValuePtr)> deepEqual;
-    deepEqual = [&](ValuePtr a, ValuePtr b) -> bool {
-        // 类型不同直接返回false
-        if (a->getType() != b->getType()) return false;
-
-        // 特殊类型处理
-        if (a->isNil()) return b->isNil();
-        if (a->isBoolean()) return a->toString() == b->toString();
-        if (a->isNumber()) return a->asNumber() == b->asNumber();
-        if (a->isString()) return a->getString() == b->getString();
-        if (a->isSymbol()) return *a->asSymbol() == *b->asSymbol();
-
-        // 列表递归比较
-        if (a->isPair()) {
-            return deepEqual(a->getCar(), b->getCar()) &&
-                   deepEqual(a->getCdr(), b->getCdr());
-        }
-
-        // 其他类型使用指针比较
-        return a.get() == b.get();
-    };
-
-    return std::make_shared<BooleanValue>(deepEqual(args[0], args[1]));
+ValuePtr equalHashFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("equal-hash requires one argument");
+    // 只保留 double 能精确表示的低 53 位
+    constexpr std::size_t mask = (std::size_t{1} << 53) - 1;
+    return makeNumber(static_cast<double>(equalHash(args[0]) & mask));
 }
+
 ValuePtr countLeaves(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (args.size() != 1) throw LispError("count-leaves requires one argument");
 
@@ -577,7 +717,7 @@ ValuePtr countLeaves(const std::vector<ValuePtr>& args, EvalEnv& env) {
         return sum;
     };
 
-    return std::make_shared<NumericValue>(count(args[0]));
+    return makeNumber(count(args[0]));
 }
 
 ValuePtr memqFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
@@ -592,10 +732,1550 @@ ValuePtr memqFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
         list = list->getCdr();
     }
 
-    return std::make_shared<BooleanValue>(false);
+    return makeBoolean(false);
+}
+// ========== 哈希表库 ==========
+static HashTableValue& asHashTable(const ValuePtr& value, const char* who) {
+    auto table = dynamic_cast<HashTableValue*>(value.get());
+    if (!table) {
+        throw LispError(std::string("First argument to ") + who +
+                        " must be a hash table");
+    }
+    return *table;
+}
+
+ValuePtr makeHashTable(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (make-hash-table [eq?|eqv?|equal?])，默认按 equal? 比较键
+    if (args.size() > 1) {
+        throw LispError("make-hash-table requires at most one argument");
+    }
+    auto equality = HashTableValue::KeyEquality::Equal;
+    if (!args.empty()) {
+        auto builtin = dynamic_cast<BuiltinProcValue*>(args[0].get());
+        if (builtin && builtin->getFunc() == eqFunc) {
+            equality = HashTableValue::KeyEquality::Eqv;
+        } else if (!builtin || builtin->getFunc() != equalFunc) {
+            throw LispError("make-hash-table expects eq?, eqv? or equal?");
+        }
+    }
+    // 哈希表通常比创建它的求值活得更久，因此总在对象池中创建
+    return makePooledValue<HashTableValue>(equality);
+}
+
+ValuePtr isHashTable(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("hash-table? requires one argument");
+    return makeBoolean(dynamic_cast<HashTableValue*>(args[0].get()) !=
+                       nullptr);
+}
+
+ValuePtr hashRef(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (hash-ref table key [default])：default 为过程时调用它的结果
+    if (args.size() != 2 && args.size() != 3) {
+        throw LispError("hash-ref requires two or three arguments");
+    }
+    auto& table = asHashTable(args[0], "hash-ref");
+    if (auto value = table.find(args[1])) return *value;
+    if (args.size() == 2) {
+        throw LispError("hash-ref: no value for key " + args[1]->toString());
+    }
+    if (args[2]->isProcedure()) return env.apply(args[2], {});
+    return args[2];
+}
+
+ValuePtr hashSet(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 3) throw LispError("hash-set! requires three arguments");
+    auto& table = asHashTable(args[0], "hash-set!");
+    table.set(args[1], args[2]);
+    return makeNil();
+}
+
+ValuePtr hashDelete(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 2) {
+        throw LispError("hash-delete! requires two arguments");
+    }
+    asHashTable(args[0], "hash-delete!").remove(args[1]);
+    return makeNil();
+}
+
+ValuePtr hashContains(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 2) {
+        throw LispError("hash-contains? requires two arguments");
+    }
+    return makeBoolean(asHashTable(args[0], "hash-contains?").find(args[1]) !=
+                       nullptr);
+}
+
+ValuePtr hashCount(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("hash-count requires one argument");
+    return makeNumber(
+        static_cast<double>(asHashTable(args[0], "hash-count").size()));
+}
+
+ValuePtr hashClear(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("hash-clear! requires one argument");
+    asHashTable(args[0], "hash-clear!").clear();
+    return makeNil();
+}
+
+ValuePtr hashForEach(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (hash-for-each table proc)：对每个条目调用 (proc key value)
+    if (args.size() != 2) {
+        throw LispError("hash-for-each requires two arguments");
+    }
+    auto& table = asHashTable(args[0], "hash-for-each");
+    ValuePtr proc = args[1];
+    table.forEach([&](const ValuePtr& key, const ValuePtr& value) {
+        env.apply(proc, {key, value});
+    });
+    return makeNil();
+}
+
+ValuePtr hashFold(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (hash-fold table proc init)：依次计算 (proc key value acc)
+    if (args.size() != 3) throw LispError("hash-fold requires three arguments");
+    auto& table = asHashTable(args[0], "hash-fold");
+    ValuePtr proc = args[1];
+    ValuePtr result = args[2];
+    table.forEach([&](const ValuePtr& key, const ValuePtr& value) {
+        result = env.apply(proc, {key, value, result});
+    });
+    return result;
+}
+
+// ========== 向量库 ==========
+static VectorValue& asVector(const ValuePtr& value, const char* who) {
+    auto vector = dynamic_cast<VectorValue*>(value.get());
+    if (!vector) {
+        throw LispError(std::string("First argument to ") + who +
+                        " must be a vector");
+    }
+    return *vector;
+}
+
+// 检查下标是在范围内的非负整数
+static size_t checkedIndex(size_t size, const ValuePtr& index,
+                           const char* who) {
+    if (!index->isNumber()) {
+        throw LispError(std::string(who) + " index must be a number");
+    }
+    double value = index->asNumber();
+    if (value != std::floor(value) || value < 0 ||
+        value >= static_cast<double>(size)) {
+        throw LispError(std::string(who) + ": index " + index->toString() +
+                        " out of range [0, " + std::to_string(size) + ")");
+    }
+    return static_cast<size_t>(value);
+}
+
+// 向量通常比创建它的求值活得更久，在对象池中创建，不占用区域的块
+static ValuePtr makeVector(std::vector<ValuePtr> elements) {
+    return makePooledValue<VectorValue>(std::move(elements));
+}
+
+ValuePtr makeVectorFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (make-vector n [fill])，默认填充 0
+    if (args.size() != 1 && args.size() != 2) {
+        throw LispError("make-vector requires one or two arguments");
+    }
+    double count = asNumber(args[0]);
+    if (count != std::floor(count) || count < 0) {
+        throw LispError("make-vector length must be a non-negative integer");
+    }
+    ValuePtr fill = args.size() == 2 ? args[1] : makeNumber(0);
+    return makeVector(
+        std::vector<ValuePtr>(static_cast<size_t>(count), fill));
+}
+
+ValuePtr vectorFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return makeVector(args);
+}
+
+ValuePtr isVector(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("vector? requires one argument");
+    return makeBoolean(dynamic_cast<VectorValue*>(args[0].get()) != nullptr);
+}
+
+ValuePtr vectorRef(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 2) throw LispError("vector-ref requires two arguments");
+    auto& vector = asVector(args[0], "vector-ref");
+    return vector.at(checkedIndex(vector.size(), args[1], "vector-ref"));
+}
+
+ValuePtr vectorSet(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 3) {
+        throw LispError("vector-set! requires three arguments");
+    }
+    auto& vector = asVector(args[0], "vector-set!");
+    vector.set(checkedIndex(vector.size(), args[1], "vector-set!"), args[2]);
+    return makeNil();
+}
+
+ValuePtr vectorLength(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) {
+        throw LispError("vector-length requires one argument");
+    }
+    return makeNumber(
+        static_cast<double>(asVector(args[0], "vector-length").size()));
+}
+
+ValuePtr vectorToList(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) {
+        throw LispError("vector->list requires one argument");
+    }
+    return CompactListValue::fromVector(
+        asVector(args[0], "vector->list").getElements());
+}
+
+ValuePtr listToVector(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) {
+        throw LispError("list->vector requires one argument");
+    }
+    if (!args[0]->isList()) {
+        throw LispError("Argument to list->vector must be a list");
+    }
+    return makeVector(ListView(args[0]).toVector());
+}
+
+// ========== 类型化数组库 ==========
+template <typename T>
+static ValuePtr makeTypedArray(std::vector<T> elements) {
+    return makePooledValue<TypedArrayValue<T>>(std::move(elements));
+}
+
+// 按类型化数组的实际元素类型调用 fn
+template <typename Fn>
+static ValuePtr visitTypedArray(const ValuePtr& value, const char* who,
+                                Fn&& fn) {
+    auto base = value.get();
+    if (auto array = dynamic_cast<F64VectorValue*>(base)) return fn(*array);
+    if (auto array = dynamic_cast<S64VectorValue*>(base)) return fn(*array);
+    if (auto array = dynamic_cast<U8VectorValue*>(base)) return fn(*array);
+    throw LispError(std::string(who) + " expects a typed array, got " +
+                    value->toString());
+}
+
+static TypedArrayBase& asTypedArray(const ValuePtr& value, const char* who) {
+    auto array = dynamic_cast<TypedArrayBase*>(value.get());
+    if (!array) {
+        throw LispError(std::string("First argument to ") + who +
+                        " must be a typed array");
+    }
+    return *array;
+}
+
+template <typename T>
+static std::vector<T> typedElements(const std::vector<ValuePtr>& values) {
+    std::vector<T> elements;
+    elements.reserve(values.size());
+    for (auto& value : values) {
+        elements.push_back(TypedArrayValue<T>::fromNumber(asNumber(value)));
+    }
+    return elements;
+}
+
+template <typename T>
+static ValuePtr makeTypedVector(const std::vector<ValuePtr>& args) {
+    // (make-f64vector n [fill])，默认填充 0
+    std::string who = std::string("make-") +
+                      TypedArrayValue<T>::elementName() + "vector";
+    if (args.size() != 1 && args.size() != 2) {
+        throw LispError(who + " requires one or two arguments");
+    }
+    double count = asNumber(args[0]);
+    if (count != std::floor(count) || count < 0) {
+        throw LispError(who + " length must be a non-negative integer");
+    }
+    T fill = args.size() == 2
+                 ? TypedArrayValue<T>::fromNumber(asNumber(args[1]))
+                 : T{};
+    return makeTypedArray(std::vector<T>(static_cast<size_t>(count), fill));
+}
+
+template <typename T>
+static ValuePtr listToTypedVector(const std::vector<ValuePtr>& args) {
+    std::string who =
+        std::string("list->") + TypedArrayValue<T>::elementName() + "vector";
+    if (args.size() != 1) throw LispError(who + " requires one argument");
+    if (auto vector = dynamic_cast<VectorValue*>(args[0].get())) {
+        return makeTypedArray(typedElements<T>(vector->getElements()));
+    }
+    if (!args[0]->isList()) {
+        throw LispError("Argument to " + who + " must be a list or vector");
+    }
+    return makeTypedArray(typedElements<T>(ListView(args[0]).toVector()));
+}
+
+ValuePtr f64Vector(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return makeTypedArray(typedElements<double>(args));
+}
+
+ValuePtr s64Vector(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return makeTypedArray(typedElements<std::int64_t>(args));
+}
+
+ValuePtr u8Vector(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return makeTypedArray(typedElements<std::uint8_t>(args));
+}
+
+ValuePtr makeF64Vector(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return makeTypedVector<double>(args);
+}
+
+ValuePtr makeS64Vector(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return makeTypedVector<std::int64_t>(args);
+}
+
+ValuePtr makeU8Vector(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return makeTypedVector<std::uint8_t>(args);
+}
+
+ValuePtr listToF64Vector(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return listToTypedVector<double>(args);
+}
+
+ValuePtr listToS64Vector(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return listToTypedVector<std::int64_t>(args);
+}
+
+ValuePtr listToU8Vector(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return listToTypedVector<std::uint8_t>(args);
+}
+
+ValuePtr isTypedArray(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("array? requires one argument");
+    return makeBoolean(dynamic_cast<TypedArrayBase*>(args[0].get()) !=
+                       nullptr);
+}
+
+ValuePtr arrayLength(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("array-length requires one argument");
+    return makeNumber(
+        static_cast<double>(asTypedArray(args[0], "array-length").size()));
+}
+
+ValuePtr arrayRef(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 2) throw LispError("array-ref requires two arguments");
+    auto& array = asTypedArray(args[0], "array-ref");
+    return makeNumber(
+        array.numberAt(checkedIndex(array.size(), args[1], "array-ref")));
+}
+
+ValuePtr arraySet(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 3) throw LispError("array-set! requires three arguments");
+    auto& array = asTypedArray(args[0], "array-set!");
+    array.setNumber(checkedIndex(array.size(), args[1], "array-set!"),
+                    asNumber(args[2]));
+    return makeNil();
+}
+
+ValuePtr arrayToList(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("array->list requires one argument");
+    auto& array = asTypedArray(args[0], "array->list");
+    std::vector<ValuePtr> result;
+    result.reserve(array.size());
+    for (size_t i = 0; i < array.size(); i++) {
+        result.push_back(makeNumber(array.numberAt(i)));
+    }
+    return CompactListValue::fromVector(std::move(result));
+}
+
+// 逐元素运算的一个操作数：同类型的数组，或广播到每个元素的数值（step 为 0）
+template <typename T>
+struct ArrayOperand {
+    const T* data = nullptr;
+    size_t step = 0;
+    size_t size = 0;
+    T scalar{};
+};
+
+template <typename T>
+static void resolveOperand(const ValuePtr& value, ArrayOperand<T>& operand,
+                           const char* who) {
+    if (auto array = dynamic_cast<TypedArrayValue<T>*>(value.get())) {
+        operand.data = array->getElements().data();
+        operand.step = 1;
+        operand.size = array->size();
+    } else if (value->isNumber()) {
+        operand.scalar = TypedArrayValue<T>::fromNumber(value->asNumber());
+        operand.data = &operand.scalar;
+    } else {
+        throw LispError(std::string(who) + " expects " +
+                        TypedArrayValue<T>::elementName() +
+                        "vector or number operands, got " + value->toString());
+    }
+}
+
+// 解析二元运算的两个操作数，返回元素个数
+template <typename T>
+static size_t resolveOperands(const std::vector<ValuePtr>& args,
+                              ArrayOperand<T>& x, ArrayOperand<T>& y,
+                              const char* who) {
+    resolveOperand(args[0], x, who);
+    resolveOperand(args[1], y, who);
+    if (x.step && y.step && x.size != y.size) {
+        throw LispError(std::string(who) + " requires arrays of equal length");
+    }
+    return x.step ? x.size : y.size;
+}
+
+// 至少一个操作数是类型化数组，另一个按它的元素类型解析
+static const ValuePtr& arrayOperand(const std::vector<ValuePtr>& args,
+                                    const char* who) {
+    if (args.size() != 2) {
+        throw LispError(std::string(who) + " requires two arguments");
+    }
+    return dynamic_cast<TypedArrayBase*>(args[0].get()) ? args[0] : args[1];
+}
+
+static ValuePtr arrayArithmetic(const std::vector<ValuePtr>& args,
+                                ArithmeticOp op, const char* who) {
+    return visitTypedArray(
+        arrayOperand(args, who), who, [&]<typename T>(TypedArrayValue<T>&) {
+            ArrayOperand<T> x, y;
+            size_t n = resolveOperands(args, x, y, who);
+            if (op == ArithmeticOp::Divide &&
+                std::find(y.data, y.data + (y.step ? n : 1), T{}) !=
+                    y.data + (y.step ? n : 1)) {
+                throw LispError("Division by zero");
+            }
+            std::vector<T> result(n);
+            arithmetic(op, x.data, x.step, y.data, y.step, result.data(), n);
+            return makeTypedArray(std::move(result));
+        });
+}
+
+// 比较结果是由 0 和 1 组成的 u8vector
+static ValuePtr arrayCompare(const std::vector<ValuePtr>& args, CompareOp op,
+                             const char* who) {
+    return visitTypedArray(
+        arrayOperand(args, who), who, [&]<typename T>(TypedArrayValue<T>&) {
+            ArrayOperand<T> x, y;
+            size_t n = resolveOperands(args, x, y, who);
+            std::vector<std::uint8_t> mask(n);
+            compare(op, x.data, x.step, y.data, y.step, mask.data(), n);
+            return makeTypedArray(std::move(mask));
+        });
+}
+
+ValuePtr arrayAdd(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return arrayArithmetic(args, ArithmeticOp::Add, "array+");
+}
+
+ValuePtr arraySubtract(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return arrayArithmetic(args, ArithmeticOp::Subtract, "array-");
+}
+
+ValuePtr arrayMultiply(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return arrayArithmetic(args, ArithmeticOp::Multiply, "array*");
+}
+
+ValuePtr arrayDivide(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return arrayArithmetic(args, ArithmeticOp::Divide, "array/");
+}
+
+ValuePtr arrayLess(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return arrayCompare(args, CompareOp::Less, "array<");
+}
+
+ValuePtr arrayLessEqual(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return arrayCompare(args, CompareOp::LessEqual, "array<=");
+}
+
+ValuePtr arrayGreater(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return arrayCompare(args, CompareOp::Greater, "array>");
+}
+
+ValuePtr arrayGreaterEqual(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return arrayCompare(args, CompareOp::GreaterEqual, "array>=");
+}
+
+ValuePtr arrayEqual(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return arrayCompare(args, CompareOp::Equal, "array=");
+}
+
+ValuePtr arraySum(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("array-sum requires one argument");
+    return visitTypedArray(args[0], "array-sum", [](auto& array) {
+        auto& elements = array.getElements();
+        return makeNumber(
+            static_cast<double>(sum(elements.data(), elements.size())));
+    });
+}
+
+ValuePtr arrayDot(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 2) throw LispError("array-dot requires two arguments");
+    return visitTypedArray(
+        args[0], "array-dot", [&]<typename T>(TypedArrayValue<T>& x) {
+            auto y = dynamic_cast<TypedArrayValue<T>*>(args[1].get());
+            if (!y || y->size() != x.size()) {
+                throw LispError(
+                    "array-dot requires two arrays of the same type and "
+                    "length");
+            }
+            return makeNumber(static_cast<double>(
+                dot(x.getElements().data(), y->getElements().data(),
+                    x.size())));
+        });
+}
+
+ValuePtr arrayMin(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("array-min requires one argument");
+    return visitTypedArray(args[0], "array-min", [](auto& array) {
+        if (array.size() == 0) throw LispError("array-min of empty array");
+        return makeNumber(static_cast<double>(
+            minElement(array.getElements().data(), array.size())));
+    });
+}
+
+ValuePtr arrayMax(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("array-max requires one argument");
+    return visitTypedArray(args[0], "array-max", [](auto& array) {
+        if (array.size() == 0) throw LispError("array-max of empty array");
+        return makeNumber(static_cast<double>(
+            maxElement(array.getElements().data(), array.size())));
+    });
+}
+
+// ========== 矩阵库 ==========
+static MatrixValue& asMatrix(const ValuePtr& value, const char* who) {
+    auto matrix = dynamic_cast<MatrixValue*>(value.get());
+    if (!matrix) {
+        throw LispError(std::string(who) + " expects a matrix, got " +
+                        value->toString());
+    }
+    return *matrix;
+}
+
+static ValuePtr makeMatrixValue(size_t rows, size_t cols,
+                                std::vector<double> data) {
+    return makePooledValue<MatrixValue>(rows, cols, std::move(data));
+}
+
+// 列表或向量中的元素
+static std::vector<ValuePtr> sequenceElements(const ValuePtr& value,
+                                              const char* who) {
+    if (auto vector = dynamic_cast<VectorValue*>(value.get())) {
+        return vector->getElements();
+    }
+    if (auto array = dynamic_cast<TypedArrayBase*>(value.get())) {
+        std::vector<ValuePtr> elements;
+        elements.reserve(array->size());
+        for (size_t i = 0; i < array->size(); i++) {
+            elements.push_back(makeNumber(array->numberAt(i)));
+        }
+        return elements;
+    }
+    if (!value->isList()) {
+        throw LispError(std::string(who) + " expects a list or vector, got " +
+                        value->toString());
+    }
+    return ListView(value).toVector();
+}
+
+static size_t matrixDimension(const ValuePtr& value, const char* who) {
+    double count = asNumber(value);
+    if (count != std::floor(count) || count < 0) {
+        throw LispError(std::string(who) +
+                        " dimensions must be non-negative integers");
+    }
+    return static_cast<size_t>(count);
+}
+
+ValuePtr makeMatrix(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (make-matrix rows cols [fill])，默认填充 0
+    if (args.size() != 2 && args.size() != 3) {
+        throw LispError("make-matrix requires two or three arguments");
+    }
+    size_t rows = matrixDimension(args[0], "make-matrix");
+    size_t cols = matrixDimension(args[1], "make-matrix");
+    double fill = args.size() == 3 ? asNumber(args[2]) : 0.0;
+    return makeMatrixValue(rows, cols,
+                           std::vector<double>(rows * cols, fill));
+}
+
+ValuePtr listToMatrix(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (list->matrix '((1 2) (3 4)))：每个元素是一行，各行长度必须相同
+    if (args.size() != 1) throw LispError("list->matrix requires one argument");
+    auto rowValues = sequenceElements(args[0], "list->matrix");
+    size_t cols = 0;
+    std::vector<double> data;
+    for (size_t i = 0; i < rowValues.size(); i++) {
+        auto row = sequenceElements(rowValues[i], "list->matrix");
+        if (i == 0) {
+            cols = row.size();
+            data.reserve(rowValues.size() * cols);
+        } else if (row.size() != cols) {
+            throw LispError("list->matrix rows must have the same length");
+        }
+        for (auto& element : row) data.push_back(asNumber(element));
+    }
+    return makeMatrixValue(rowValues.size(), cols, std::move(data));
+}
+
+ValuePtr matrixToList(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("matrix->list requires one argument");
+    auto& matrix = asMatrix(args[0], "matrix->list");
+    std::vector<ValuePtr> rows;
+    rows.reserve(matrix.rows());
+    for (size_t i = 0; i < matrix.rows(); i++) {
+        std::vector<ValuePtr> row;
+        row.reserve(matrix.cols());
+        for (size_t j = 0; j < matrix.cols(); j++) {
+            row.push_back(makeNumber(matrix.at(i, j)));
+        }
+        rows.push_back(CompactListValue::fromVector(std::move(row)));
+    }
+    return CompactListValue::fromVector(std::move(rows));
 }
+
+ValuePtr isMatrix(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("matrix? requires one argument");
+    return makeBoolean(dynamic_cast<MatrixValue*>(args[0].get()) != nullptr);
+}
+
+ValuePtr matrixRows(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("matrix-rows requires one argument");
+    return makeNumber(
+        static_cast<double>(asMatrix(args[0], "matrix-rows").rows()));
+}
+
+ValuePtr matrixCols(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("matrix-cols requires one argument");
+    return makeNumber(
+        static_cast<double>(asMatrix(args[0], "matrix-cols").cols()));
+}
+
+ValuePtr matrixRef(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 3) throw LispError("matrix-ref requires three arguments");
+    auto& matrix = asMatrix(args[0], "matrix-ref");
+    size_t row = checkedIndex(matrix.rows(), args[1], "matrix-ref");
+    size_t col = checkedIndex(matrix.cols(), args[2], "matrix-ref");
+    return makeNumber(matrix.at(row, col));
+}
+
+ValuePtr matrixSet(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 4) throw LispError("matrix-set! requires four arguments");
+    auto& matrix = asMatrix(args[0], "matrix-set!");
+    size_t row = checkedIndex(matrix.rows(), args[1], "matrix-set!");
+    size_t col = checkedIndex(matrix.cols(), args[2], "matrix-set!");
+    matrix.set(row, col, asNumber(args[3]));
+    return makeNil();
+}
+
+ValuePtr matrixMul(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 2) throw LispError("matrix-mul requires two arguments");
+    auto& a = asMatrix(args[0], "matrix-mul");
+    auto& b = asMatrix(args[1], "matrix-mul");
+    if (a.cols() != b.rows()) {
+        throw LispError("matrix-mul: cannot multiply " +
+                        std::to_string(a.rows()) + "x" +
+                        std::to_string(a.cols()) + " by " +
+                        std::to_string(b.rows()) + "x" +
+                        std::to_string(b.cols()));
+    }
+    std::vector<double> result(a.rows() * b.cols());
+    matrixMultiply(a.getData().data(), b.getData().data(), result.data(),
+                   a.rows(), a.cols(), b.cols());
+    return makeMatrixValue(a.rows(), b.cols(), std::move(result));
+}
+
+ValuePtr transpose(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("transpose requires one argument");
+    auto& matrix = asMatrix(args[0], "transpose");
+    std::vector<double> result(matrix.rows() * matrix.cols());
+    matrixTranspose(matrix.getData().data(), result.data(), matrix.rows(),
+                    matrix.cols());
+    return makeMatrixValue(matrix.cols(), matrix.rows(), std::move(result));
+}
+
+ValuePtr matVec(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (mat-vec m v)：v 为 f64vector，结果也是 f64vector
+    if (args.size() != 2) throw LispError("mat-vec requires two arguments");
+    auto& matrix = asMatrix(args[0], "mat-vec");
+    auto vector = dynamic_cast<F64VectorValue*>(args[1].get());
+    if (!vector || vector->size() != matrix.cols()) {
+        throw LispError("mat-vec requires an f64vector of length " +
+                        std::to_string(matrix.cols()));
+    }
+    std::vector<double> result(matrix.rows());
+    matrixVector(matrix.getData().data(), vector->getElements().data(),
+                 result.data(), matrix.rows(), matrix.cols());
+    return makeTypedArray(std::move(result));
+}
+
+// 矩阵与同形状的矩阵或数值之间的逐元素运算
+static ValuePtr matrixArithmetic(const std::vector<ValuePtr>& args,
+                                 ArithmeticOp op, const char* who) {
+    if (args.size() != 2) {
+        throw LispError(std::string(who) + " requires two arguments");
+    }
+    auto& shape =
+        asMatrix(dynamic_cast<MatrixValue*>(args[0].get()) ? args[0] : args[1],
+                 who);
+    ArrayOperand<double> x, y;
+    for (auto [value, operand] : {std::pair{&args[0], &x}, {&args[1], &y}}) {
+        if (auto matrix = dynamic_cast<MatrixValue*>(value->get())) {
+            if (matrix->rows() != shape.rows() ||
+                matrix->cols() != shape.cols()) {
+                throw LispError(std::string(who) +
+                                " requires matrices of the same shape");
+            }
+            operand->data = matrix->getData().data();
+            operand->step = 1;
+        } else {
+            operand->scalar = asNumber(*value);
+            operand->data = &operand->scalar;
+        }
+    }
+    size_t n = shape.getData().size();
+    if (op == ArithmeticOp::Divide &&
+        std::find(y.data, y.data + (y.step ? n : 1), 0.0) !=
+            y.data + (y.step ? n : 1)) {
+        throw LispError("Division by zero");
+    }
+    std::vector<double> result(n);
+    arithmetic(op, x.data, x.step, y.data, y.step, result.data(), n);
+    return makeMatrixValue(shape.rows(), shape.cols(), std::move(result));
+}
+
+ValuePtr matrixAdd(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return matrixArithmetic(args, ArithmeticOp::Add, "matrix+");
+}
+
+ValuePtr matrixSubtract(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return matrixArithmetic(args, ArithmeticOp::Subtract, "matrix-");
+}
+
+ValuePtr matrixMultiplyElements(const std::vector<ValuePtr>& args,
+                                EvalEnv& env) {
+    return matrixArithmetic(args, ArithmeticOp::Multiply, "matrix*");
+}
+
+ValuePtr matrixDivide(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    return matrixArithmetic(args, ArithmeticOp::Divide, "matrix/");
+}
+
+// ========== 排序库 ==========
+// 比较过程为内置的 < 或 > 时的方向，其余返回 0
+static int nativeOrder(const ValuePtr& proc) {
+    auto builtin = dynamic_cast<BuiltinProcValue*>(proc.get());
+    if (!builtin) return 0;
+    if (builtin->getFunc() == lessThan) return 1;
+    if (builtin->getFunc() == greaterThan) return -1;
+    return 0;
+}
+
+// 稳定排序一组值：全部是数值且比较过程为 < 或 > 时按数值键在原生代码中
+// 排序（可并行），否则逐次调用比较过程
+static void sortValues(std::vector<ValuePtr>& items, const ValuePtr& proc,
+                       EvalEnv& env) {
+    if (int order = nativeOrder(proc)) {
+        bool numeric = std::all_of(items.begin(), items.end(),
+                                   [](auto& item) { return item->isNumber(); });
+        if (numeric) {
+            std::vector<std::pair<double, size_t>> keys;
+            keys.reserve(items.size());
+            for (size_t i = 0; i < items.size(); i++) {
+                keys.emplace_back(items[i]->asNumber(), i);
+            }
+            if (order > 0) {
+                parallelMergeSort(keys, [](auto& a, auto& b) {
+                    return a.first < b.first;
+                });
+            } else {
+                parallelMergeSort(keys, [](auto& a, auto& b) {
+                    return a.first > b.first;
+                });
+            }
+            std::vector<ValuePtr> sorted;
+            sorted.reserve(items.size());
+            for (auto& key : keys) sorted.push_back(items[key.second]);
+            items = std::move(sorted);
+            return;
+        }
+    }
+    mergeSort(items, [&](const ValuePtr& a, const ValuePtr& b) {
+        return isTruthy(env.apply(proc, {a, b}));
+    });
+}
+
+// 类型化数组只能用 < 或 > 排序，直接排序原始元素
+static ValuePtr sortTypedArray(const ValuePtr& value, const ValuePtr& proc,
+                               bool inPlace, const char* who) {
+    int order = nativeOrder(proc);
+    if (!order) {
+        throw LispError(std::string(who) +
+                        " on a typed array requires < or > as comparator");
+    }
+    return visitTypedArray(value, who, [&](auto& array) -> ValuePtr {
+        auto elements = array.getElements();
+        using T = typename decltype(elements)::value_type;
+        if (order > 0) {
+            parallelMergeSort(elements, [](T a, T b) { return a < b; });
+        } else {
+            parallelMergeSort(elements, [](T a, T b) { return a > b; });
+        }
+        if (!inPlace) return makeTypedArray(std::move(elements));
+        array.getElements() = std::move(elements);
+        return makeNil();
+    });
+}
+
+ValuePtr sortFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (sort seq less?)：返回排好序的新列表/向量，原序列不变
+    if (args.size() != 2) throw LispError("sort requires two arguments");
+    const ValuePtr& seq = args[0];
+    if (dynamic_cast<TypedArrayBase*>(seq.get())) {
+        return sortTypedArray(seq, args[1], false, "sort");
+    }
+    if (auto vector = dynamic_cast<VectorValue*>(seq.get())) {
+        auto items = vector->getElements();
+        sortValues(items, args[1], env);
+        return makePooledValue<VectorValue>(std::move(items));
+    }
+    if (!seq->isList()) {
+        throw LispError("First argument to sort must be a list or vector");
+    }
+    auto items = ListView(seq).toVector();
+    sortValues(items, args[1], env);
+    return CompactListValue::fromVector(std::move(items));
+}
+
+ValuePtr sortInPlace(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (sort! vec less?)：原地排序向量；比较过程出错时向量保持不变
+    if (args.size() != 2) throw LispError("sort! requires two arguments");
+    if (dynamic_cast<TypedArrayBase*>(args[0].get())) {
+        return sortTypedArray(args[0], args[1], true, "sort!");
+    }
+    auto vector = dynamic_cast<VectorValue*>(args[0].get());
+    if (!vector) throw LispError("First argument to sort! must be a vector");
+    auto items = vector->getElements();
+    sortValues(items, args[1], env);
+    for (size_t i = 0; i < items.size(); i++) {
+        vector->set(i, std::move(items[i]));
+    }
+    return makeNil();
+}
+
+// ========== 持久化数据结构库 ==========
+// 参数必须是指定种类的持久化字典/集合
+static const PersistentMapValue& asPersistentMap(
+    const ValuePtr& value, PersistentMapValue::Kind kind, const char* who) {
+    auto map = dynamic_cast<const PersistentMapValue*>(value.get());
+    if (!map || map->kind() != kind) {
+        throw LispError(std::string("First argument to ") + who +
+                        (kind == PersistentMapValue::Kind::Set
+                             ? " must be a persistent set"
+                             : " must be a persistent map"));
+    }
+    return *map;
+}
+
+static const PersistentVector& asPersistentVector(const ValuePtr& value,
+                                                  const char* who) {
+    auto vector = dynamic_cast<const PersistentVectorValue*>(value.get());
+    if (!vector) {
+        throw LispError(std::string("First argument to ") + who +
+                        " must be a persistent vector");
+    }
+    return vector->getVector();
+}
+
+// 节点在各版本间共享、寿命无法预知，因此在对象池中创建
+static ValuePtr makePersistentMap(PersistentMap map,
+                                  PersistentMapValue::Kind kind) {
+    return makePooledValue<PersistentMapValue>(std::move(map), kind);
+}
+
+static ValuePtr makePersistentVector(PersistentVector vector) {
+    return makePooledValue<PersistentVectorValue>(std::move(vector));
+}
+
+// 把 args[first..] 中成对的键和值依次加入 map
+static PersistentMap assocPairs(PersistentMap map,
+                                const std::vector<ValuePtr>& args,
+                                size_t first, const char* who) {
+    if ((args.size() - first) % 2 != 0) {
+        throw LispError(std::string(who) + " requires key/value pairs");
+    }
+    for (size_t i = first; i < args.size(); i += 2) {
+        map = map.assoc(args[i], args[i + 1]);
+    }
+    return map;
+}
+
+ValuePtr pmapFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (pmap key value ...)
+    return makePersistentMap(assocPairs(PersistentMap(), args, 0, "pmap"),
+                             PersistentMapValue::Kind::Map);
+}
+
+ValuePtr isPmap(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("pmap? requires one argument");
+    auto map = dynamic_cast<const PersistentMapValue*>(args[0].get());
+    return makeBoolean(map && map->kind() == PersistentMapValue::Kind::Map);
+}
+
+ValuePtr pmapAssoc(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (pmap-assoc map key value ...)：返回新字典，原字典不变
+    if (args.size() < 3) {
+        throw LispError("pmap-assoc requires at least three arguments");
+    }
+    auto& map =
+        asPersistentMap(args[0], PersistentMapValue::Kind::Map, "pmap-assoc");
+    return makePersistentMap(assocPairs(map.getMap(), args, 1, "pmap-assoc"),
+                             PersistentMapValue::Kind::Map);
+}
+
+ValuePtr pmapDissoc(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 2) throw LispError("pmap-dissoc requires two arguments");
+    auto& map =
+        asPersistentMap(args[0], PersistentMapValue::Kind::Map, "pmap-dissoc");
+    return makePersistentMap(map.getMap().dissoc(args[1]),
+                             PersistentMapValue::Kind::Map);
+}
+
+ValuePtr pmapGet(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (pmap-get map key [default])：与 hash-ref 相同，default 可以是过程
+    if (args.size() != 2 && args.size() != 3) {
+        throw LispError("pmap-get requires two or three arguments");
+    }
+    auto& map =
+        asPersistentMap(args[0], PersistentMapValue::Kind::Map, "pmap-get");
+    if (auto value = map.getMap().find(args[1])) return *value;
+    if (args.size() == 2) {
+        throw LispError("pmap-get: no value for key " + args[1]->toString());
+    }
+    if (args[2]->isProcedure()) return env.apply(args[2], {});
+    return args[2];
+}
+
+ValuePtr pmapContains(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 2) {
+        throw LispError("pmap-contains? requires two arguments");
+    }
+    auto& map = asPersistentMap(args[0], PersistentMapValue::Kind::Map,
+                                "pmap-contains?");
+    return makeBoolean(map.getMap().find(args[1]) != nullptr);
+}
+
+ValuePtr pmapCount(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("pmap-count requires one argument");
+    auto& map =
+        asPersistentMap(args[0], PersistentMapValue::Kind::Map, "pmap-count");
+    return makeNumber(static_cast<double>(map.getMap().size()));
+}
+
+ValuePtr pmapToList(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // 返回 ((key . value) ...) 形式的关联列表，顺序不确定
+    if (args.size() != 1) throw LispError("pmap->list requires one argument");
+    auto& map =
+        asPersistentMap(args[0], PersistentMapValue::Kind::Map, "pmap->list");
+    std::vector<ValuePtr> entries;
+    entries.reserve(map.getMap().size());
+    map.getMap().forEach([&](const ValuePtr& key, const ValuePtr& value) {
+        entries.push_back(makeValue<PairValue>(key, value));
+    });
+    return CompactListValue::fromVector(std::move(entries));
+}
+
+ValuePtr psetFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (pset item ...)
+    PersistentMap set;
+    for (auto& item : args) {
+        set = set.assoc(item, makeBoolean(true));
+    }
+    return makePersistentMap(std::move(set), PersistentMapValue::Kind::Set);
+}
+
+ValuePtr isPset(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("pset? requires one argument");
+    auto set = dynamic_cast<const PersistentMapValue*>(args[0].get());
+    return makeBoolean(set && set->kind() == PersistentMapValue::Kind::Set);
+}
+
+ValuePtr psetAdd(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 2) throw LispError("pset-add requires two arguments");
+    auto& set =
+        asPersistentMap(args[0], PersistentMapValue::Kind::Set, "pset-add");
+    return makePersistentMap(
+        set.getMap().assoc(args[1], makeBoolean(true)),
+        PersistentMapValue::Kind::Set);
+}
+
+ValuePtr psetRemove(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 2) throw LispError("pset-remove requires two arguments");
+    auto& set =
+        asPersistentMap(args[0], PersistentMapValue::Kind::Set, "pset-remove");
+    return makePersistentMap(set.getMap().dissoc(args[1]),
+                             PersistentMapValue::Kind::Set);
+}
+
+ValuePtr psetContains(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 2) {
+        throw LispError("pset-contains? requires two arguments");
+    }
+    auto& set = asPersistentMap(args[0], PersistentMapValue::Kind::Set,
+                                "pset-contains?");
+    return makeBoolean(set.getMap().find(args[1]) != nullptr);
+}
+
+ValuePtr psetCount(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("pset-count requires one argument");
+    auto& set =
+        asPersistentMap(args[0], PersistentMapValue::Kind::Set, "pset-count");
+    return makeNumber(static_cast<double>(set.getMap().size()));
+}
+
+ValuePtr psetToList(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("pset->list requires one argument");
+    auto& set =
+        asPersistentMap(args[0], PersistentMapValue::Kind::Set, "pset->list");
+    std::vector<ValuePtr> items;
+    items.reserve(set.getMap().size());
+    set.getMap().forEach(
+        [&](const ValuePtr& key, const ValuePtr&) { items.push_back(key); });
+    return CompactListValue::fromVector(std::move(items));
+}
+
+ValuePtr pvecFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (pvec item ...)
+    PersistentVector vector;
+    for (auto& item : args) vector = vector.conj(item);
+    return makePersistentVector(std::move(vector));
+}
+
+ValuePtr isPvec(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("pvec? requires one argument");
+    return makeBoolean(
+        dynamic_cast<const PersistentVectorValue*>(args[0].get()) != nullptr);
+}
+
+ValuePtr pvecConj(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (pvec-conj vector item ...)：在末尾追加，返回新向量
+    if (args.size() < 2) {
+        throw LispError("pvec-conj requires at least two arguments");
+    }
+    PersistentVector vector = asPersistentVector(args[0], "pvec-conj");
+    for (size_t i = 1; i < args.size(); i++) {
+        vector = vector.conj(args[i]);
+    }
+    return makePersistentVector(std::move(vector));
+}
+
+ValuePtr pvecNth(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 2) throw LispError("pvec-nth requires two arguments");
+    auto& vector = asPersistentVector(args[0], "pvec-nth");
+    return vector.nth(checkedIndex(vector.size(), args[1], "pvec-nth"));
+}
+
+ValuePtr pvecAssoc(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (pvec-assoc vector index item)：index 等于长度时在末尾追加
+    if (args.size() != 3) {
+        throw LispError("pvec-assoc requires three arguments");
+    }
+    auto& vector = asPersistentVector(args[0], "pvec-assoc");
+    size_t index = checkedIndex(vector.size() + 1, args[1], "pvec-assoc");
+    return makePersistentVector(vector.assoc(index, args[2]));
+}
+
+ValuePtr pvecCount(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("pvec-count requires one argument");
+    return makeNumber(
+        static_cast<double>(asPersistentVector(args[0], "pvec-count").size()));
+}
+
+ValuePtr pvecToList(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("pvec->list requires one argument");
+    auto& vector = asPersistentVector(args[0], "pvec->list");
+    std::vector<ValuePtr> items;
+    items.reserve(vector.size());
+    vector.forEach([&](const ValuePtr& item) { items.push_back(item); });
+    return CompactListValue::fromVector(std::move(items));
+}
+
+// ========== 有序字典库 ==========
+static Ref<OrderedMapValue> asOrderedMap(const ValuePtr& value,
+                                         const char* who) {
+    auto map = dynamicRefCast<OrderedMapValue>(value);
+    if (!map) {
+        throw LispError(std::string("First argument to ") + who +
+                        " must be an ordered map");
+    }
+    return map;
+}
+
+static void checkOrderedKey(const ValuePtr& key, const char* who) {
+    if (!BTreeMap::isValidKey(*key)) {
+        throw LispError(std::string(who) +
+                        ": key must be a number or a string, got " +
+                        key->toString());
+    }
+}
+
+ValuePtr makeOrderedMap(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (!args.empty()) throw LispError("make-omap requires no arguments");
+    return makePooledValue<OrderedMapValue>();
+}
+
+ValuePtr isOrderedMap(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("omap? requires one argument");
+    return makeBoolean(dynamic_cast<OrderedMapValue*>(args[0].get()) !=
+                       nullptr);
+}
+
+ValuePtr omapInsert(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 3) {
+        throw LispError("omap-insert! requires three arguments");
+    }
+    auto map = asOrderedMap(args[0], "omap-insert!");
+    checkOrderedKey(args[1], "omap-insert!");
+    map->getTree().insert(args[1], args[2]);
+    return makeNil();
+}
+
+ValuePtr omapDelete(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 2) {
+        throw LispError("omap-delete! requires two arguments");
+    }
+    auto map = asOrderedMap(args[0], "omap-delete!");
+    checkOrderedKey(args[1], "omap-delete!");
+    map->getTree().erase(args[1]);
+    return makeNil();
+}
+
+ValuePtr omapRef(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (omap-ref map key [default])：与 hash-ref 相同，default 可以是过程
+    if (args.size() != 2 && args.size() != 3) {
+        throw LispError("omap-ref requires two or three arguments");
+    }
+    auto map = asOrderedMap(args[0], "omap-ref");
+    checkOrderedKey(args[1], "omap-ref");
+    if (auto value = map->getTree().find(args[1])) return *value;
+    if (args.size() == 2) {
+        throw LispError("omap-ref: no value for key " + args[1]->toString());
+    }
+    if (args[2]->isProcedure()) return env.apply(args[2], {});
+    return args[2];
+}
+
+ValuePtr omapContains(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 2) {
+        throw LispError("omap-contains? requires two arguments");
+    }
+    auto map = asOrderedMap(args[0], "omap-contains?");
+    checkOrderedKey(args[1], "omap-contains?");
+    return makeBoolean(map->getTree().find(args[1]) != nullptr);
+}
+
+ValuePtr omapCount(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("omap-count requires one argument");
+    return makeNumber(static_cast<double>(
+        asOrderedMap(args[0], "omap-count")->getTree().size()));
+}
+
+// 返回 position 处的条目 (key . value)，字典为空时报错
+static ValuePtr orderedEntry(const BTreeMap& tree, BTreeMap::Position position,
+                             const char* who) {
+    if (!position.valid()) {
+        throw LispError(std::string(who) + ": ordered map is empty");
+    }
+    return makeValue<PairValue>(tree.keyAt(position), tree.valueAt(position));
+}
+
+ValuePtr omapMin(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("omap-min requires one argument");
+    auto map = asOrderedMap(args[0], "omap-min");
+    return orderedEntry(map->getTree(), map->getTree().first(), "omap-min");
+}
+
+ValuePtr omapMax(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("omap-max requires one argument");
+    auto map = asOrderedMap(args[0], "omap-max");
+    return orderedEntry(map->getTree(), map->getTree().last(), "omap-max");
+}
+
+ValuePtr omapRange(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (omap-range map [lower [upper]])：键在 [lower, upper) 内的条目组成的
+    // 惰性列表，省略或为 #f 的一侧不设边界
+    if (args.empty() || args.size() > 3) {
+        throw LispError("omap-range requires one to three arguments");
+    }
+    auto map = asOrderedMap(args[0], "omap-range");
+    ValuePtr bounds[2];
+    for (size_t i = 1; i < args.size(); i++) {
+        if (args[i]->isBoolean() && !args[i]->getValue()) continue;
+        checkOrderedKey(args[i], "omap-range");
+        bounds[i - 1] = args[i];
+    }
+    return OrderedRangeValue::make(map, bounds[0], bounds[1]);
+}
+
+ValuePtr omapToList(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // 按键的顺序返回 ((key . value) ...)
+    if (args.size() != 1) throw LispError("omap->list requires one argument");
+    auto map = asOrderedMap(args[0], "omap->list");
+    std::vector<ValuePtr> entries;
+    entries.reserve(map->getTree().size());
+    map->getTree().forEach([&](const ValuePtr& key, const ValuePtr& value) {
+        entries.push_back(makeValue<PairValue>(key, value));
+    });
+    return CompactListValue::fromVector(std::move(entries));
+}
+
+ValuePtr omapForEach(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (omap-for-each map proc)：按键的顺序调用 (proc key value)。
+    // 沿惰性区间前进，proc 修改字典时也能安全地继续
+    if (args.size() != 2) {
+        throw LispError("omap-for-each requires two arguments");
+    }
+    auto map = asOrderedMap(args[0], "omap-for-each");
+    ValuePtr proc = args[1];
+    ValuePtr node = OrderedRangeValue::make(map, nullptr, nullptr);
+    while (node->isPair()) {
+        const ValuePtr& entry = node->getCar();
+        env.apply(proc, {entry->getCar(), entry->getCdr()});
+        node = ValuePtr(node->getCdr());
+    }
+    return makeNil();
+}
+
+// ========== 字符串库 ==========
+// 下标和长度都以字节计
+static const StringValue& asStringValue(const ValuePtr& value,
+                                        const char* who) {
+    auto str = dynamic_cast<const StringValue*>(value.get());
+    if (!str) {
+        throw LispError(std::string(who) + ": expected a string, got " +
+                        value->toString());
+    }
+    return *str;
+}
+
+// 拼接结果不超过该长度时直接复制，否则建立 rope 节点
+constexpr size_t ROPE_MIN_LENGTH = 64;
+
+ValuePtr stringAppend(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // 反复 (string-append acc piece) 时只新建 rope 节点，不复制 acc 的内容
+    Ref<StringValue> result;
+    for (auto& arg : args) {
+        if (asStringValue(arg, "string-append").length() == 0) continue;
+        auto piece = dynamicRefCast<StringValue>(arg);
+        if (!result) {
+            result = std::move(piece);
+        } else if (result->length() + piece->length() <= ROPE_MIN_LENGTH) {
+            std::string joined(result->view());
+            joined += piece->view();
+            result = makeValue<StringValue>(std::move(joined));
+        } else {
+            result = makeValue<StringValue>(result, std::move(piece));
+        }
+    }
+    if (!result) return makeValue<StringValue>(std::string());
+    return result;
+}
+
+ValuePtr stringLength(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) {
+        throw LispError("string-length requires one argument");
+    }
+    return makeNumber(static_cast<double>(
+        asStringValue(args[0], "string-length").length()));
+}
+
+ValuePtr substring(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (substring s start [end])：与 s 共享缓冲区，不复制字符
+    if (args.size() != 2 && args.size() != 3) {
+        throw LispError("substring requires two or three arguments");
+    }
+    auto& str = asStringValue(args[0], "substring");
+    size_t end = args.size() == 3
+                     ? checkedIndex(str.length() + 1, args[2], "substring")
+                     : str.length();
+    size_t start = checkedIndex(end + 1, args[1], "substring");
+    return str.slice(start, end - start);
+}
+
+ValuePtr stringIndex(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (string-index s pattern [start])：pattern 第一次出现的下标，没有时为 #f
+    if (args.size() != 2 && args.size() != 3) {
+        throw LispError("string-index requires two or three arguments");
+    }
+    auto& str = asStringValue(args[0], "string-index");
+    auto& pattern = asStringValue(args[1], "string-index");
+    size_t start = args.size() == 3 ? checkedIndex(str.length() + 1, args[2],
+                                                   "string-index")
+                                    : 0;
+    size_t found = findSubstring(str.view(), pattern.view(), start);
+    if (found == std::string_view::npos) return makeBoolean(false);
+    return makeNumber(static_cast<double>(found));
+}
+
+ValuePtr stringSplit(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (string-split s separator)：各段都是 s 的切片。相邻的分隔符之间
+    // 产生空字符串
+    if (args.size() != 2) {
+        throw LispError("string-split requires two arguments");
+    }
+    auto& str = asStringValue(args[0], "string-split");
+    auto& separator = asStringValue(args[1], "string-split");
+    if (separator.length() == 0) {
+        throw LispError("string-split: separator must not be empty");
+    }
+    std::string_view text = str.view();
+    std::string_view sep = separator.view();
+    std::vector<ValuePtr> parts;
+    size_t begin = 0;
+    while (true) {
+        size_t found = findSubstring(text, sep, begin);
+        if (found == std::string_view::npos) break;
+        parts.push_back(str.slice(begin, found - begin));
+        begin = found + sep.size();
+    }
+    parts.push_back(str.slice(begin, text.size() - begin));
+    return CompactListValue::fromVector(std::move(parts));
+}
+
+ValuePtr stringJoin(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (string-join strings [separator])，默认不加分隔符
+    if (args.size() != 1 && args.size() != 2) {
+        throw LispError("string-join requires one or two arguments");
+    }
+    if (!args[0]->isList()) {
+        throw LispError("First argument to string-join must be a list");
+    }
+    std::string_view sep;
+    if (args.size() == 2) sep = asStringValue(args[1], "string-join").view();
+
+    // 先算出总长度，一次分配后依次复制
+    std::vector<const StringValue*> parts;
+    size_t total = 0;
+    for (auto& item : ListView(args[0])) {
+        parts.push_back(&asStringValue(item, "string-join"));
+        total += parts.back()->length();
+    }
+    if (!parts.empty()) total += sep.size() * (parts.size() - 1);
+    std::string result;
+    result.reserve(total);
+    for (size_t i = 0; i < parts.size(); i++) {
+        if (i > 0) result += sep;
+        result += parts[i]->view();
+    }
+    return makeValue<StringValue>(std::move(result));
+}
+
+ValuePtr stringToNumber(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // 整个字符串是一个十进制数时返回该数，否则返回 #f
+    if (args.size() != 1) {
+        throw LispError("string->number requires one argument");
+    }
+    std::string_view text = asStringValue(args[0], "string->number").view();
+    bool negative = false;
+    if (!text.empty() && (text[0] == '+' || text[0] == '-')) {
+        negative = text[0] == '-';
+        text.remove_prefix(1);
+    }
+    // from_chars 还接受 inf/nan，这里只允许以数字或小数点开头
+    if (text.empty() || !(std::isdigit(static_cast<unsigned char>(text[0])) ||
+                          text[0] == '.')) {
+        return makeBoolean(false);
+    }
+    double value = 0;
+    auto [end, error] =
+        std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc() || end != text.data() + text.size()) {
+        return makeBoolean(false);
+    }
+    return makeNumber(negative ? -value : value);
+}
+
+ValuePtr numberToString(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) {
+        throw LispError("number->string requires one argument");
+    }
+    if (!args[0]->isNumber()) {
+        throw LispError("Argument to number->string must be a number");
+    }
+    return makeValue<StringValue>(args[0]->toString());
+}
+
+// ========== 端口库 ==========
+static ValuePtr makePort(std::shared_ptr<OutputPort> port) {
+    return makePooledValue<PortValue>(std::move(port));
+}
+
+static StringPort& asStringPort(const ValuePtr& value, const char* who) {
+    auto port = dynamic_cast<const PortValue*>(value.get());
+    auto stringPort =
+        port ? dynamic_cast<StringPort*>(port->getPort().get()) : nullptr;
+    if (!stringPort) {
+        throw LispError(std::string(who) + ": expected a string port, got " +
+                        value->toString());
+    }
+    return *stringPort;
+}
+
+ValuePtr currentOutputPort(const std::vector<ValuePtr>& args,
+                           EvalEnv& env) {
+    if (!args.empty()) {
+        throw LispError("current-output-port requires no arguments");
+    }
+    return makePort(OutputPort::current());
+}
+
+ValuePtr openOutputFile(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) {
+        throw LispError("open-output-file requires one argument");
+    }
+    const StringValue& path = asStringValue(args[0], "open-output-file");
+    return makePort(StreamPort::openFile(std::string(path.view())));
+}
+
+ValuePtr openOutputString(const std::vector<ValuePtr>& args,
+                          EvalEnv& env) {
+    if (!args.empty()) {
+        throw LispError("open-output-string requires no arguments");
+    }
+    return makePort(std::make_shared<StringPort>());
+}
+
+ValuePtr getOutputString(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) {
+        throw LispError("get-output-string requires one argument");
+    }
+    return makeValue<StringValue>(
+        asStringPort(args[0], "get-output-string").contents());
+}
+
+ValuePtr closeOutputPort(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // 文件端口关闭时写出剩余内容并关闭文件，重复关闭无效果
+    if (args.size() != 1) {
+        throw LispError("close-output-port requires one argument");
+    }
+    outputPortArgument(args, 0, "close-output-port").close();
+    return makeNil();
+}
+
+ValuePtr flushOutput(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (flush-output [port])，默认刷新当前输出端口
+    if (args.size() > 1) {
+        throw LispError("flush-output requires at most one argument");
+    }
+    outputPortArgument(args, 0, "flush-output").flush();
+    return makeNil();
+}
+
+ValuePtr withOutputToString(const std::vector<ValuePtr>& args,
+                            EvalEnv& env) {
+    // 调用 thunk 期间把当前输出端口换成字符串端口，返回写入的全部内容
+    if (args.size() != 1 || !args[0]->isProcedure()) {
+        throw LispError("with-output-to-string requires a procedure");
+    }
+    auto port = std::make_shared<StringPort>();
+    {
+        OutputPortScope scope(port);
+        env.apply(args[0], {});
+    }
+    return makeValue<StringValue>(port->contents());
+}
+
+ValuePtr isOutputPort(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 1) throw LispError("output-port? requires one argument");
+    return makeBoolean(dynamic_cast<const PortValue*>(args[0].get()) !=
+                       nullptr);
+}
+
+// ========== 记忆化 ==========
+static MemoizedValue& asMemoized(const ValuePtr& value, const char* who) {
+    auto memoized = dynamic_cast<MemoizedValue*>(value.get());
+    if (!memoized) {
+        throw LispError(std::string(who) +
+                        ": expected a memoized procedure, got " +
+                        value->toString());
+    }
+    return *memoized;
+}
+
+ValuePtr memoize(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (memoize proc [capacity])
+    if (args.size() != 1 && args.size() != 2) {
+        throw LispError("memoize requires one or two arguments");
+    }
+    if (!args[0]->isProcedure()) {
+        throw LispError("First argument to memoize must be a procedure");
+    }
+    size_t capacity = MemoizedValue::DEFAULT_CAPACITY;
+    if (args.size() == 2) {
+        double value = asNumber(args[1]);
+        if (value < 1 || value != std::floor(value)) {
+            throw LispError("memoize: capacity must be a positive integer");
+        }
+        capacity = static_cast<size_t>(value);
+    }
+    return makePooledValue<MemoizedValue>(args[0], capacity);
+}
+
+ValuePtr memoStats(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // (命中次数 未命中次数 当前条目数 容量)
+    if (args.size() != 1) throw LispError("memo-stats requires one argument");
+    auto& memoized = asMemoized(args[0], "memo-stats");
+    return CompactListValue::fromVector({
+        makeNumber(static_cast<double>(memoized.hits())),
+        makeNumber(static_cast<double>(memoized.misses())),
+        makeNumber(static_cast<double>(memoized.size())),
+        makeNumber(static_cast<double>(memoized.capacity())),
+    });
+}
+
+ValuePtr memoClear(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // 清空缓存并把计数归零
+    if (args.size() != 1) throw LispError("memo-clear! requires one argument");
+    asMemoized(args[0], "memo-clear!").clear();
+    return makeNil();
+}
+
+// ========== 运行时信息 ==========
+ValuePtr poolStats(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // 每个对象池一项：(名称 块大小 存活对象数 占用字节数 补充次数)
+    std::vector<ValuePtr> entries;
+    for (auto& stats : MemoryPool::allStats()) {
+        entries.push_back(CompactListValue::fromVector({
+            makeValue<StringValue>(stats.name),
+            makeNumber(static_cast<double>(stats.blockSize)),
+            makeNumber(static_cast<double>(stats.live)),
+            makeNumber(static_cast<double>(stats.bytes)),
+            makeNumber(static_cast<double>(stats.refills)),
+        }));
+    }
+    return CompactListValue::fromVector(std::move(entries));
+}
+
+ValuePtr hashConsStats(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // 原子和常量子列表各一项：(名称 解析总数 复用数 去重比例)
+    auto stats = Parser::hashConsStats();
+    auto entry = [](const char* name, std::size_t total, std::size_t shared) {
+        double ratio = total ? static_cast<double>(shared) / total : 0.0;
+        return CompactListValue::fromVector({
+            makeValue<StringValue>(name),
+            makeNumber(static_cast<double>(total)),
+            makeNumber(static_cast<double>(shared)),
+            makeNumber(ratio),
+        });
+    };
+    return CompactListValue::fromVector({
+        entry("atoms", stats.atoms, stats.sharedAtoms),
+        entry("lists", stats.lists, stats.sharedLists),
+    });
+}
+
+ValuePtr simdLevelFunc(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    // 类型化数组运算当前使用的内核："avx2" 或 "scalar"
+    if (!args.empty()) throw LispError("simd-level requires no arguments");
+    return makeValue<StringValue>(simdLevel());
+}
+
 // 辅助函数：实现 eq? 比较
 //ValuePtr eq(const ValuePtr& a, const ValuePtr& b) {
 //    // 同类型且内容相同（按需实现不同类型的比较）
-//    return std::make_shared<BooleanValue>(a->toString() == b->toString());
+//    return makeBoolean(a->toString() == b->toString());
 //}
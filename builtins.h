@@ -38,6 +38,14 @@ ValuePtr list(const std::vector<ValuePtr>& args, EvalEnv& env);
 ValuePtr mapFunc(const std::vector<ValuePtr>& args, EvalEnv& env);
 ValuePtr filter(const std::vector<ValuePtr>& args, EvalEnv& env);
 ValuePtr reduce(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr range(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr iota(const std::vector<ValuePtr>& args, EvalEnv& env);
+
+// 转换器库
+ValuePtr mapping(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr filtering(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr composeFunc(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr transduce(const std::vector<ValuePtr>& args, EvalEnv& env);
 
 // 算术运算库
 ValuePtr add(const std::vector<ValuePtr>& args, EvalEnv& env);
@@ -53,6 +61,7 @@ ValuePtr remainderFunc(const std::vector<ValuePtr>& args, EvalEnv& env);
 // 比较库
 ValuePtr eqFunc(const std::vector<ValuePtr>& args, EvalEnv& env);
 ValuePtr equalFunc(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr equalHashFunc(const std::vector<ValuePtr>& args, EvalEnv& env);
 ValuePtr notFunc(const std::vector<ValuePtr>& args, EvalEnv& env);
 ValuePtr numEqual(const std::vector<ValuePtr>& args, EvalEnv& env);
 ValuePtr lessThan(const std::vector<ValuePtr>& args, EvalEnv& env);
@@ -63,4 +72,145 @@ ValuePtr evenPred(const std::vector<ValuePtr>& args, EvalEnv& env);
 ValuePtr oddPred(const std::vector<ValuePtr>& args, EvalEnv& env);
 ValuePtr zeroPred(const std::vector<ValuePtr>& args, EvalEnv& env);
 ValuePtr memqFunc(const std::vector<ValuePtr>& args, EvalEnv& env);
+
+// 哈希表库
+ValuePtr makeHashTable(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr isHashTable(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr hashRef(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr hashSet(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr hashDelete(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr hashContains(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr hashCount(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr hashClear(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr hashForEach(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr hashFold(const std::vector<ValuePtr>& args, EvalEnv& env);
+
+// 向量库
+ValuePtr makeVectorFunc(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr vectorFunc(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr isVector(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr vectorRef(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr vectorSet(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr vectorLength(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr vectorToList(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr listToVector(const std::vector<ValuePtr>& args, EvalEnv& env);
+
+// 类型化数组库
+ValuePtr f64Vector(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr s64Vector(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr u8Vector(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr makeF64Vector(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr makeS64Vector(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr makeU8Vector(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr listToF64Vector(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr listToS64Vector(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr listToU8Vector(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr isTypedArray(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr arrayLength(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr arrayRef(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr arraySet(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr arrayToList(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr arrayAdd(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr arraySubtract(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr arrayMultiply(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr arrayDivide(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr arrayLess(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr arrayLessEqual(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr arrayGreater(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr arrayGreaterEqual(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr arrayEqual(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr arraySum(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr arrayDot(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr arrayMin(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr arrayMax(const std::vector<ValuePtr>& args, EvalEnv& env);
+
+// 矩阵库
+ValuePtr makeMatrix(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr listToMatrix(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr matrixToList(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr isMatrix(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr matrixRows(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr matrixCols(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr matrixRef(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr matrixSet(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr matrixMul(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr transpose(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr matVec(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr matrixAdd(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr matrixSubtract(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr matrixMultiplyElements(const std::vector<ValuePtr>& args,
+                                EvalEnv& env);
+ValuePtr matrixDivide(const std::vector<ValuePtr>& args, EvalEnv& env);
+
+// 排序库
+ValuePtr sortFunc(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr sortInPlace(const std::vector<ValuePtr>& args, EvalEnv& env);
+
+// 持久化数据结构库
+ValuePtr pmapFunc(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr isPmap(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr pmapAssoc(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr pmapDissoc(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr pmapGet(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr pmapContains(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr pmapCount(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr pmapToList(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr psetFunc(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr isPset(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr psetAdd(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr psetRemove(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr psetContains(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr psetCount(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr psetToList(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr pvecFunc(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr isPvec(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr pvecConj(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr pvecNth(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr pvecAssoc(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr pvecCount(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr pvecToList(const std::vector<ValuePtr>& args, EvalEnv& env);
+
+// 有序字典库
+ValuePtr makeOrderedMap(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr isOrderedMap(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr omapInsert(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr omapDelete(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr omapRef(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr omapContains(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr omapCount(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr omapMin(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr omapMax(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr omapRange(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr omapToList(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr omapForEach(const std::vector<ValuePtr>& args, EvalEnv& env);
+
+// 字符串库
+ValuePtr stringAppend(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr stringLength(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr substring(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr stringIndex(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr stringSplit(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr stringJoin(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr stringToNumber(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr numberToString(const std::vector<ValuePtr>& args, EvalEnv& env);
+
+// 端口库
+ValuePtr currentOutputPort(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr openOutputFile(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr openOutputString(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr getOutputString(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr closeOutputPort(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr flushOutput(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr withOutputToString(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr isOutputPort(const std::vector<ValuePtr>& args, EvalEnv& env);
+
+// 记忆化
+ValuePtr memoize(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr memoStats(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr memoClear(const std::vector<ValuePtr>& args, EvalEnv& env);
+
+// 运行时信息
+ValuePtr poolStats(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr hashConsStats(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr simdLevelFunc(const std::vector<ValuePtr>& args, EvalEnv& env);
 #endif  // BUILTINS_H
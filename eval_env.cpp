@@ -13,6 +13,18 @@ std::shared_ptr<EvalEnv> EvalEnv::createGlobal() {
 }
 
 std::shared_ptr<EvalEnv> EvalEnv::createChild() {
+    // 有活动的请求区域时，调用帧也在区域中分配
+    if (Region* region = Region::current()) {
+        auto* env = new (region->allocate(sizeof(EvalEnv)))
+            EvalEnv(shared_from_this());
+        return std::shared_ptr<EvalEnv>(
+            env,
+            [](EvalEnv* ptr) {
+                ptr->~EvalEnv();
+                Region::deallocate(ptr);
+            },
+            RegionAllocator<EvalEnv>(region));
+    }
     // 使用 new 而不是 make_shared
     return std::shared_ptr<EvalEnv>(new EvalEnv(shared_from_this()));
 }
@@ -27,101 +39,340 @@ EvalEnv::EvalEnv(const std::shared_ptr<EvalEnv>& parent) : parent_(parent) {
 
 void EvalEnv::initializeBuiltins() {
     // 算术运算
-    symbolTable_["+"] = std::make_shared<BuiltinProcValue>(add, "+");
-    symbolTable_["-"] = std::make_shared<BuiltinProcValue>(subtract, "-");
-    symbolTable_["*"] = std::make_shared<BuiltinProcValue>(multiply, "*");
-    symbolTable_["/"] = std::make_shared<BuiltinProcValue>(divide, "/");
+    symbolTable_["+"] = makeValue<BuiltinProcValue>(add, "+");
+    symbolTable_["-"] = makeValue<BuiltinProcValue>(subtract, "-");
+    symbolTable_["*"] = makeValue<BuiltinProcValue>(multiply, "*");
+    symbolTable_["/"] = makeValue<BuiltinProcValue>(divide, "/");
 
     // 输出
-    symbolTable_["print"] = std::make_shared<BuiltinProcValue>(print, "print");
+    symbolTable_["print"] = makeValue<BuiltinProcValue>(print, "print");
     symbolTable_["display"] =
-        std::make_shared<BuiltinProcValue>(display, "display");
+        makeValue<BuiltinProcValue>(display, "display");
     symbolTable_["newline"] =
-        std::make_shared<BuiltinProcValue>(newline, "newline");
+        makeValue<BuiltinProcValue>(newline, "newline");
 
     // 类型检查
     symbolTable_["number?"] =
-        std::make_shared<BuiltinProcValue>(isNumber, "number?");
+        makeValue<BuiltinProcValue>(isNumber, "number?");
     symbolTable_["boolean?"] =
-        std::make_shared<BuiltinProcValue>(isBoolean, "boolean?");
+        makeValue<BuiltinProcValue>(isBoolean, "boolean?");
     symbolTable_["string?"] =
-        std::make_shared<BuiltinProcValue>(isString, "string?");
+        makeValue<BuiltinProcValue>(isString, "string?");
     symbolTable_["symbol?"] =
-        std::make_shared<BuiltinProcValue>(isSymbol, "symbol?");
-    symbolTable_["list?"] = std::make_shared<BuiltinProcValue>(isList, "list?");
-    symbolTable_["null?"] = std::make_shared<BuiltinProcValue>(isNull, "null?");
-    symbolTable_["pair?"] = std::make_shared<BuiltinProcValue>(isPair, "pair?");
+        makeValue<BuiltinProcValue>(isSymbol, "symbol?");
+    symbolTable_["list?"] = makeValue<BuiltinProcValue>(isList, "list?");
+    symbolTable_["null?"] = makeValue<BuiltinProcValue>(isNull, "null?");
+    symbolTable_["pair?"] = makeValue<BuiltinProcValue>(isPair, "pair?");
     symbolTable_["procedure?"] =
-        std::make_shared<BuiltinProcValue>(isProcedure, "procedure?");
+        makeValue<BuiltinProcValue>(isProcedure, "procedure?");
 
     // 列表操作
-    symbolTable_["car"] = std::make_shared<BuiltinProcValue>(car, "car");
-    symbolTable_["cdr"] = std::make_shared<BuiltinProcValue>(cdr, "cdr");
-    symbolTable_["cons"] = std::make_shared<BuiltinProcValue>(cons, "cons");
+    symbolTable_["car"] = makeValue<BuiltinProcValue>(car, "car");
+    symbolTable_["cdr"] = makeValue<BuiltinProcValue>(cdr, "cdr");
+    symbolTable_["cons"] = makeValue<BuiltinProcValue>(cons, "cons");
     symbolTable_["length"] =
-        std::make_shared<BuiltinProcValue>(length, "length");
-    symbolTable_["list"] = std::make_shared<BuiltinProcValue>(list, "list");
+        makeValue<BuiltinProcValue>(length, "length");
+    symbolTable_["list"] = makeValue<BuiltinProcValue>(list, "list");
 
-    symbolTable_[">"] = std::make_shared<BuiltinProcValue>(greaterThan, ">");
-    symbolTable_["="] = std::make_shared<BuiltinProcValue>(&numEqual, "=");
-    symbolTable_["<"] = std::make_shared<BuiltinProcValue>(&lessThan, "<");
-    symbolTable_["<="] = std::make_shared<BuiltinProcValue>(&lessOrEqual, "<=");
+    symbolTable_[">"] = makeValue<BuiltinProcValue>(greaterThan, ">");
+    symbolTable_["="] = makeValue<BuiltinProcValue>(&numEqual, "=");
+    symbolTable_["<"] = makeValue<BuiltinProcValue>(&lessThan, "<");
+    symbolTable_["<="] = makeValue<BuiltinProcValue>(&lessOrEqual, "<=");
     symbolTable_[">="] =
-        std::make_shared<BuiltinProcValue>(&greaterOrEqual, ">=");
-    symbolTable_["apply"] = std::make_shared<BuiltinProcValue>(&applyFunc, "apply");
+        makeValue<BuiltinProcValue>(&greaterOrEqual, ">=");
+    symbolTable_["apply"] = makeValue<BuiltinProcValue>(&applyFunc, "apply");
     symbolTable_["displayln"] =
-        std::make_shared<BuiltinProcValue>(&displayln, "displayln");
+        makeValue<BuiltinProcValue>(&displayln, "displayln");
     symbolTable_["atom?"] =
-        std::make_shared<BuiltinProcValue>(&isAtom, "atom?");
+        makeValue<BuiltinProcValue>(&isAtom, "atom?");
     symbolTable_["integer?"] =
-        std::make_shared<BuiltinProcValue>(&isInteger, "integer?");
-    symbolTable_["map"] = std::make_shared<BuiltinProcValue>(&mapFunc, "map");
+        makeValue<BuiltinProcValue>(&isInteger, "integer?");
+    symbolTable_["map"] = makeValue<BuiltinProcValue>(&mapFunc, "map");
     symbolTable_["filter"] =
-        std::make_shared<BuiltinProcValue>(&filter, "filter");
-    symbolTable_["eq?"] = std::make_shared<BuiltinProcValue>(&eqFunc, "eq?");
+        makeValue<BuiltinProcValue>(&filter, "filter");
+    symbolTable_["eq?"] = makeValue<BuiltinProcValue>(&eqFunc, "eq?");
     symbolTable_["equal?"] =
-        std::make_shared<BuiltinProcValue>(&equalFunc, "equal?");
-    symbolTable_["not"] = std::make_shared<BuiltinProcValue>(&notFunc, "not");
+        makeValue<BuiltinProcValue>(&equalFunc, "equal?");
+    symbolTable_["equal-hash"] =
+        makeValue<BuiltinProcValue>(&equalHashFunc, "equal-hash");
+    symbolTable_["eqv?"] = makeValue<BuiltinProcValue>(&eqFunc, "eqv?");
+    symbolTable_["not"] = makeValue<BuiltinProcValue>(&notFunc, "not");
     symbolTable_["even?"] =
-        std::make_shared<BuiltinProcValue>(&evenPred, "even?");
-    symbolTable_["odd?"] = std::make_shared<BuiltinProcValue>(&oddPred, "odd?");
+        makeValue<BuiltinProcValue>(&evenPred, "even?");
+    symbolTable_["odd?"] = makeValue<BuiltinProcValue>(&oddPred, "odd?");
     symbolTable_["zero?"] =
-        std::make_shared<BuiltinProcValue>(&zeroPred, "zero?");
+        makeValue<BuiltinProcValue>(&zeroPred, "zero?");
     
     symbolTable_["abs"] =
-        std::make_shared<BuiltinProcValue>(&absFunc, "abs");  // 绝对值
+        makeValue<BuiltinProcValue>(&absFunc, "abs");  // 绝对值
     symbolTable_["expt"] =
-        std::make_shared<BuiltinProcValue>(&expt, "expt");  // 指数
+        makeValue<BuiltinProcValue>(&expt, "expt");  // 指数
     symbolTable_["quotient"] =
-        std::make_shared<BuiltinProcValue>(&quotient, "quotient");  // 整数除法
+        makeValue<BuiltinProcValue>(&quotient, "quotient");  // 整数除法
     symbolTable_["modulo"] =
-        std::make_shared<BuiltinProcValue>(&modulo, "modulo");  // 模运算
+        makeValue<BuiltinProcValue>(&modulo, "modulo");  // 模运算
     symbolTable_["remainder"] =
-        std::make_shared<BuiltinProcValue>(&remainderFunc, "remainder");  // 余数
-    symbolTable_["exit"] = std::make_shared<BuiltinProcValue>(exitFunc, "exit");
+        makeValue<BuiltinProcValue>(&remainderFunc, "remainder");  // 余数
+    symbolTable_["exit"] = makeValue<BuiltinProcValue>(exitFunc, "exit");
     symbolTable_["append"] =
-        std::make_shared<BuiltinProcValue>(&append, "append");
+        makeValue<BuiltinProcValue>(&append, "append");
     symbolTable_["reduce"] =
-        std::make_shared<BuiltinProcValue>(&reduce, "reduce");
-    symbolTable_["error"] = std::make_shared<BuiltinProcValue>(&error, "error");
+        makeValue<BuiltinProcValue>(&reduce, "reduce");
+    symbolTable_["range"] = makeValue<BuiltinProcValue>(&range, "range");
+    symbolTable_["iota"] = makeValue<BuiltinProcValue>(&iota, "iota");
+    symbolTable_["error"] = makeValue<BuiltinProcValue>(&error, "error");
     symbolTable_["memq"] =
-        std::make_shared<BuiltinProcValue>(&memqFunc, "memq");
-    symbolTable_["eval"] = std::make_shared<BuiltinProcValue>(&evalFunc, "eval");
+        makeValue<BuiltinProcValue>(&memqFunc, "memq");
+    symbolTable_["eval"] = makeValue<BuiltinProcValue>(&evalFunc, "eval");
+
+    // 哈希表
+    symbolTable_["make-hash-table"] =
+        makeValue<BuiltinProcValue>(&makeHashTable, "make-hash-table");
+    symbolTable_["hash-table?"] =
+        makeValue<BuiltinProcValue>(&isHashTable, "hash-table?");
+    symbolTable_["hash-ref"] = makeValue<BuiltinProcValue>(&hashRef, "hash-ref");
+    symbolTable_["hash-set!"] =
+        makeValue<BuiltinProcValue>(&hashSet, "hash-set!");
+    symbolTable_["hash-delete!"] =
+        makeValue<BuiltinProcValue>(&hashDelete, "hash-delete!");
+    symbolTable_["hash-contains?"] =
+        makeValue<BuiltinProcValue>(&hashContains, "hash-contains?");
+    symbolTable_["hash-count"] =
+        makeValue<BuiltinProcValue>(&hashCount, "hash-count");
+    symbolTable_["hash-clear!"] =
+        makeValue<BuiltinProcValue>(&hashClear, "hash-clear!");
+    symbolTable_["hash-for-each"] =
+        makeValue<BuiltinProcValue>(&hashForEach, "hash-for-each");
+    symbolTable_["hash-fold"] =
+        makeValue<BuiltinProcValue>(&hashFold, "hash-fold");
+
+    symbolTable_["make-vector"] =
+        makeValue<BuiltinProcValue>(&makeVectorFunc, "make-vector");
+    symbolTable_["vector"] = makeValue<BuiltinProcValue>(&vectorFunc, "vector");
+    symbolTable_["vector?"] = makeValue<BuiltinProcValue>(&isVector, "vector?");
+    symbolTable_["vector-ref"] =
+        makeValue<BuiltinProcValue>(&vectorRef, "vector-ref");
+    symbolTable_["vector-set!"] =
+        makeValue<BuiltinProcValue>(&vectorSet, "vector-set!");
+    symbolTable_["vector-length"] =
+        makeValue<BuiltinProcValue>(&vectorLength, "vector-length");
+    symbolTable_["vector->list"] =
+        makeValue<BuiltinProcValue>(&vectorToList, "vector->list");
+    symbolTable_["list->vector"] =
+        makeValue<BuiltinProcValue>(&listToVector, "list->vector");
+    symbolTable_["f64vector"] =
+        makeValue<BuiltinProcValue>(&f64Vector, "f64vector");
+    symbolTable_["s64vector"] =
+        makeValue<BuiltinProcValue>(&s64Vector, "s64vector");
+    symbolTable_["u8vector"] =
+        makeValue<BuiltinProcValue>(&u8Vector, "u8vector");
+    symbolTable_["make-f64vector"] =
+        makeValue<BuiltinProcValue>(&makeF64Vector, "make-f64vector");
+    symbolTable_["make-s64vector"] =
+        makeValue<BuiltinProcValue>(&makeS64Vector, "make-s64vector");
+    symbolTable_["make-u8vector"] =
+        makeValue<BuiltinProcValue>(&makeU8Vector, "make-u8vector");
+    symbolTable_["list->f64vector"] =
+        makeValue<BuiltinProcValue>(&listToF64Vector, "list->f64vector");
+    symbolTable_["list->s64vector"] =
+        makeValue<BuiltinProcValue>(&listToS64Vector, "list->s64vector");
+    symbolTable_["list->u8vector"] =
+        makeValue<BuiltinProcValue>(&listToU8Vector, "list->u8vector");
+    symbolTable_["array?"] =
+        makeValue<BuiltinProcValue>(&isTypedArray, "array?");
+    symbolTable_["array-length"] =
+        makeValue<BuiltinProcValue>(&arrayLength, "array-length");
+    symbolTable_["array-ref"] =
+        makeValue<BuiltinProcValue>(&arrayRef, "array-ref");
+    symbolTable_["array-set!"] =
+        makeValue<BuiltinProcValue>(&arraySet, "array-set!");
+    symbolTable_["array->list"] =
+        makeValue<BuiltinProcValue>(&arrayToList, "array->list");
+    symbolTable_["array+"] = makeValue<BuiltinProcValue>(&arrayAdd, "array+");
+    symbolTable_["array-"] =
+        makeValue<BuiltinProcValue>(&arraySubtract, "array-");
+    symbolTable_["array*"] =
+        makeValue<BuiltinProcValue>(&arrayMultiply, "array*");
+    symbolTable_["array/"] =
+        makeValue<BuiltinProcValue>(&arrayDivide, "array/");
+    symbolTable_["array<"] = makeValue<BuiltinProcValue>(&arrayLess, "array<");
+    symbolTable_["array<="] =
+        makeValue<BuiltinProcValue>(&arrayLessEqual, "array<=");
+    symbolTable_["array>"] =
+        makeValue<BuiltinProcValue>(&arrayGreater, "array>");
+    symbolTable_["array>="] =
+        makeValue<BuiltinProcValue>(&arrayGreaterEqual, "array>=");
+    symbolTable_["array="] = makeValue<BuiltinProcValue>(&arrayEqual, "array=");
+    symbolTable_["array-sum"] =
+        makeValue<BuiltinProcValue>(&arraySum, "array-sum");
+    symbolTable_["array-dot"] =
+        makeValue<BuiltinProcValue>(&arrayDot, "array-dot");
+    symbolTable_["array-min"] =
+        makeValue<BuiltinProcValue>(&arrayMin, "array-min");
+    symbolTable_["array-max"] =
+        makeValue<BuiltinProcValue>(&arrayMax, "array-max");
+    symbolTable_["make-matrix"] =
+        makeValue<BuiltinProcValue>(&makeMatrix, "make-matrix");
+    symbolTable_["list->matrix"] =
+        makeValue<BuiltinProcValue>(&listToMatrix, "list->matrix");
+    symbolTable_["matrix->list"] =
+        makeValue<BuiltinProcValue>(&matrixToList, "matrix->list");
+    symbolTable_["matrix?"] = makeValue<BuiltinProcValue>(&isMatrix, "matrix?");
+    symbolTable_["matrix-rows"] =
+        makeValue<BuiltinProcValue>(&matrixRows, "matrix-rows");
+    symbolTable_["matrix-cols"] =
+        makeValue<BuiltinProcValue>(&matrixCols, "matrix-cols");
+    symbolTable_["matrix-ref"] =
+        makeValue<BuiltinProcValue>(&matrixRef, "matrix-ref");
+    symbolTable_["matrix-set!"] =
+        makeValue<BuiltinProcValue>(&matrixSet, "matrix-set!");
+    symbolTable_["matrix-mul"] =
+        makeValue<BuiltinProcValue>(&matrixMul, "matrix-mul");
+    symbolTable_["transpose"] =
+        makeValue<BuiltinProcValue>(&transpose, "transpose");
+    symbolTable_["mat-vec"] = makeValue<BuiltinProcValue>(&matVec, "mat-vec");
+    symbolTable_["matrix+"] =
+        makeValue<BuiltinProcValue>(&matrixAdd, "matrix+");
+    symbolTable_["matrix-"] =
+        makeValue<BuiltinProcValue>(&matrixSubtract, "matrix-");
+    symbolTable_["matrix*"] =
+        makeValue<BuiltinProcValue>(&matrixMultiplyElements, "matrix*");
+    symbolTable_["matrix/"] =
+        makeValue<BuiltinProcValue>(&matrixDivide, "matrix/");
+    symbolTable_["sort"] = makeValue<BuiltinProcValue>(&sortFunc, "sort");
+    symbolTable_["sort!"] = makeValue<BuiltinProcValue>(&sortInPlace, "sort!");
+    symbolTable_["pmap"] = makeValue<BuiltinProcValue>(&pmapFunc, "pmap");
+    symbolTable_["pmap?"] = makeValue<BuiltinProcValue>(&isPmap, "pmap?");
+    symbolTable_["pmap-assoc"] =
+        makeValue<BuiltinProcValue>(&pmapAssoc, "pmap-assoc");
+    symbolTable_["pmap-dissoc"] =
+        makeValue<BuiltinProcValue>(&pmapDissoc, "pmap-dissoc");
+    symbolTable_["pmap-get"] =
+        makeValue<BuiltinProcValue>(&pmapGet, "pmap-get");
+    symbolTable_["pmap-contains?"] =
+        makeValue<BuiltinProcValue>(&pmapContains, "pmap-contains?");
+    symbolTable_["pmap-count"] =
+        makeValue<BuiltinProcValue>(&pmapCount, "pmap-count");
+    symbolTable_["pmap->list"] =
+        makeValue<BuiltinProcValue>(&pmapToList, "pmap->list");
+    symbolTable_["pset"] = makeValue<BuiltinProcValue>(&psetFunc, "pset");
+    symbolTable_["pset?"] = makeValue<BuiltinProcValue>(&isPset, "pset?");
+    symbolTable_["pset-add"] =
+        makeValue<BuiltinProcValue>(&psetAdd, "pset-add");
+    symbolTable_["pset-remove"] =
+        makeValue<BuiltinProcValue>(&psetRemove, "pset-remove");
+    symbolTable_["pset-contains?"] =
+        makeValue<BuiltinProcValue>(&psetContains, "pset-contains?");
+    symbolTable_["pset-count"] =
+        makeValue<BuiltinProcValue>(&psetCount, "pset-count");
+    symbolTable_["pset->list"] =
+        makeValue<BuiltinProcValue>(&psetToList, "pset->list");
+    symbolTable_["pvec"] = makeValue<BuiltinProcValue>(&pvecFunc, "pvec");
+    symbolTable_["pvec?"] = makeValue<BuiltinProcValue>(&isPvec, "pvec?");
+    symbolTable_["pvec-conj"] =
+        makeValue<BuiltinProcValue>(&pvecConj, "pvec-conj");
+    symbolTable_["pvec-nth"] =
+        makeValue<BuiltinProcValue>(&pvecNth, "pvec-nth");
+    symbolTable_["pvec-assoc"] =
+        makeValue<BuiltinProcValue>(&pvecAssoc, "pvec-assoc");
+    symbolTable_["pvec-count"] =
+        makeValue<BuiltinProcValue>(&pvecCount, "pvec-count");
+    symbolTable_["pvec->list"] =
+        makeValue<BuiltinProcValue>(&pvecToList, "pvec->list");
+    symbolTable_["make-omap"] =
+        makeValue<BuiltinProcValue>(&makeOrderedMap, "make-omap");
+    symbolTable_["omap?"] = makeValue<BuiltinProcValue>(&isOrderedMap, "omap?");
+    symbolTable_["omap-insert!"] =
+        makeValue<BuiltinProcValue>(&omapInsert, "omap-insert!");
+    symbolTable_["omap-delete!"] =
+        makeValue<BuiltinProcValue>(&omapDelete, "omap-delete!");
+    symbolTable_["omap-ref"] =
+        makeValue<BuiltinProcValue>(&omapRef, "omap-ref");
+    symbolTable_["omap-contains?"] =
+        makeValue<BuiltinProcValue>(&omapContains, "omap-contains?");
+    symbolTable_["omap-count"] =
+        makeValue<BuiltinProcValue>(&omapCount, "omap-count");
+    symbolTable_["omap-min"] =
+        makeValue<BuiltinProcValue>(&omapMin, "omap-min");
+    symbolTable_["omap-max"] =
+        makeValue<BuiltinProcValue>(&omapMax, "omap-max");
+    symbolTable_["omap-range"] =
+        makeValue<BuiltinProcValue>(&omapRange, "omap-range");
+    symbolTable_["omap->list"] =
+        makeValue<BuiltinProcValue>(&omapToList, "omap->list");
+    symbolTable_["omap-for-each"] =
+        makeValue<BuiltinProcValue>(&omapForEach, "omap-for-each");
+    symbolTable_["string-append"] =
+        makeValue<BuiltinProcValue>(&stringAppend, "string-append");
+    symbolTable_["string-length"] =
+        makeValue<BuiltinProcValue>(&stringLength, "string-length");
+    symbolTable_["substring"] =
+        makeValue<BuiltinProcValue>(&substring, "substring");
+    symbolTable_["string-index"] =
+        makeValue<BuiltinProcValue>(&stringIndex, "string-index");
+    symbolTable_["string-split"] =
+        makeValue<BuiltinProcValue>(&stringSplit, "string-split");
+    symbolTable_["string-join"] =
+        makeValue<BuiltinProcValue>(&stringJoin, "string-join");
+    symbolTable_["string->number"] =
+        makeValue<BuiltinProcValue>(&stringToNumber, "string->number");
+    symbolTable_["number->string"] =
+        makeValue<BuiltinProcValue>(&numberToString, "number->string");
+    symbolTable_["current-output-port"] =
+        makeValue<BuiltinProcValue>(&currentOutputPort, "current-output-port");
+    symbolTable_["open-output-file"] =
+        makeValue<BuiltinProcValue>(&openOutputFile, "open-output-file");
+    symbolTable_["open-output-string"] =
+        makeValue<BuiltinProcValue>(&openOutputString, "open-output-string");
+    symbolTable_["get-output-string"] =
+        makeValue<BuiltinProcValue>(&getOutputString, "get-output-string");
+    symbolTable_["close-output-port"] =
+        makeValue<BuiltinProcValue>(&closeOutputPort, "close-output-port");
+    symbolTable_["flush-output"] =
+        makeValue<BuiltinProcValue>(&flushOutput, "flush-output");
+    symbolTable_["with-output-to-string"] = makeValue<BuiltinProcValue>(
+        &withOutputToString, "with-output-to-string");
+    symbolTable_["output-port?"] =
+        makeValue<BuiltinProcValue>(&isOutputPort, "output-port?");
+    symbolTable_["memoize"] = makeValue<BuiltinProcValue>(&memoize, "memoize");
+    symbolTable_["memo-stats"] =
+        makeValue<BuiltinProcValue>(&memoStats, "memo-stats");
+    symbolTable_["memo-clear!"] =
+        makeValue<BuiltinProcValue>(&memoClear, "memo-clear!");
+    symbolTable_["pool-stats"] =
+        makeValue<BuiltinProcValue>(&poolStats, "pool-stats");
+    symbolTable_["hash-cons-stats"] =
+        makeValue<BuiltinProcValue>(&hashConsStats, "hash-cons-stats");
+    symbolTable_["simd-level"] =
+        makeValue<BuiltinProcValue>(&simdLevelFunc, "simd-level");
+
+    // 转换器
+    symbolTable_["mapping"] =
+        makeValue<BuiltinProcValue>(&mapping, "mapping");
+    symbolTable_["filtering"] =
+        makeValue<BuiltinProcValue>(&filtering, "filtering");
+    symbolTable_["compose"] =
+        makeValue<BuiltinProcValue>(&composeFunc, "compose");
+    symbolTable_["transduce"] =
+        makeValue<BuiltinProcValue>(&transduce, "transduce");
 }
 
 ValuePtr EvalEnv::lookup(const std::string& name) {
-    // 在当前环境查找
-    auto it = symbolTable_.find(name);
-    if (it != symbolTable_.end()) {
-        return it->second;
+    if (auto value = findBinding(name)) {
+        return value;
     }
+    throw LispError("Variable " + name + " not defined.");
+}
 
-    // 如果在父环境中查找
-    if (parent_) {
-        return parent_->lookup(name);
+ValuePtr EvalEnv::findBinding(const std::string& name) {
+    // 从当前环境逐层向父环境查找
+    for (EvalEnv* env = this; env; env = env->parent_.get()) {
+        auto it = env->symbolTable_.find(name);
+        if (it != env->symbolTable_.end()) {
+            return it->second;
+        }
     }
-
-    throw LispError("Variable " + name + " not defined.");
+    return nullptr;
 }
 
 ValuePtr EvalEnv::eval(ValuePtr expr) {
@@ -146,25 +397,28 @@ ValuePtr EvalEnv::eval(ValuePtr expr) {
             throw LispError("Expected a list for evaluation");
         }
 
-        auto list = expr->toVector();
-        if (list.empty()) {
-            throw LispError("Empty list cannot be evaluated.");
-        }
+        ListView items(expr);
+        auto it = items.begin();
+        ValuePtr head = *it;
+        ++it;
 
         // 处理特殊形式 define
-        if (auto firstSym = list[0]->asSymbol()) {
-            auto it = SPECIAL_FORMS.find(*firstSym);
-            if (it != SPECIAL_FORMS.end()) {
+        if (auto firstSym = head->asSymbol()) {
+            auto form = SPECIAL_FORMS.find(*firstSym);
+            if (form != SPECIAL_FORMS.end()) {
+                if (form->second.byNode) {
+                    return form->second.byNode(expr, *this);
+                }
                 // 移除特殊形式符号，处理剩余参数
-                std::vector<ValuePtr> formArgs(list.begin() + 1, list.end());
-                return it->second(formArgs, *this);
+                std::vector<ValuePtr> formArgs(it, items.end());
+                return form->second.byArgs(formArgs, *this);
             }
         }
 
-        ValuePtr proc = eval(list[0]);
+        ValuePtr proc = eval(head);
         std::vector<ValuePtr> args;
-        for (size_t i = 1; i < list.size(); i++) {
-            args.push_back(eval(list[i]));
+        for (; it != items.end(); ++it) {
+            args.push_back(eval(*it));
         }
 
         return apply(proc, args);
@@ -175,14 +429,8 @@ ValuePtr EvalEnv::eval(ValuePtr expr) {
 
 std::vector<ValuePtr> EvalEnv::evalList(ValuePtr expr) {
     std::vector<ValuePtr> result;
-    if (expr->isNil()) return result;
-
-    if (auto pair = std::dynamic_pointer_cast<PairValue>(expr)) {
-        result.push_back(eval(pair->getCar()));
-        auto rest = evalList(pair->getCdr());
-        result.insert(result.end(), rest.begin(), rest.end());
-    } else {
-        throw LispError("Malformed list");
+    for (auto& item : ListView(expr)) {
+        result.push_back(eval(item));
     }
     return result;
 }
@@ -195,12 +443,31 @@ ValuePtr EvalEnv::apply(ValuePtr proc, std::vector<ValuePtr> args) {
     if (auto lambda = dynamic_cast<LambdaValue*>(proc.get())) {
         return lambda->apply(args, *this);
     }
+    if (auto recordProc = dynamic_cast<RecordProcValue*>(proc.get())) {
+        return recordProc->apply(args);
+    }
+    if (auto memoized = dynamic_cast<MemoizedValue*>(proc.get())) {
+        return memoized->apply(args, *this);
+    }
 
     throw LispError("Unsupported procedure type: " + proc->toString());
 }
 
 void EvalEnv::defineBinding(const std::string& name, ValuePtr value) {
-    symbolTable_[name] = value;
+    // 区域中的对象原地保留，绑定的就是原对象本身
+    symbolTable_[name] = std::move(value);
 }
 
 
+
+void EvalEnv::assignBinding(const std::string& name, ValuePtr value) {
+    // set! 修改最近一层已有的绑定，未定义的变量不能赋值
+    for (EvalEnv* env = this; env; env = env->parent_.get()) {
+        auto it = env->symbolTable_.find(name);
+        if (it != env->symbolTable_.end()) {
+            it->second = std::move(value);
+            return;
+        }
+    }
+    throw LispError("Variable " + name + " not defined.");
+}
@@ -19,7 +19,9 @@ public:
     ValuePtr apply(ValuePtr proc, std::vector<ValuePtr> args);
    
     void defineBinding(const std::string& name, ValuePtr value);
+    void assignBinding(const std::string& name, ValuePtr value);
     ValuePtr lookup(const std::string& name);
+    ValuePtr findBinding(const std::string& name);  // 未定义时返回 nullptr
 
     // 添加获取共享指针的方法
     std::shared_ptr<EvalEnv> getSharedPtr() {
@@ -1,5 +1,7 @@
 #include "forms.h"
 
+#include <algorithm>
+
 #include "builtins.h"
 #include "error.h"
 
@@ -24,7 +26,7 @@ ValuePtr ifForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
     if (auto boolVal = dynamic_cast<BooleanValue*>(condition.get())) {
         if (boolVal->getValue() == false) {
             return args.size() > 2 ? env.eval(args[2])
-                                   : std::make_shared<NilValue>();
+                                   : makeNil();
         }
     }
     // 其他所有值（包括空表）都视为真
@@ -34,7 +36,7 @@ ValuePtr ifForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
 ValuePtr andForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
     // 空and表达式返回true
     if (args.empty()) {
-        return std::make_shared<BooleanValue>(true);
+        return makeBoolean(true);
     }
 
     // 依次求值每个参数
@@ -44,7 +46,7 @@ ValuePtr andForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
         // 遇到false立即返回false
         if (auto boolVal = dynamic_cast<BooleanValue*>(value.get())) {
             if (boolVal->getValue() == false) {
-                return std::make_shared<BooleanValue>(false);
+                return makeBoolean(false);
             }
         }
         // 所有其他值都视为真
@@ -57,7 +59,7 @@ ValuePtr andForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
 ValuePtr orForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
     // 空or表达式返回false
     if (args.empty()) {
-        return std::make_shared<BooleanValue>(false);
+        return makeBoolean(false);
     }
 
     // 依次求值每个参数
@@ -76,7 +78,7 @@ ValuePtr orForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
     }
 
     // 所有值都是false
-    return std::make_shared<BooleanValue>(false);
+    return makeBoolean(false);
 }
 
 ValuePtr lambdaForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
@@ -92,8 +94,7 @@ ValuePtr lambdaForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
     }
 
     std::vector<std::string> params;
-    auto paramList = paramsValue->toVector();
-    for (auto& param : paramList) {
+    for (auto& param : ListView(paramsValue)) {
         if (auto name = param->asSymbol()) {
             params.push_back(*name);
         } else {
@@ -107,9 +108,9 @@ ValuePtr lambdaForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
         body.push_back(args[i]);
     }
 
+    // 调用时会基于闭包环境创建新的帧，这里直接捕获当前环境即可
     auto envPtr = env.getSharedPtr();  // 使用新增的 getSharedPtr 方法
-    auto childEnv = envPtr->createChild();
-    return std::make_shared<LambdaValue>(params, body, childEnv);
+    return makeValue<LambdaValue>(params, body, envPtr);
 }
 
 ValuePtr defineForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
@@ -118,80 +119,85 @@ ValuePtr defineForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
     }
 
     // 函数定义：(define (f x) ...)
-    if (auto pair = dynamic_cast<PairValue*>(args[0].get())) {
-        auto list = args[0]->toVector();
-        if (list.empty()) {
-            throw LispError("Invalid define form");
-        }
-
+    if (args[0]->isPair()) {
         // 获取函数名
-        auto funcName = list[0]->asSymbol();
+        auto funcName = args[0]->getCar()->asSymbol();
         if (!funcName) {
             throw LispError("Expected function name");
         }
 
-        // 构造参数列表
-        std::vector<std::string> params;
-        if (list.size() > 1) {
-            for (size_t i = 1; i < list.size(); i++) {
-                if (auto paramName = list[i]->asSymbol()) {
-                    params.push_back(*paramName);
-                } else {
-                    throw LispError("Function parameter must be a symbol");
-                }
+        // 参数列表直接使用 (f x ...) 的 cdr，只检查每一项都是符号
+        ValuePtr paramList = args[0]->getCdr();
+        for (auto& param : ListView(paramList)) {
+            if (!param->asSymbol()) {
+                throw LispError("Function parameter must be a symbol");
             }
         }
 
-        // 构建参数列表 (符号列表)
-        ValuePtr paramList = std::make_shared<NilValue>();
-        for (auto it = params.rbegin(); it != params.rend(); ++it) {
-            auto symbol = std::make_shared<SymbolValue>(*it);
-            paramList = std::make_shared<PairValue>(symbol, paramList);
-        }
-
         // 构建 lambda 表达式参数
-        auto lambdaArgs = std::vector<ValuePtr>();
-        lambdaArgs.push_back(paramList);
-        for (size_t i = 1; i < args.size(); i++) {
-            lambdaArgs.push_back(args[i]);
-        }
+        std::vector<ValuePtr> lambdaArgs = {paramList};
+        lambdaArgs.insert(lambdaArgs.end(), args.begin() + 1, args.end());
 
         // 创建 lambda 值
         auto lambda = lambdaForm(lambdaArgs, env);
 
         // 绑定函数名
         env.defineBinding(*funcName, lambda);
-        return std::make_shared<NilValue>();
+        return makeNil();
     }
 
     // 变量定义：(define x 42)
     if (auto name = args[0]->asSymbol()) {
         auto value = env.eval(args[1]);
         env.defineBinding(*name, value);
-        return std::make_shared<NilValue>();
+        return makeNil();
     }
 
     throw LispError("Invalid define form");
 }
 
+ValuePtr defineMemoizedForm(const std::vector<ValuePtr>& args,
+                            EvalEnv& env) {
+    // (define-memoized (f x ...) body ...)：与 define 定义过程相同，但绑定的是
+    // 记忆化过程，函数体中对 f 的递归调用同样先查缓存
+    if (args.size() < 2 || !args[0]->isPair()) {
+        throw LispError("define-memoized requires (name params...) and a body");
+    }
+    auto funcName = args[0]->getCar()->asSymbol();
+    if (!funcName) {
+        throw LispError("Expected function name");
+    }
+
+    std::vector<ValuePtr> lambdaArgs = {args[0]->getCdr()};
+    lambdaArgs.insert(lambdaArgs.end(), args.begin() + 1, args.end());
+    auto lambda = lambdaForm(lambdaArgs, env);
+    env.defineBinding(*funcName, makePooledValue<MemoizedValue>(
+                                     std::move(lambda),
+                                     MemoizedValue::DEFAULT_CAPACITY,
+                                     *funcName));
+    return makeNil();
+}
+
 ValuePtr condForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
     for (auto& clause : args) {
         if (!clause->isList()) {
             throw LispError("cond clause must be a list");
         }
 
-        auto clauseItems = clause->toVector();
+        ListView clauseItems(clause);
         if (clauseItems.empty()) {
             throw LispError("cond clause cannot be empty");
         }
 
-        ValuePtr test = clauseItems[0];
+        auto item = clauseItems.begin();
+        ValuePtr test = *item;
+        ++item;
         ValuePtr testResult;
 
         // 处理 else 情况
         if (auto sym = test->asSymbol()) {
             if (*sym == "else") {
-                testResult = std::make_shared<BooleanValue>(true);
+                testResult = makeBoolean(true);
             }
         }
 
@@ -202,12 +208,12 @@ ValuePtr condForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
         if (!testResult->isNil() &&
             (!testResult->isBoolean() || testResult->getValue())) {
             // 执行当前子句
-            ValuePtr result = std::make_shared<NilValue>();
+            ValuePtr result = makeNil();
 
             // 执行所有表达式（如果有）
-            if (clauseItems.size() > 1) {
-                for (size_t i = 1; i < clauseItems.size(); i++) {
-                    result = env.eval(clauseItems[i]);
+            if (item != clauseItems.end()) {
+                for (; item != clauseItems.end(); ++item) {
+                    result = env.eval(*item);
                 }
                 return result;
             }
@@ -216,11 +222,129 @@ ValuePtr condForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
             return testResult;
         }
     }
-    return std::make_shared<NilValue>();
+    return makeNil();
+}
+
+// case 的分派表：按常量直接找到子句，不必逐条比较
+struct CaseDispatch {
+    ValuePtr form;  // 持有 case 表达式，保证作为缓存键的节点不被复用
+    std::unordered_map<std::size_t, size_t> symbols;  // 键为符号编号
+    std::unordered_map<double, size_t> numbers;
+    std::optional<size_t> booleans[2];
+    std::optional<size_t> nilClause;
+    std::optional<size_t> elseClause;
+    std::vector<std::vector<ValuePtr>> bodies;
+};
+
+// clauses 指向 case 表达式中的第一个子句
+static CaseDispatch buildCaseDispatch(const ValuePtr& form,
+                                      ListIterator clauses) {
+    CaseDispatch dispatch;
+    dispatch.form = form;
+    for (ListIterator it = clauses; it != ListIterator(); ++it) {
+        const ValuePtr& clause = *it;
+        if (!clause->isPair()) {
+            throw LispError("case clause must be a list");
+        }
+        size_t index = dispatch.bodies.size();
+        ListIterator item(clause.get());
+        const ValuePtr& datums = *item;
+        dispatch.bodies.emplace_back(std::next(item), ListIterator());
+
+        if (auto sym = datums->asSymbol(); sym && *sym == "else") {
+            if (std::next(it) != ListIterator()) {
+                throw LispError("else clause must be last in case");
+            }
+            dispatch.elseClause = index;
+            continue;
+        }
+        if (!datums->isList()) {
+            throw LispError("case clause must start with a list of datums");
+        }
+        // 同一常量出现多次时，以第一次出现的子句为准
+        for (auto& datum : ListView(datums)) {
+            if (datum->isSymbol()) {
+                auto& symbol = static_cast<const SymbolValue&>(*datum);
+                dispatch.symbols.try_emplace(symbol.getId(), index);
+            } else if (datum->isNumber()) {
+                dispatch.numbers.try_emplace(datum->asNumber(), index);
+            } else if (datum->isBoolean()) {
+                auto& slot = dispatch.booleans[datum->getValue()];
+                if (!slot) slot = index;
+            } else if (datum->isNil()) {
+                if (!dispatch.nilClause) dispatch.nilClause = index;
+            } else {
+                throw LispError("case datum must be a symbol, number, "
+                                "boolean or ()");
+            }
+        }
+    }
+    return dispatch;
+}
+
+static const CaseDispatch& getCaseDispatch(const ValuePtr& form,
+                                           ListIterator clauses) {
+    // 以 case 表达式节点为键缓存分派表，同一段代码只分析一次，
+    // 之后每次求值只需一次查找
+    static std::unordered_map<const Value*, CaseDispatch> cache;
+    static size_t sweepAt = 1024;
+    auto it = cache.find(form.get());
+    if (it != cache.end()) {
+        return it->second;
+    }
+    if (cache.size() >= sweepAt) {
+        // 只剩缓存自身引用的表达式已不可能再被求值。
+        // 清理后按剩余数量加倍下一次的阈值，清理的代价均摊到每次插入
+        std::erase_if(cache, [](const auto& entry) {
+            return entry.second.form.useCount() == 1;
+        });
+        sweepAt = std::max<size_t>(1024, cache.size() * 2);
+    }
+    return cache.emplace(form.get(), buildCaseDispatch(form, clauses))
+        .first->second;
+}
+
+ValuePtr caseForm(const ValuePtr& form, EvalEnv& env) {
+    // 直接在表达式上遍历，不复制参数列表
+    ListIterator it(form.get());
+    ++it;
+    if (it == ListIterator()) {
+        throw LispError("case requires a key expression");
+    }
+    auto key = env.eval(*it);
+    if (++it == ListIterator()) {
+        return makeNil();
+    }
+
+    const CaseDispatch& dispatch = getCaseDispatch(form, it);
+
+    std::optional<size_t> match;
+    if (key->isSymbol()) {
+        auto& symbol = static_cast<const SymbolValue&>(*key);
+        auto it = dispatch.symbols.find(symbol.getId());
+        if (it != dispatch.symbols.end()) match = it->second;
+    } else if (key->isNumber()) {
+        auto it = dispatch.numbers.find(key->asNumber());
+        if (it != dispatch.numbers.end()) match = it->second;
+    } else if (key->isBoolean()) {
+        match = dispatch.booleans[key->getValue()];
+    } else if (key->isNil()) {
+        match = dispatch.nilClause;
+    }
+    if (!match) match = dispatch.elseClause;
+    if (!match) {
+        return makeNil();
+    }
+
+    ValuePtr result = makeNil();
+    for (auto& expr : dispatch.bodies[*match]) {
+        result = env.eval(expr);
+    }
+    return result;
 }
 
 ValuePtr beginForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
-    ValuePtr result = std::make_shared<NilValue>();
+    ValuePtr result = makeNil();
     for (auto& expr : args) {
         result = env.eval(expr);
     }
@@ -239,20 +363,27 @@ ValuePtr letForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
     std::vector<std::string> names;
     std::vector<ValuePtr> values;
 
-    for (auto& binding : bindings->toVector()) {
+    for (auto& binding : ListView(bindings)) {
         if (!binding->isPair()) {
             throw LispError("binding must be a pair");
         }
 
-        auto bindingItems = binding->toVector();
-        if (bindingItems.size() != 2) {
+        // 绑定形如 (name value)，逐项取出而不复制整个列表
+        ListView bindingItems(binding);
+        auto item = bindingItems.begin();
+        ValuePtr nameExpr = *item;
+        if (++item == bindingItems.end()) {
+            throw LispError("binding must be (name value)");
+        }
+        ValuePtr valueExpr = *item;
+        if (++item != bindingItems.end()) {
             throw LispError("binding must be (name value)");
         }
 
-        if (auto name = bindingItems[0]->asSymbol()) {
+        if (auto name = nameExpr->asSymbol()) {
             names.push_back(*name);
             // 在当前环境中求值绑定值
-            values.push_back(env.eval(bindingItems[1]));
+            values.push_back(env.eval(valueExpr));
         } else {
             throw LispError("binding name must be a symbol");
         }
@@ -267,44 +398,154 @@ ValuePtr letForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
     }
 
     // 执行表达式
-    ValuePtr result = std::make_shared<NilValue>();
+    ValuePtr result = makeNil();
     for (size_t i = 1; i < args.size(); i++) {
         result = newEnv->eval(args[i]);
     }
     return result;
 }
+ValuePtr setForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
+    if (args.size() != 2) {
+        throw LispError("set! requires exactly 2 arguments");
+    }
+    auto name = args[0]->asSymbol();
+    if (!name) {
+        throw LispError("set! target must be a symbol");
+    }
+    // 帧是按名字查找的表，闭包捕获的是帧本身而不是变量的值，
+    // 表项就是所有闭包共享的可变槽位，不需要另外装箱
+    env.assignBinding(*name, env.eval(args[1]));
+    return makeNil();
+}
+
+ValuePtr defineRecordTypeForm(const std::vector<ValuePtr>& args,
+                              EvalEnv& env) {
+    // (define-record-type point (make-point x y) point?
+    //   (x point-x set-point-x!) (y point-y))
+    // 构造器也可以只写名字，此时按字段顺序接收全部字段
+    if (args.size() < 3) {
+        throw LispError("define-record-type requires a type name, "
+                        "constructor and predicate");
+    }
+    auto typeName = args[0]->asSymbol();
+    if (!typeName) throw LispError("Record type name must be a symbol");
+
+    // 先收集字段说明，确定各字段的槽位
+    std::vector<std::string> fields;
+    std::vector<std::vector<std::string>> procNames;
+    for (size_t i = 3; i < args.size(); i++) {
+        if (!args[i]->isPair()) {
+            throw LispError("Record field spec must be a list");
+        }
+        std::vector<std::string> names;
+        for (auto& item : ListView(args[i])) {
+            auto name = item->asSymbol();
+            if (!name) throw LispError("Record field spec must be symbols");
+            names.push_back(*name);
+        }
+        if (names.size() < 2 || names.size() > 3) {
+            throw LispError("Record field spec must be (field accessor "
+                            "[modifier])");
+        }
+        for (auto& field : fields) {
+            if (field == names[0]) {
+                throw LispError("Duplicate record field: " + names[0]);
+            }
+        }
+        fields.push_back(names[0]);
+        procNames.push_back(std::move(names));
+    }
+    auto slotOf = [&](const std::string& field) {
+        for (size_t i = 0; i < fields.size(); i++) {
+            if (fields[i] == field) return i;
+        }
+        throw LispError("Unknown record field: " + field);
+    };
+
+    // 去掉习惯上的尖括号，<point> 显示为 point
+    std::string displayName = *typeName;
+    if (displayName.size() > 2 && displayName.front() == '<' &&
+        displayName.back() == '>') {
+        displayName = displayName.substr(1, displayName.size() - 2);
+    }
+    // 类型和过程都是长期存在的定义，直接在对象池中创建
+    auto type = makePooledValue<RecordTypeValue>(displayName, fields);
+    using Kind = RecordProcValue::Kind;
+
+    std::string ctorName;
+    std::vector<size_t> ctorSlots;
+    if (auto name = args[1]->asSymbol()) {
+        ctorName = *name;
+        for (size_t i = 0; i < fields.size(); i++) ctorSlots.push_back(i);
+    } else if (args[1]->isPair()) {
+        ListView spec(args[1]);
+        auto item = spec.begin();
+        auto name = (*item)->asSymbol();
+        if (!name) throw LispError("Record constructor name must be a symbol");
+        ctorName = *name;
+        for (++item; item != spec.end(); ++item) {
+            auto field = (*item)->asSymbol();
+            if (!field) {
+                throw LispError("Record constructor fields must be symbols");
+            }
+            ctorSlots.push_back(slotOf(*field));
+        }
+    } else {
+        throw LispError("Invalid record constructor spec");
+    }
+    auto predName = args[2]->asSymbol();
+    if (!predName) throw LispError("Record predicate name must be a symbol");
+
+    env.defineBinding(*typeName, type);
+    env.defineBinding(ctorName, makePooledValue<RecordProcValue>(
+                                    Kind::Constructor, type,
+                                    std::move(ctorSlots), ctorName));
+    env.defineBinding(*predName,
+                      makePooledValue<RecordProcValue>(
+                          Kind::Predicate, type, std::vector<size_t>{},
+                          *predName));
+    for (size_t i = 0; i < procNames.size(); i++) {
+        const auto& names = procNames[i];
+        env.defineBinding(names[1], makePooledValue<RecordProcValue>(
+                                        Kind::Accessor, type,
+                                        std::vector<size_t>{i}, names[1]));
+        if (names.size() == 3) {
+            env.defineBinding(names[2], makePooledValue<RecordProcValue>(
+                                            Kind::Modifier, type,
+                                            std::vector<size_t>{i}, names[2]));
+        }
+    }
+    return makeNil();
+}
+
 ValuePtr quasiquoteExpand(ValuePtr expr, EvalEnv& env) {
     // 处理 unquote
     if (expr->isPair() && expr->getCar()->isSymbol() &&
         expr->getCar()->asSymbol() == "unquote") {
-        auto unquoted = expr->toVector();
-        if (unquoted.size() != 2) {
+        auto arg = std::next(ListIterator(expr.get()));
+        if (arg == ListIterator() || std::next(arg) != ListIterator()) {
             throw LispError("unquote requires exactly one argument");
         }
-        return env.eval(unquoted[1]);
+        return env.eval(*arg);
     }
 
     // 递归处理列表
     if (expr->isPair()) {
         ValuePtr list = expr;
-        ValuePtr result = std::make_shared<NilValue>();
         std::vector<ValuePtr> elements;
 
         while (!list->isNil()) {
-            if (auto pair = std::dynamic_pointer_cast<PairValue>(list)) {
-                auto expanded = quasiquoteExpand(pair->getCar(), env);
+            if (list->isPair()) {
+                auto expanded = quasiquoteExpand(list->getCar(), env);
                 elements.push_back(expanded);
-                list = pair->getCdr();
+                list = list->getCdr();
             } else {
                 elements.push_back(quasiquoteExpand(list, env));
                 break;
             }
         }
 
-        for (auto it = elements.rbegin(); it != elements.rend(); ++it) {
-            result = std::make_shared<PairValue>(*it, result);
-        }
-        return result;
+        return CompactListValue::fromVector(std::move(elements));
     }
 
     // 其他情况直接返回
@@ -318,9 +559,12 @@ ValuePtr quasiquoteForm(const std::vector<ValuePtr>& args, EvalEnv& env) {
     return quasiquoteExpand(args[0], env);
 }
 
-const std::unordered_map<std::string, SpecialFormType> SPECIAL_FORMS = {
+const std::unordered_map<std::string, SpecialForm> SPECIAL_FORMS = {
     {"quote", quoteForm},   {"if", ifForm},
     {"and", andForm},       {"or", orForm},
     {"lambda", lambdaForm}, {"define", defineForm},
     {"cond", condForm},     {"begin", beginForm},
-    {"let", letForm},       {"quasiquote", quasiquoteForm}};
+    {"let", letForm},       {"quasiquote", quasiquoteForm},
+    {"case", caseForm},     {"set!", setForm},
+    {"define-record-type", defineRecordTypeForm},
+    {"define-memoized", defineMemoizedForm}};
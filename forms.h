@@ -1,17 +1,24 @@
 #ifndef FORMS_H
 #define FORMS_H
 
-#include <functional>
-
 #include "eval_env.h"
 #include "value.h"
 
 // 特殊形式类型定义
-using SpecialFormType =
-    std::function<ValuePtr(const std::vector<ValuePtr>&, EvalEnv&)>;
+using SpecialFormType = ValuePtr (*)(const std::vector<ValuePtr>&, EvalEnv&);
+// 直接接收整个表达式节点的特殊形式，如以节点为键缓存分析结果的 case
+using NodeFormType = ValuePtr (*)(const ValuePtr& form, EvalEnv& env);
+
+struct SpecialForm {
+    SpecialForm(SpecialFormType byArgs) : byArgs(byArgs) {}
+    SpecialForm(NodeFormType byNode) : byNode(byNode) {}
+
+    SpecialFormType byArgs = nullptr;  // 接收去掉关键字后的参数列表
+    NodeFormType byNode = nullptr;
+};
 
 // 特殊形式映射表
-extern const std::unordered_map<std::string, SpecialFormType> SPECIAL_FORMS;
+extern const std::unordered_map<std::string, SpecialForm> SPECIAL_FORMS;
 
 // 特殊形式实现函数
 ValuePtr quoteForm(const std::vector<ValuePtr>& args, EvalEnv& env);
@@ -20,8 +27,14 @@ ValuePtr andForm(const std::vector<ValuePtr>& args, EvalEnv& env);
 ValuePtr orForm(const std::vector<ValuePtr>& args, EvalEnv& env);
 ValuePtr lambdaForm(const std::vector<ValuePtr>& args, EvalEnv& env);
 ValuePtr defineForm(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr defineMemoizedForm(const std::vector<ValuePtr>& args,
+                            EvalEnv& env);
 ValuePtr condForm(const std::vector<ValuePtr>& args, EvalEnv& env);
 ValuePtr quasiquoteForm(const std::vector<ValuePtr>& args, EvalEnv& env);
 ValuePtr beginForm(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr caseForm(const ValuePtr& form, EvalEnv& env);
+ValuePtr setForm(const std::vector<ValuePtr>& args, EvalEnv& env);
+ValuePtr defineRecordTypeForm(const std::vector<ValuePtr>& args,
+                              EvalEnv& env);
 
 #endif  // FORMS_H
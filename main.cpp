@@ -6,6 +6,9 @@
 #include "eval_env.h"
 #include "forms.h"
 #include "parser.h"
+#include "port.h"
+#include "printer.h"
+#include "region.h"
 #include "rjsj_test.hpp"
 #include "tokenizer.h"
 #include "value.h"
@@ -23,33 +26,47 @@ struct TestCtx {
             auto tokens = Tokenizer::tokenize(input);
             Parser parser(std::move(tokens));
             auto value = parser.parse();
+            // 求值期间的对象在请求区域中分配，释放后的空间由之后的分配复用
+            RegionScope region;
             auto result = env->eval(value);
+            // 测试输出直接写 std::cout，先写出求值期间 display 的内容
+            OutputPort::flushAll();
             return result->toString();
         } catch (const std::exception& e) {
+            OutputPort::flushAll();
             return "ERROR: " + std::string(e.what());
         }
     }
 };
 
 struct ReplMode {
+    // 交互时每次释放最多析构的对象数，释放大结构不会造成明显停顿
+    static constexpr std::size_t RECLAIM_BUDGET = 4096;
+
     void run(std::shared_ptr<EvalEnv> env) {
+        Value::setReclaimBudget(RECLAIM_BUDGET);
+        OutputPort& out = *OutputPort::console();
         while (true) {
             try {
-                std::cout << ">>> ";
+                // 等待输入前回收上一次求值遗留的对象
+                Value::drainReclaim();
+                out.write(">>> ");
+                // 读取标准输入前写出提示符和之前缓冲的输出
+                OutputPort::flushAll();
                 std::string line;
                 if (!std::getline(std::cin, line)) break;
                 if (line.empty()) continue;
 
                 // 特殊命令：退出
                 if (line == "exit") {
-                    std::cout << "再见!" << std::endl;
+                    out.write("再见!\n");
                     break;
                 }
 
                 // 特殊命令：重置环境
                 if (line == "reset") {
                     env = EvalEnv::createGlobal();
-                    std::cout << "环境已重置" << std::endl;
+                    out.write("环境已重置\n");
                     continue;
                 }
 
@@ -57,17 +74,23 @@ struct ReplMode {
                 auto tokens = Tokenizer::tokenize(line);
                 Parser parser(std::move(tokens));
                 auto value = parser.parse();
+                RegionScope region;
                 auto result = env->eval(value);
 
                 // 输出结果（忽略 nil 结果）
                 if (!result->isNil()) {
-                    std::cout << result->toString() << std::endl;
+                    printValue(out, *result);
+                    out.put('\n');
                 }
             } catch (const SyntaxError& e) {
+                // 标准错误不经过端口，先写出已缓冲的输出以保持先后顺序
+                OutputPort::flushAll();
                 std::cerr << "语法错误: " << e.what() << std::endl;
             } catch (const LispError& e) {
+                OutputPort::flushAll();
                 std::cerr << "求值错误: " << e.what() << std::endl;
             } catch (const std::exception& e) {
+                OutputPort::flushAll();
                 std::cerr << "未知错误: " << e.what() << std::endl;
             }
         }
@@ -85,12 +108,15 @@ struct FileMode {
             std::string content = buffer.str();
 
             auto tokens = Tokenizer::tokenize(content);
-            Parser parser(std::move(tokens));
+            // 整个文件作为一个编译单元，重复的常量共享同一对象
+            Parser parser(std::move(tokens), true);
 
             while (auto value = parser.parse()) {
+                RegionScope region;
                 env->eval(value);  // 文件模式下不输出求值结果
             }
         } catch (const std::exception& e) {
+            OutputPort::flushAll();
             std::cerr << "文件错误: " << e.what() << std::endl;
         }
     }
@@ -108,7 +134,8 @@ int main(int argc, char* argv[]) {
         // 运行所有测试
         try {
             // 修复图片中的错误：移除多余的逗号
-            RJSJ_TEST(TestCtx, Lv2, Lv3, Lv4, Lv5, Lv5Extra, Lv6, Lv7, Lv7Lib,Sicp);
+            RJSJ_TEST(TestCtx, Lv2, Lv3, Lv4, Lv5, Lv5Extra, Lv6, Lv7, Lv7Lib,Sicp,
+                      Ext);
         } catch (const std::exception& e) {
             std::cerr << "测试错误: " << e.what() << std::endl;
         }
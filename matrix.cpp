@@ -0,0 +1,96 @@
+#include "matrix.h"
+
+#include <algorithm>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "simd.h"
+
+namespace {
+
+// b 的一个分块为 BLOCK_INNER x BLOCK_COLS 个 double（128 KB），可以留在 L2 中
+constexpr std::size_t BLOCK_INNER = 64;
+constexpr std::size_t BLOCK_COLS = 256;
+constexpr std::size_t TRANSPOSE_BLOCK = 32;
+// 乘加次数超过该值时才启用多线程，否则线程开销得不偿失
+constexpr std::size_t PARALLEL_THRESHOLD = std::size_t(1) << 21;
+// 每个线程至少分到的行数
+constexpr std::size_t MIN_ROWS_PER_THREAD = 16;
+// 最多使用的线程数，超过后受内存带宽限制而收益有限
+constexpr std::size_t MAX_THREADS = 8;
+
+// 计算 c 的 [rowBegin, rowEnd) 行，c 已清零
+void multiplyRows(const double* a, const double* b, double* c,
+                  std::size_t rowBegin, std::size_t rowEnd, std::size_t inner,
+                  std::size_t cols) {
+    for (std::size_t k0 = 0; k0 < inner; k0 += BLOCK_INNER) {
+        std::size_t k1 = std::min(k0 + BLOCK_INNER, inner);
+        for (std::size_t j0 = 0; j0 < cols; j0 += BLOCK_COLS) {
+            std::size_t width = std::min(BLOCK_COLS, cols - j0);
+            for (std::size_t i = rowBegin; i < rowEnd; i++) {
+                double* row = c + i * cols + j0;
+                for (std::size_t k = k0; k < k1; k++) {
+                    axpy(a[i * inner + k], b + k * cols + j0, row, width);
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+void matrixMultiply(const double* a, const double* b, double* c,
+                    std::size_t rows, std::size_t inner, std::size_t cols) {
+    std::fill(c, c + rows * cols, 0.0);
+
+    std::size_t threads = 1;
+    if (rows * inner * cols >= PARALLEL_THRESHOLD) {
+        std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min({hardware, rows / MIN_ROWS_PER_THREAD, MAX_THREADS});
+    }
+    if (threads <= 1) {
+        multiplyRows(a, b, c, 0, rows, inner, cols);
+        return;
+    }
+
+    // 各线程写入互不重叠的行，无需同步。
+    // 先预留空间，创建线程后 emplace_back 不会再因分配失败而抛出；
+    // 无法创建线程时在当前线程计算这一段
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    std::size_t chunk = (rows + threads - 1) / threads;
+    for (std::size_t begin = chunk; begin < rows; begin += chunk) {
+        std::size_t end = std::min(begin + chunk, rows);
+        try {
+            workers.emplace_back(multiplyRows, a, b, c, begin, end, inner,
+                                 cols);
+        } catch (const std::system_error&) {
+            multiplyRows(a, b, c, begin, end, inner, cols);
+        }
+    }
+    multiplyRows(a, b, c, 0, std::min(chunk, rows), inner, cols);
+    for (auto& worker : workers) worker.join();
+}
+
+void matrixTranspose(const double* a, double* out, std::size_t rows,
+                     std::size_t cols) {
+    for (std::size_t i0 = 0; i0 < rows; i0 += TRANSPOSE_BLOCK) {
+        std::size_t i1 = std::min(i0 + TRANSPOSE_BLOCK, rows);
+        for (std::size_t j0 = 0; j0 < cols; j0 += TRANSPOSE_BLOCK) {
+            std::size_t j1 = std::min(j0 + TRANSPOSE_BLOCK, cols);
+            for (std::size_t i = i0; i < i1; i++) {
+                for (std::size_t j = j0; j < j1; j++) {
+                    out[j * rows + i] = a[i * cols + j];
+                }
+            }
+        }
+    }
+}
+
+void matrixVector(const double* a, const double* x, double* y,
+                  std::size_t rows, std::size_t cols) {
+    for (std::size_t i = 0; i < rows; i++) {
+        y[i] = dot(a + i * cols, x, cols);
+    }
+}
@@ -0,0 +1,21 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <cstddef>
+
+// 行主序稠密矩阵的计算内核，矩阵均为连续的 double 数组
+
+// c (rows x cols) = a (rows x inner) * b (inner x cols)。按块计算以复用缓存，
+// 规模较大时按行分给多个线程
+void matrixMultiply(const double* a, const double* b, double* c,
+                    std::size_t rows, std::size_t inner, std::size_t cols);
+
+// out (cols x rows) = a (rows x cols) 的转置，按块读写避免跨行跳跃
+void matrixTranspose(const double* a, double* out, std::size_t rows,
+                     std::size_t cols);
+
+// y (rows) = a (rows x cols) * x (cols)
+void matrixVector(const double* a, const double* x, double* y,
+                  std::size_t rows, std::size_t cols);
+
+#endif  // MATRIX_H
@@ -1,12 +1,86 @@
 #include "parser.h"
 
+#include <atomic>
+#include <bit>
+#include <functional>
+
 #include "error.h"
 
+namespace {
+
+struct HashConsCounters {
+    std::atomic<std::size_t> atoms{0};
+    std::atomic<std::size_t> sharedAtoms{0};
+    std::atomic<std::size_t> lists{0};
+    std::atomic<std::size_t> sharedLists{0};
+};
+
+HashConsCounters& counters() {
+    static HashConsCounters instance;
+    return instance;
+}
+
+void count(std::atomic<std::size_t>& total, std::atomic<std::size_t>& shared,
+           bool hit) {
+    total.fetch_add(1, std::memory_order_relaxed);
+    if (hit) shared.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
 /// <summary>
 /// /////
 /// </summary>
 /// <param name="tokens"></param>
-Parser::Parser(std::deque<TokenPtr> tokens) : tokens_(std::move(tokens)) {}
+Parser::Parser(std::deque<TokenPtr> tokens, bool hashCons)
+    : tokens_(std::move(tokens)), hashCons_(hashCons) {}
+
+HashConsStats Parser::hashConsStats() {
+    auto& c = counters();
+    return {c.atoms.load(std::memory_order_relaxed),
+            c.sharedAtoms.load(std::memory_order_relaxed),
+            c.lists.load(std::memory_order_relaxed),
+            c.sharedLists.load(std::memory_order_relaxed)};
+}
+
+std::size_t Parser::ListKeyHash::operator()(const ListKey& key) const {
+    std::size_t hash = key.size();
+    for (const Value* value : key) {
+        hash ^= std::hash<const Value*>()(value) + 0x9e3779b97f4a7c15ULL +
+                (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+template <typename Key, typename Make>
+ValuePtr Parser::internAtom(std::unordered_map<Key, ValuePtr>& table,
+                            const Key& key, Make make) {
+    if (!hashCons_) return make();
+    auto [it, inserted] = table.try_emplace(key);
+    if (inserted) it->second = make();
+    count(counters().atoms, counters().sharedAtoms, !inserted);
+    return it->second;
+}
+
+ValuePtr Parser::internList(std::vector<ValuePtr> values, ValuePtr tail) {
+    if (values.empty()) {
+        return CompactListValue::fromVector(std::move(values), std::move(tail));
+    }
+    ListKey key;
+    key.reserve(values.size() + 1);
+    for (auto& value : values) {
+        key.push_back(value.get());
+    }
+    key.push_back(tail ? tail.get() : makeNil().get());
+
+    auto [it, inserted] = lists_.try_emplace(std::move(key));
+    if (inserted) {
+        it->second =
+            CompactListValue::fromVector(std::move(values), std::move(tail));
+    }
+    count(counters().lists, counters().sharedLists, !inserted);
+    return it->second;
+}
 
 ValuePtr Parser::parse() {
     if (tokens_.empty()) {
@@ -17,22 +91,24 @@ ValuePtr Parser::parse() {
     switch (token->getType()) {
         case TokenType::BOOLEAN_LITERAL: {
             bool value = static_cast<BooleanLiteralToken&>(*token).getValue();
-            return std::make_shared<BooleanValue>(value);
+            return makeBoolean(value);
         }
         case TokenType::NUMERIC_LITERAL: {
             double value = static_cast<NumericLiteralToken&>(*token).getValue();
-            return std::make_shared<NumericValue>(value);
+            return internAtom(numbers_, std::bit_cast<std::uint64_t>(value),
+                              [&] { return makeNumber(value); });
         }
         case TokenType::STRING_LITERAL: {
-            std::string value =
+            const std::string& value =
                 static_cast<StringLiteralToken&>(*token).getValue();
-            return std::make_shared<StringValue>(value);
+            return internAtom(strings_, value,
+                              [&] { return makeValue<StringValue>(value); });
         }
         case TokenType::IDENTIFIER: {
             if (auto* symToken = dynamic_cast<IdentifierToken*>(token.get())) {
-                
-                return std::make_shared<SymbolValue>(symToken->getName());
-                
+                const std::string& name = symToken->getName();
+                return internAtom(symbols_, name,
+                                  [&] { return makeValue<SymbolValue>(name); });
             } else {
                 throw SyntaxError("Expected identifier token");
                 
@@ -49,47 +125,60 @@ ValuePtr Parser::parse() {
                 default: break;
             }
 
-            auto quoteSym = std::make_shared<SymbolValue>(symbolName);
+            auto quoteSym = internAtom(symbols_, std::string(symbolName), [&] {
+                return makeValue<SymbolValue>(symbolName);
+            });
+            // 引用的数据是常量，其中的子列表也可以合并
+            bool quoted = token->getType() == TokenType::QUOTE;
+            if (quoted) quoteDepth_++;
             auto quotedValue = parse();
+            if (quoted) quoteDepth_--;
             return buildList({quoteSym, quotedValue});
         }
         case TokenType::LEFT_PAREN: {
             return parseTails();
         }
+        case TokenType::VECTOR_PAREN: {
+            return parseVector();
+        }
         default: throw SyntaxError("Unexpected token: " + token->toString());
     }
 }
 
 ValuePtr Parser::parseTails() {
-    if (lookahead(TokenType::RIGHT_PAREN)) {
-        popToken();
-        return std::make_shared<NilValue>();
-    }
-
-    ValuePtr car = parse();
-
-    if (lookahead(TokenType::DOT)) {
-        popToken();
-        ValuePtr cdr = parse();
-
-        if (!lookahead(TokenType::RIGHT_PAREN)) {
-            throw SyntaxError("Expected ')' after dot expression");
+    // 先收集全部元素，再整体构造成紧凑列表
+    std::vector<ValuePtr> elements;
+    ValuePtr tail;
+    while (!lookahead(TokenType::RIGHT_PAREN)) {
+        if (!elements.empty() && lookahead(TokenType::DOT)) {
+            popToken();
+            tail = parse();
+            if (!lookahead(TokenType::RIGHT_PAREN)) {
+                throw SyntaxError("Expected ')' after dot expression");
+            }
+            break;
         }
-        popToken();
-
-        return std::make_shared<PairValue>(car, cdr);
+        elements.push_back(parse());
     }
+    popToken();
+    return buildList(std::move(elements), std::move(tail));
+}
 
-    ValuePtr cdr = parseTails();
-    return std::make_shared<PairValue>(car, cdr);
+ValuePtr Parser::parseVector() {
+    // 向量可以被 vector-set! 修改，即使在引用中也不参与合并
+    std::vector<ValuePtr> elements;
+    while (!lookahead(TokenType::RIGHT_PAREN)) {
+        elements.push_back(parse());
+    }
+    popToken();
+    return makePooledValue<VectorValue>(std::move(elements));
 }
 
-ValuePtr Parser::buildList(const std::vector<ValuePtr>& values) {
-    ValuePtr result = std::make_shared<NilValue>();
-    for (auto it = values.rbegin(); it != values.rend(); ++it) {
-        result = std::make_shared<PairValue>(*it, result);
+ValuePtr Parser::buildList(std::vector<ValuePtr> values, ValuePtr tail) {
+    if (hashCons_ && quoteDepth_ > 0) {
+        return internList(std::move(values), std::move(tail));
     }
-    return result;
+    return CompactListValue::fromVector(std::move(values), std::move(tail));
 }
 
 TokenPtr Parser::popToken() {
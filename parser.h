@@ -1,27 +1,63 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <memory>
 #include <stdexcept>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "token.h"
 #include "value.h"
 
+// 哈希合并的累计统计（所有开启合并的解析器）
+struct HashConsStats {
+    std::size_t atoms;        // 解析出的数字、字符串和符号
+    std::size_t sharedAtoms;  // 其中复用了已有对象的数量
+    std::size_t lists;        // 引用数据中的常量子列表
+    std::size_t sharedLists;  // 其中复用了已有对象的数量
+};
+
 class Parser {
 public:
-    Parser(std::deque<TokenPtr> tokens);
+    // hashCons 为真时，同一解析器内重复出现的原子常量以及引用数据中
+    // 结构相同的子列表共享同一对象（值不可变，共享是安全的）
+    explicit Parser(std::deque<TokenPtr> tokens, bool hashCons = false);
     ValuePtr parse();
 
+    static HashConsStats hashConsStats();
+
 private:
+    // 子列表的键：各元素及结尾的地址。元素已先行合并，
+    // 地址相同即结构相同
+    using ListKey = std::vector<const Value*>;
+    struct ListKeyHash {
+        std::size_t operator()(const ListKey& key) const;
+    };
+
     ValuePtr parseTails();
+    ValuePtr parseVector();
     TokenPtr popToken();
     TokenType nextTokenType() const;
     bool lookahead(TokenType type) const;
-    ValuePtr buildList(const std::vector<ValuePtr>& values);
+    ValuePtr buildList(std::vector<ValuePtr> values, ValuePtr tail = nullptr);
+
+    template <typename Key, typename Make>
+    ValuePtr internAtom(std::unordered_map<Key, ValuePtr>& table,
+                        const Key& key, Make make);
+    ValuePtr internList(std::vector<ValuePtr> values, ValuePtr tail);
 
     std::deque<TokenPtr> tokens_;
+    bool hashCons_;
+    int quoteDepth_ = 0;  // 大于 0 时正在解析引用的数据
+
+    std::unordered_map<std::uint64_t, ValuePtr> numbers_;  // 按位模式区分 -0.0
+    std::unordered_map<std::string, ValuePtr> strings_;
+    std::unordered_map<std::string, ValuePtr> symbols_;
+    std::unordered_map<ListKey, ValuePtr, ListKeyHash> lists_;
 };
 
 #endif  // PARSER_H
@@ -0,0 +1,355 @@
+#include "persistent.h"
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include "value.h"
+
+namespace {
+
+constexpr unsigned BITS = 5;
+constexpr std::size_t WIDTH = std::size_t(1) << BITS;
+constexpr std::size_t MASK = WIDTH - 1;
+// 哈希位用完后改用冲突节点
+constexpr unsigned HASH_BITS = sizeof(std::size_t) * 8;
+
+}  // namespace
+
+// ===== PersistentMap =====
+struct PersistentMap::Node {
+    // 叶子条目 child 为空；分支条目只使用 child
+    struct Entry {
+        ValuePtr key;
+        ValuePtr value;
+        std::size_t hash = 0;
+        std::shared_ptr<const Node> child;
+    };
+
+    std::uint32_t bitmap = 0;  // 冲突节点不使用位图
+    bool collision = false;
+    std::vector<Entry> entries;  // 按分支位序排列
+};
+
+namespace {
+
+using MapNode = PersistentMap::Node;
+using MapNodePtr = std::shared_ptr<const MapNode>;
+using MapEntry = MapNode::Entry;
+
+std::uint32_t branchBit(std::size_t hash, unsigned shift) {
+    return std::uint32_t(1) << ((hash >> shift) & MASK);
+}
+
+std::size_t entryIndex(const MapNode& node, std::uint32_t bit) {
+    return std::popcount(node.bitmap & (bit - 1));
+}
+
+bool sameKey(const MapEntry& entry, const ValuePtr& key, std::size_t hash) {
+    return entry.hash == hash && valuesEqual(entry.key, key);
+}
+
+// 把哈希不同（或在 shift 之后才分叉）的两个叶子合并到一棵新子树
+MapNodePtr mergeLeaves(MapEntry a, MapEntry b, unsigned shift) {
+    auto node = std::make_shared<MapNode>();
+    if (shift >= HASH_BITS) {
+        node->collision = true;
+        node->entries = {std::move(a), std::move(b)};
+        return node;
+    }
+    std::uint32_t bitA = branchBit(a.hash, shift);
+    std::uint32_t bitB = branchBit(b.hash, shift);
+    if (bitA == bitB) {
+        node->bitmap = bitA;
+        MapEntry branch;
+        branch.child = mergeLeaves(std::move(a), std::move(b), shift + BITS);
+        node->entries.push_back(std::move(branch));
+        return node;
+    }
+    node->bitmap = bitA | bitB;
+    if (bitA < bitB) {
+        node->entries = {std::move(a), std::move(b)};
+    } else {
+        node->entries = {std::move(b), std::move(a)};
+    }
+    return node;
+}
+
+MapNodePtr assocNode(const MapNodePtr& node, unsigned shift, MapEntry leaf,
+                     bool& added) {
+    if (node->collision) {
+        auto copy = std::make_shared<MapNode>(*node);
+        for (auto& entry : copy->entries) {
+            if (sameKey(entry, leaf.key, leaf.hash)) {
+                entry.value = std::move(leaf.value);
+                return copy;
+            }
+        }
+        copy->entries.push_back(std::move(leaf));
+        added = true;
+        return copy;
+    }
+
+    std::uint32_t bit = branchBit(leaf.hash, shift);
+    std::size_t index = entryIndex(*node, bit);
+    if (!(node->bitmap & bit)) {
+        auto copy = std::make_shared<MapNode>(*node);
+        copy->bitmap |= bit;
+        copy->entries.insert(copy->entries.begin() + index, std::move(leaf));
+        added = true;
+        return copy;
+    }
+
+    const MapEntry& entry = node->entries[index];
+    MapEntry replacement;
+    if (entry.child) {
+        replacement.child =
+            assocNode(entry.child, shift + BITS, std::move(leaf), added);
+        if (replacement.child == entry.child) return node;
+    } else if (sameKey(entry, leaf.key, leaf.hash)) {
+        // 值未变化时不复制路径
+        if (entry.value == leaf.value) return node;
+        replacement = std::move(leaf);
+    } else {
+        replacement.child = mergeLeaves(entry, std::move(leaf), shift + BITS);
+        added = true;
+    }
+    auto copy = std::make_shared<MapNode>(*node);
+    copy->entries[index] = std::move(replacement);
+    return copy;
+}
+
+// 删除后为空返回 nullptr；键不存在时原样返回 node
+MapNodePtr dissocNode(const MapNodePtr& node, unsigned shift,
+                      const ValuePtr& key, std::size_t hash, bool& removed) {
+    if (node->collision) {
+        for (std::size_t i = 0; i < node->entries.size(); i++) {
+            if (sameKey(node->entries[i], key, hash)) {
+                removed = true;
+                if (node->entries.size() == 1) return nullptr;
+                auto copy = std::make_shared<MapNode>(*node);
+                copy->entries.erase(copy->entries.begin() + i);
+                return copy;
+            }
+        }
+        return node;
+    }
+
+    std::uint32_t bit = branchBit(hash, shift);
+    if (!(node->bitmap & bit)) return node;
+    std::size_t index = entryIndex(*node, bit);
+    const MapEntry& entry = node->entries[index];
+
+    MapEntry replacement;
+    bool erase = false;
+    if (entry.child) {
+        auto child = dissocNode(entry.child, shift + BITS, key, hash, removed);
+        if (child == entry.child) return node;
+        if (!child) {
+            erase = true;
+        } else if (child->entries.size() == 1 && !child->entries[0].child) {
+            // 只剩一个叶子的子树收回到本层
+            replacement = child->entries[0];
+        } else {
+            replacement.child = std::move(child);
+        }
+    } else if (sameKey(entry, key, hash)) {
+        removed = true;
+        erase = true;
+    } else {
+        return node;
+    }
+
+    if (erase && node->entries.size() == 1) return nullptr;
+    auto copy = std::make_shared<MapNode>(*node);
+    if (erase) {
+        copy->bitmap &= ~bit;
+        copy->entries.erase(copy->entries.begin() + index);
+    } else {
+        copy->entries[index] = std::move(replacement);
+    }
+    return copy;
+}
+
+void forEachEntry(
+    const MapNode& node,
+    const std::function<void(const ValuePtr&, const ValuePtr&)>& fn) {
+    for (auto& entry : node.entries) {
+        if (entry.child) {
+            forEachEntry(*entry.child, fn);
+        } else {
+            fn(entry.key, entry.value);
+        }
+    }
+}
+
+}  // namespace
+
+const ValuePtr* PersistentMap::find(const ValuePtr& key) const {
+    std::size_t hash = equalHash(key);
+    const Node* node = root_.get();
+    for (unsigned shift = 0; node; shift += BITS) {
+        if (node->collision) {
+            for (auto& entry : node->entries) {
+                if (sameKey(entry, key, hash)) return &entry.value;
+            }
+            return nullptr;
+        }
+        std::uint32_t bit = branchBit(hash, shift);
+        if (!(node->bitmap & bit)) return nullptr;
+        const Node::Entry& entry = node->entries[entryIndex(*node, bit)];
+        if (!entry.child) {
+            return sameKey(entry, key, hash) ? &entry.value : nullptr;
+        }
+        node = entry.child.get();
+    }
+    return nullptr;
+}
+
+PersistentMap PersistentMap::assoc(const ValuePtr& key,
+                                   const ValuePtr& value) const {
+    Node::Entry leaf{key, value, equalHash(key), nullptr};
+    if (!root_) {
+        auto root = std::make_shared<Node>();
+        root->bitmap = branchBit(leaf.hash, 0);
+        root->entries.push_back(std::move(leaf));
+        return PersistentMap(std::move(root), 1);
+    }
+    bool added = false;
+    auto root = assocNode(root_, 0, std::move(leaf), added);
+    return PersistentMap(std::move(root), size_ + (added ? 1 : 0));
+}
+
+PersistentMap PersistentMap::dissoc(const ValuePtr& key) const {
+    if (!root_) return *this;
+    bool removed = false;
+    auto root = dissocNode(root_, 0, key, equalHash(key), removed);
+    if (!removed) return *this;
+    return PersistentMap(std::move(root), size_ - 1);
+}
+
+void PersistentMap::forEach(
+    const std::function<void(const ValuePtr&, const ValuePtr&)>& fn) const {
+    if (root_) forEachEntry(*root_, fn);
+}
+
+// ===== PersistentVector =====
+struct PersistentVector::Node {
+    std::vector<std::shared_ptr<const Node>> children;  // 内部节点
+    std::vector<ValuePtr> values;                        // 叶子节点
+};
+
+namespace {
+
+using VectorNode = PersistentVector::Node;
+using VectorNodePtr = std::shared_ptr<const VectorNode>;
+
+// 从 level 层开始，为叶子建立一条只有单个分支的路径
+VectorNodePtr newPath(unsigned level, VectorNodePtr leaf) {
+    if (level == 0) return leaf;
+    auto node = std::make_shared<VectorNode>();
+    node->children.push_back(newPath(level - BITS, std::move(leaf)));
+    return node;
+}
+
+// 把满的尾部叶子挂到树上，lastIndex 为该叶子中最后一个元素的下标
+VectorNodePtr pushTail(const VectorNodePtr& parent, unsigned level,
+                       std::size_t lastIndex, VectorNodePtr leaf) {
+    auto copy = std::make_shared<VectorNode>(*parent);
+    std::size_t slot = (lastIndex >> level) & MASK;
+    if (level == BITS) {
+        copy->children.push_back(std::move(leaf));
+    } else if (slot < parent->children.size()) {
+        copy->children[slot] = pushTail(parent->children[slot], level - BITS,
+                                        lastIndex, std::move(leaf));
+    } else {
+        copy->children.push_back(newPath(level - BITS, std::move(leaf)));
+    }
+    return copy;
+}
+
+VectorNodePtr assocInTree(const VectorNodePtr& node, unsigned level,
+                          std::size_t index, const ValuePtr& value) {
+    auto copy = std::make_shared<VectorNode>(*node);
+    if (level == 0) {
+        copy->values[index & MASK] = value;
+    } else {
+        std::size_t slot = (index >> level) & MASK;
+        copy->children[slot] =
+            assocInTree(node->children[slot], level - BITS, index, value);
+    }
+    return copy;
+}
+
+const VectorNodePtr& emptyVectorNode() {
+    static const VectorNodePtr empty = std::make_shared<VectorNode>();
+    return empty;
+}
+
+}  // namespace
+
+PersistentVector::PersistentVector()
+    : root_(emptyVectorNode()), tail_(emptyVectorNode()) {}
+
+std::size_t PersistentVector::tailOffset() const {
+    return size_ < WIDTH ? 0 : ((size_ - 1) >> BITS) << BITS;
+}
+
+const PersistentVector::Node& PersistentVector::leafFor(
+    std::size_t index) const {
+    if (index >= tailOffset()) return *tail_;
+    const Node* node = root_.get();
+    for (unsigned level = shift_; level > 0; level -= BITS) {
+        node = node->children[(index >> level) & MASK].get();
+    }
+    return *node;
+}
+
+const ValuePtr& PersistentVector::nth(std::size_t index) const {
+    return leafFor(index).values[index & MASK];
+}
+
+PersistentVector PersistentVector::conj(const ValuePtr& value) const {
+    // 尾部未满：只复制尾部
+    if (size_ - tailOffset() < WIDTH) {
+        auto tail = std::make_shared<Node>(*tail_);
+        tail->values.push_back(value);
+        return PersistentVector(size_ + 1, shift_, root_, std::move(tail));
+    }
+
+    // 尾部已满：挂到树上，根满时树增高一层
+    VectorNodePtr root;
+    unsigned shift = shift_;
+    if ((size_ >> BITS) > (std::size_t(1) << shift_)) {
+        auto grown = std::make_shared<Node>();
+        grown->children.push_back(root_);
+        grown->children.push_back(newPath(shift_, tail_));
+        root = std::move(grown);
+        shift += BITS;
+    } else {
+        root = pushTail(root_, shift_, size_ - 1, tail_);
+    }
+    auto tail = std::make_shared<Node>();
+    tail->values.push_back(value);
+    return PersistentVector(size_ + 1, shift, std::move(root),
+                            std::move(tail));
+}
+
+PersistentVector PersistentVector::assoc(std::size_t index,
+                                         const ValuePtr& value) const {
+    if (index == size_) return conj(value);
+    if (index >= tailOffset()) {
+        auto tail = std::make_shared<Node>(*tail_);
+        tail->values[index & MASK] = value;
+        return PersistentVector(size_, shift_, root_, std::move(tail));
+    }
+    return PersistentVector(size_, shift_,
+                            assocInTree(root_, shift_, index, value), tail_);
+}
+
+void PersistentVector::forEach(
+    const std::function<void(const ValuePtr&)>& fn) const {
+    for (std::size_t base = 0; base < size_; base += WIDTH) {
+        for (auto& value : leafFor(base).values) fn(value);
+    }
+}
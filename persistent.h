@@ -0,0 +1,80 @@
+#ifndef PERSISTENT_H
+#define PERSISTENT_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+class Value;
+template <typename T>
+class Ref;
+using ValuePtr = Ref<Value>;
+
+// 不可变的持久化数据结构。每次更新返回新版本，只复制从根到被修改位置的
+// 一条路径（O(log32 n) 个节点），其余节点在新旧版本之间共享。
+// 节点由 std::shared_ptr 管理，与 CompactListValue 的共享块相同
+
+// 哈希数组映射字典树（HAMT）：键按 equal? 比较，哈希取自 equalHash。
+// 每层消耗 5 位哈希，节点用位图压缩只存放存在的分支；
+// 哈希完全相同的键放在冲突节点中线性查找
+class PersistentMap {
+public:
+    struct Node;
+
+    PersistentMap() = default;
+
+    std::size_t size() const {
+        return size_;
+    }
+    // 找不到时返回 nullptr
+    const ValuePtr* find(const ValuePtr& key) const;
+    PersistentMap assoc(const ValuePtr& key, const ValuePtr& value) const;
+    PersistentMap dissoc(const ValuePtr& key) const;
+    void forEach(
+        const std::function<void(const ValuePtr&, const ValuePtr&)>& fn) const;
+
+private:
+    PersistentMap(std::shared_ptr<const Node> root, std::size_t size)
+        : root_(std::move(root)), size_(size) {}
+
+    std::shared_ptr<const Node> root_;  // 空表为 nullptr
+    std::size_t size_ = 0;
+};
+
+// 32 叉前缀树向量（带尾部缓冲）：下标按每层 5 位逐层定位，
+// 末尾不满 32 个的元素单独放在 tail 中，追加通常只复制 tail
+class PersistentVector {
+public:
+    struct Node;
+
+    PersistentVector();
+
+    std::size_t size() const {
+        return size_;
+    }
+    // 调用者保证 index < size()
+    const ValuePtr& nth(std::size_t index) const;
+    PersistentVector conj(const ValuePtr& value) const;
+    // index == size() 时等同于 conj
+    PersistentVector assoc(std::size_t index, const ValuePtr& value) const;
+    void forEach(const std::function<void(const ValuePtr&)>& fn) const;
+
+private:
+    PersistentVector(std::size_t size, unsigned shift,
+                     std::shared_ptr<const Node> root,
+                     std::shared_ptr<const Node> tail)
+        : size_(size),
+          shift_(shift),
+          root_(std::move(root)),
+          tail_(std::move(tail)) {}
+
+    std::size_t tailOffset() const;
+    const Node& leafFor(std::size_t index) const;
+
+    std::size_t size_ = 0;
+    unsigned shift_ = 5;  // 根节点所在层的位移
+    std::shared_ptr<const Node> root_;
+    std::shared_ptr<const Node> tail_;
+};
+
+#endif  // PERSISTENT_H
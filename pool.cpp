@@ -0,0 +1,155 @@
+#include "pool.h"
+
+#include <algorithm>
+#include <cctype>
+#include <new>
+
+namespace {
+
+constexpr std::size_t SLAB_SIZE = 64 * 1024;
+constexpr std::size_t ALIGNMENT = alignof(std::max_align_t);
+// 每次补充线程缓存时转移的块数
+constexpr std::size_t REFILL_BATCH = 32;
+// 线程缓存超过该数量时，把一半归还给全局链表
+constexpr std::size_t CACHE_LIMIT = 256;
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+std::mutex& registryMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::vector<MemoryPool*>& registry() {
+    static std::vector<MemoryPool*> pools;
+    return pools;
+}
+
+}  // namespace
+
+MemoryPool::MemoryPool(std::string name) : name_(std::move(name)) {
+    std::lock_guard lock(registryMutex());
+    registry().push_back(this);
+}
+
+void* MemoryPool::allocate(ThreadCache& cache, std::size_t size) {
+    if (blockSize_.load(std::memory_order_acquire) == 0) {
+        std::lock_guard lock(mutex_);
+        if (blockSize_.load(std::memory_order_relaxed) == 0) {
+            std::size_t rounded = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+            blockSize_.store(std::max(rounded, sizeof(FreeBlock)),
+                             std::memory_order_release);
+        }
+    }
+    // 同一类型的请求大小固定，意外的大请求直接交给全局堆
+    if (size > blockSize_) {
+        return ::operator new(size);
+    }
+
+    FreeBlock* block;
+    if (cache.retired) {
+        std::lock_guard lock(mutex_);
+        if (!freeList_) freeList_ = carveSlab();
+        block = static_cast<FreeBlock*>(freeList_);
+        freeList_ = block->next;
+    } else {
+        if (!cache.head) refill(cache);
+        block = static_cast<FreeBlock*>(cache.head);
+        cache.head = block->next;
+        cache.count--;
+    }
+    live_.fetch_add(1, std::memory_order_relaxed);
+    return block;
+}
+
+void MemoryPool::deallocate(ThreadCache& cache, void* ptr, std::size_t size) {
+    if (size > blockSize_) {
+        ::operator delete(ptr);
+        return;
+    }
+    live_.fetch_sub(1, std::memory_order_relaxed);
+
+    auto* block = static_cast<FreeBlock*>(ptr);
+    if (cache.retired) {
+        std::lock_guard lock(mutex_);
+        block->next = static_cast<FreeBlock*>(freeList_);
+        freeList_ = block;
+        return;
+    }
+    block->next = static_cast<FreeBlock*>(cache.head);
+    cache.head = block;
+    if (++cache.count > CACHE_LIMIT) {
+        flush(cache, CACHE_LIMIT / 2);
+    }
+}
+
+void MemoryPool::releaseCache(ThreadCache& cache) {
+    flush(cache, 0);
+    cache.retired = true;
+}
+
+void MemoryPool::refill(ThreadCache& cache) {
+    std::lock_guard lock(mutex_);
+    refills_.fetch_add(1, std::memory_order_relaxed);
+    if (!freeList_) freeList_ = carveSlab();
+    for (std::size_t i = 0; i < REFILL_BATCH && freeList_; i++) {
+        auto* block = static_cast<FreeBlock*>(freeList_);
+        freeList_ = block->next;
+        block->next = static_cast<FreeBlock*>(cache.head);
+        cache.head = block;
+        cache.count++;
+    }
+}
+
+void MemoryPool::flush(ThreadCache& cache, std::size_t keep) {
+    std::lock_guard lock(mutex_);
+    while (cache.count > keep) {
+        auto* block = static_cast<FreeBlock*>(cache.head);
+        cache.head = block->next;
+        cache.count--;
+        block->next = static_cast<FreeBlock*>(freeList_);
+        freeList_ = block;
+    }
+}
+
+void* MemoryPool::carveSlab() {
+    // 调用者已持有 mutex_
+    char* slab = static_cast<char*>(::operator new(SLAB_SIZE));
+    slabs_.push_back(slab);
+    FreeBlock* head = nullptr;
+    std::size_t count = SLAB_SIZE / blockSize_;
+    for (std::size_t i = count; i-- > 0;) {
+        auto* block = reinterpret_cast<FreeBlock*>(slab + i * blockSize_);
+        block->next = head;
+        head = block;
+    }
+    return head;
+}
+
+PoolStats MemoryPool::stats() const {
+    std::lock_guard lock(mutex_);
+    return {name_, blockSize_.load(), live_.load(std::memory_order_relaxed),
+            slabs_.size() * SLAB_SIZE,
+            refills_.load(std::memory_order_relaxed)};
+}
+
+std::vector<PoolStats> MemoryPool::allStats() {
+    std::lock_guard lock(registryMutex());
+    std::vector<PoolStats> result;
+    for (auto* pool : registry()) {
+        result.push_back(pool->stats());
+    }
+    return result;
+}
+
+std::string poolTypeName(const std::type_info& type) {
+    // MSVC 返回 "class Foo"，GCC/Clang 返回 "3Foo" 形式的修饰名
+    std::string name = type.name();
+    if (name.starts_with("class ")) return name.substr(6);
+    if (name.starts_with("struct ")) return name.substr(7);
+    std::size_t pos = 0;
+    while (pos < name.size() && std::isdigit(name[pos])) pos++;
+    return name.substr(pos);
+}
@@ -0,0 +1,85 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+struct PoolStats {
+    std::string name;
+    std::size_t blockSize;  // 每个块的字节数
+    std::size_t live;       // 尚未释放的对象数
+    std::size_t bytes;      // 向系统申请的总字节数
+    std::size_t refills;    // 线程缓存从全局空闲链表补充的次数
+};
+
+// 固定大小块的空闲链表池。每个线程先从自己的缓存中分配，
+// 缓存用完时批量从全局链表补充，全局链表也空时再切分新的大块。
+class MemoryPool {
+public:
+    // 线程本地缓存，必须保持平凡析构（由 ThreadCacheGuard 在线程退出时归还）
+    struct ThreadCache {
+        void* head;
+        std::size_t count;
+        bool retired;  // 线程已退出，之后的请求直接走全局链表
+    };
+
+    explicit MemoryPool(std::string name);
+    MemoryPool(const MemoryPool&) = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+
+    void* allocate(ThreadCache& cache, std::size_t size);
+    void deallocate(ThreadCache& cache, void* ptr, std::size_t size);
+    void releaseCache(ThreadCache& cache);
+
+    PoolStats stats() const;
+    static std::vector<PoolStats> allStats();
+
+private:
+    void refill(ThreadCache& cache);
+    void flush(ThreadCache& cache, std::size_t keep);
+    void* carveSlab();
+
+    std::string name_;
+    std::atomic<std::size_t> blockSize_{0};
+    mutable std::mutex mutex_;
+    void* freeList_ = nullptr;
+    std::vector<void*> slabs_;
+    std::atomic<std::size_t> live_{0};
+    std::atomic<std::size_t> refills_{0};
+};
+
+// 线程退出时把缓存中的块还给所属的池
+class ThreadCacheGuard {
+public:
+    ThreadCacheGuard(MemoryPool& pool, MemoryPool::ThreadCache& cache)
+        : pool_(pool), cache_(cache) {}
+    ~ThreadCacheGuard() {
+        pool_.releaseCache(cache_);
+    }
+
+private:
+    MemoryPool& pool_;
+    MemoryPool::ThreadCache& cache_;
+};
+
+std::string poolTypeName(const std::type_info& type);
+
+// 每种类型一个池；池本身永不析构，保证程序退出阶段释放对象时仍然可用
+template <typename T>
+MemoryPool& poolFor() {
+    static MemoryPool* pool = new MemoryPool(poolTypeName(typeid(T)));
+    return *pool;
+}
+
+template <typename T>
+MemoryPool::ThreadCache& threadCacheFor() {
+    static thread_local MemoryPool::ThreadCache cache{nullptr, 0, false};
+    static thread_local ThreadCacheGuard guard(poolFor<T>(), cache);
+    return cache;
+}
+
+#endif  // POOL_H
@@ -0,0 +1,124 @@
+#include "port.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <unordered_set>
+#include <utility>
+
+#include "error.h"
+
+namespace {
+
+// 所有未析构的流端口，退出时逐个刷新。
+// 与控制台端口一样永不释放，atexit 回调执行时仍然有效
+struct PortRegistry {
+    std::mutex mutex;
+    std::unordered_set<StreamPort*> ports;
+};
+
+PortRegistry& registry() {
+    static auto* instance = new PortRegistry();
+    return *instance;
+}
+
+thread_local std::shared_ptr<OutputPort> currentPort;
+
+void flushAtExit() {
+    OutputPort::flushAll();
+}
+
+}  // namespace
+
+// ===== OutputPort实现 =====
+void OutputPort::write(std::string_view text) {
+    if (closed_) throw LispError("Cannot write to a closed output port");
+    buffer_.append(text);
+    if (buffer_.size() >= BUFFER_SIZE) overflow();
+}
+
+void OutputPort::close() {
+    closed_ = true;
+}
+
+const std::shared_ptr<OutputPort>& OutputPort::current() {
+    return currentPort ? currentPort : console();
+}
+
+const std::shared_ptr<OutputPort>& OutputPort::console() {
+    static auto* port = [] {
+        std::atexit(flushAtExit);
+        return new std::shared_ptr<OutputPort>(
+            std::make_shared<StreamPort>(std::cout));
+    }();
+    return *port;
+}
+
+void OutputPort::flushAll() {
+    auto& instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    for (StreamPort* port : instance.ports) port->flush();
+}
+
+// ===== StreamPort实现 =====
+StreamPort::StreamPort(std::ostream& stream) : stream_(stream) {
+    buffer_.reserve(BUFFER_SIZE);
+    auto& instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    instance.ports.insert(this);
+}
+
+StreamPort::StreamPort(std::unique_ptr<std::ostream> owned)
+    : owned_(std::move(owned)), stream_(*owned_) {
+    buffer_.reserve(BUFFER_SIZE);
+    auto& instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    instance.ports.insert(this);
+}
+
+StreamPort::~StreamPort() {
+    {
+        auto& instance = registry();
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        instance.ports.erase(this);
+    }
+    flush();
+}
+
+std::shared_ptr<StreamPort> StreamPort::openFile(const std::string& path) {
+    auto file = std::make_unique<std::ofstream>(
+        path, std::ios::binary | std::ios::trunc);
+    if (!*file) throw LispError("Cannot open output file: " + path);
+    return std::make_shared<StreamPort>(std::move(file));
+}
+
+void StreamPort::flush() {
+    if (closed_) return;
+    drain();
+    stream_.flush();
+}
+
+void StreamPort::close() {
+    flush();
+    if (!owned_) return;
+    closed_ = true;
+    owned_.reset();
+}
+
+void StreamPort::overflow() {
+    drain();
+}
+
+void StreamPort::drain() {
+    if (buffer_.empty()) return;
+    stream_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+}
+
+// ===== OutputPortScope实现 =====
+OutputPortScope::OutputPortScope(std::shared_ptr<OutputPort> port)
+    : previous_(std::exchange(currentPort, std::move(port))) {}
+
+OutputPortScope::~OutputPortScope() {
+    currentPort = std::move(previous_);
+}
@@ -0,0 +1,102 @@
+#ifndef PORT_H
+#define PORT_H
+
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// 输出端口。写入的内容先放在用户态缓冲区中，缓冲区满、flush-output、
+// 读取标准输入前以及程序退出时才交给底层流，不再每行刷新一次
+class OutputPort {
+public:
+    static constexpr std::size_t BUFFER_SIZE = std::size_t(1) << 16;
+
+    virtual ~OutputPort() = default;
+    OutputPort(const OutputPort&) = delete;
+    OutputPort& operator=(const OutputPort&) = delete;
+
+    // 端口已关闭时抛出 LispError
+    void write(std::string_view text);
+    void put(char c) {
+        write(std::string_view(&c, 1));
+    }
+    virtual void flush() {}
+    virtual void close();
+    bool isClosed() const {
+        return closed_;
+    }
+
+    // 当前线程的当前输出端口，display 等未指定端口时写入这里，默认为控制台
+    static const std::shared_ptr<OutputPort>& current();
+    static const std::shared_ptr<OutputPort>& console();
+    // 刷新控制台和所有未关闭的文件端口；第一次创建控制台端口时
+    // 注册为 atexit 回调，正常退出和调用 exit 时都会执行
+    static void flushAll();
+
+protected:
+    OutputPort() = default;
+
+    // 缓冲区达到 BUFFER_SIZE 时调用
+    virtual void overflow() {}
+
+    std::string buffer_;
+    bool closed_ = false;
+};
+
+// 写入 std::ostream 的端口。以 unique_ptr 构造时拥有该流（文件端口），
+// 关闭时一并关闭；不拥有的流（控制台）关闭时只刷新，之后仍可写入
+class StreamPort : public OutputPort {
+public:
+    explicit StreamPort(std::ostream& stream);
+    explicit StreamPort(std::unique_ptr<std::ostream> owned);
+    ~StreamPort() override;
+
+    // 以截断方式打开文件，失败时抛出 LispError
+    static std::shared_ptr<StreamPort> openFile(const std::string& path);
+
+    void flush() override;
+    void close() override;
+
+protected:
+    void overflow() override;
+
+private:
+    // 把缓冲区交给底层流，但不要求底层流立即写出
+    void drain();
+
+    std::unique_ptr<std::ostream> owned_;
+    std::ostream& stream_;
+};
+
+// 写入内存的端口，内容在缓冲区中累积，不会被刷出
+class StringPort : public OutputPort {
+public:
+    StringPort() = default;
+
+    const std::string& contents() const {
+        return buffer_;
+    }
+    // 取走已写入的内容，端口随后为空
+    std::string take() {
+        std::string result = std::move(buffer_);
+        buffer_.clear();
+        return result;
+    }
+};
+
+// 在作用域内把 port 设为当前输出端口，离开作用域（包括异常）时恢复
+class OutputPortScope {
+public:
+    explicit OutputPortScope(std::shared_ptr<OutputPort> port);
+    ~OutputPortScope();
+    OutputPortScope(const OutputPortScope&) = delete;
+    OutputPortScope& operator=(const OutputPortScope&) = delete;
+
+private:
+    std::shared_ptr<OutputPort> previous_;
+};
+
+#endif  // PORT_H
@@ -0,0 +1,308 @@
+#include "printer.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#include "port.h"
+#include "value.h"
+
+std::string_view formatNumber(double value,
+                              char (&buffer)[NUMBER_BUFFER_SIZE]) {
+    double intPart;
+    std::to_chars_result result;
+    // -0.0 走浮点路径，保留符号
+    if (std::modf(value, &intPart) == 0.0 && intPart >= -0x1p63 &&
+        intPart < 0x1p63 && !(value == 0 && std::signbit(value))) {
+        result = std::to_chars(buffer, buffer + NUMBER_BUFFER_SIZE,
+                               static_cast<std::int64_t>(intPart));
+    } else {
+        // 不指定格式和精度时 to_chars 给出能读回原值的最短形式
+        result = std::to_chars(buffer, buffer + NUMBER_BUFFER_SIZE, value);
+    }
+    return {buffer, static_cast<std::size_t>(result.ptr - buffer)};
+}
+
+namespace {
+
+// 含有子值的对象。惰性整数区间的元素都是数值，不算在内
+bool isContainer(const Value& value) {
+    const auto& type = typeid(value);
+    if (type == typeid(RangeValue)) return false;
+    return value.isPair() || type == typeid(VectorValue) ||
+           type == typeid(RecordValue) ||
+           type == typeid(PersistentVectorValue) ||
+           type == typeid(PersistentMapValue) ||
+           type == typeid(OrderedMapValue);
+}
+
+// 创建后还能修改内容的对象，环只能经由它们形成
+bool isMutable(const Value& value) {
+    const auto& type = typeid(value);
+    return type == typeid(VectorValue) || type == typeid(RecordValue) ||
+           type == typeid(OrderedMapValue);
+}
+
+template <typename Fn>
+void forEachChild(const Value& value, Fn&& fn) {
+    const auto& type = typeid(value);
+    if (type == typeid(CompactListValue)) {
+        auto& compact = static_cast<const CompactListValue&>(value);
+        for (auto& item : compact) fn(*item);
+        fn(*compact.getTail());
+    } else if (type == typeid(VectorValue)) {
+        auto& vector = static_cast<const VectorValue&>(value);
+        for (auto& item : vector.getElements()) fn(*item);
+    } else if (type == typeid(RecordValue)) {
+        auto& record = static_cast<const RecordValue&>(value);
+        size_t count = record.getRecordType()->getFields().size();
+        for (size_t i = 0; i < count; i++) fn(*record.slot(i));
+    } else if (type == typeid(PersistentVectorValue)) {
+        static_cast<const PersistentVectorValue&>(value).getVector().forEach(
+            [&](const ValuePtr& item) { fn(*item); });
+    } else if (type == typeid(PersistentMapValue)) {
+        auto& map = static_cast<const PersistentMapValue&>(value);
+        bool isSet = map.kind() == PersistentMapValue::Kind::Set;
+        map.getMap().forEach([&](const ValuePtr& key, const ValuePtr& item) {
+            fn(*key);
+            if (!isSet) fn(*item);
+        });
+    } else if (type == typeid(OrderedMapValue)) {
+        static_cast<const OrderedMapValue&>(value).getTree().forEach(
+            [&](const ValuePtr& key, const ValuePtr& item) {
+                fn(*key);
+                fn(*item);
+            });
+    } else if (value.isPair()) {
+        fn(*value.getCar());
+        fn(*value.getCdr());
+    }
+}
+
+class Printer {
+public:
+    explicit Printer(OutputPort& port) : port_(port) {}
+
+    void print(const Value& root) {
+        visit(root);
+        while (!stack_.empty()) {
+            if (const Value* child = step(stack_.back())) visit(*child);
+        }
+    }
+
+private:
+    // 正在输出的容器
+    struct Frame {
+        enum class Kind { List, Items, Entries, Record };
+
+        Kind kind;
+        char close = ')';
+        const Value* node = nullptr;
+        ListIterator list;
+        bool dotted = false;  // 已输出非正规列表结尾前的 " . "
+        // 向量等容器的子值先依次取出到这里，持久化结构只能经 forEach 遍历
+        std::vector<const Value*> items;
+        size_t index = 0;  // 已输出的子值个数
+    };
+
+    void visit(const Value& value);
+    // 输出下一个子值前的分隔符并返回该子值；容器结束时输出结尾、出栈，
+    // 返回 nullptr
+    const Value* step(Frame& frame);
+    void findCycles(const Value& root);
+    void writeString(std::string_view text);
+    void writeLabel(long label, char suffix);
+
+    OutputPort& port_;
+    std::vector<Frame> stack_;
+    // 环检测中已进入的容器，值为是否已经离开
+    std::unordered_map<const Value*, bool> analyzed_;
+    // 环上需要标签的对象及其标签，尚未输出时为 -1
+    std::unordered_map<const Value*, long> labels_;
+    long nextLabel_ = 0;
+};
+
+void Printer::visit(const Value& value) {
+    const auto& type = typeid(value);
+    if (type == typeid(NumericValue)) {
+        char buffer[NUMBER_BUFFER_SIZE];
+        port_.write(formatNumber(value.asNumber(), buffer));
+        return;
+    }
+    if (type == typeid(StringValue)) {
+        writeString(static_cast<const StringValue&>(value).view());
+        return;
+    }
+
+    // 第一次遇到可变对象时才分析它可达的部分，不含可变对象的结构没有额外开销
+    if (isMutable(value) && !analyzed_.count(&value)) findCycles(value);
+    if (!labels_.empty()) {
+        auto it = labels_.find(&value);
+        if (it != labels_.end()) {
+            if (it->second >= 0) {
+                writeLabel(it->second, '#');
+                return;
+            }
+            it->second = nextLabel_++;
+            writeLabel(it->second, '=');
+        }
+    }
+
+    if (value.isPair()) {
+        port_.put('(');
+        Frame& frame = stack_.emplace_back();
+        frame.kind = Frame::Kind::List;
+        frame.list = ListIterator(&value, true);
+    } else if (type == typeid(RecordValue)) {
+        auto& record = static_cast<const RecordValue&>(value);
+        port_.write("#<");
+        port_.write(record.getRecordType()->getName());
+        Frame& frame = stack_.emplace_back();
+        frame.kind = Frame::Kind::Record;
+        frame.close = '>';
+        frame.node = &value;
+    } else if (isContainer(value)) {
+        bool entries = type == typeid(PersistentMapValue) ||
+                       type == typeid(OrderedMapValue);
+        if (type == typeid(VectorValue)) {
+            port_.write("#(");
+        } else if (type == typeid(PersistentVectorValue)) {
+            port_.write("#pvec(");
+        } else if (type == typeid(OrderedMapValue)) {
+            port_.write("#omap(");
+        } else if (static_cast<const PersistentMapValue&>(value).kind() ==
+                   PersistentMapValue::Kind::Set) {
+            port_.write("#pset(");
+            entries = false;
+        } else {
+            port_.write("#pmap(");
+        }
+        Frame& frame = stack_.emplace_back();
+        frame.kind = entries ? Frame::Kind::Entries : Frame::Kind::Items;
+        forEachChild(value, [&](const Value& child) {
+            frame.items.push_back(&child);
+        });
+    } else {
+        port_.write(value.toString());
+    }
+}
+
+const Value* Printer::step(Frame& frame) {
+    switch (frame.kind) {
+        case Frame::Kind::List:
+            if (frame.dotted) break;
+            if (frame.index > 0) ++frame.list;
+            if (frame.list != ListIterator()) {
+                if (frame.index++ > 0) port_.put(' ');
+                return frame.list->get();
+            }
+            if (!frame.list.tail()->isNil()) {
+                port_.write(" . ");
+                frame.dotted = true;
+                return frame.list.tail();
+            }
+            break;
+        case Frame::Kind::Items:
+            if (frame.index < frame.items.size()) {
+                if (frame.index > 0) port_.put(' ');
+                return frame.items[frame.index++];
+            }
+            break;
+        case Frame::Kind::Entries:
+            // 键值交替存放，每对输出为 (key . value)
+            if (frame.index < frame.items.size()) {
+                if (frame.index % 2 == 0) {
+                    port_.write(frame.index > 0 ? ") (" : "(");
+                } else {
+                    port_.write(" . ");
+                }
+                return frame.items[frame.index++];
+            }
+            if (frame.index > 0) port_.put(')');
+            break;
+        case Frame::Kind::Record: {
+            auto& record = static_cast<const RecordValue&>(*frame.node);
+            const auto& fields = record.getRecordType()->getFields();
+            if (frame.index < fields.size()) {
+                port_.put(' ');
+                port_.write(fields[frame.index]);
+                port_.put('=');
+                return record.slot(frame.index++).get();
+            }
+            break;
+        }
+    }
+    port_.put(frame.close);
+    stack_.pop_back();
+    return nullptr;
+}
+
+void Printer::findCycles(const Value& root) {
+    // 迭代的深度优先遍历：已进入但尚未离开的容器就是当前路径，
+    // 再次遇到路径上的容器说明有环，该容器需要标签
+    struct Entry {
+        const Value* value;
+        bool leave;
+    };
+    bool leaf = true;
+    forEachChild(root, [&](const Value& child) {
+        if (isContainer(child)) leaf = false;
+    });
+    // 只含原子的可变对象（如数值向量）不可能在环上，不必记录
+    if (leaf) return;
+    std::vector<Entry> pending{{&root, false}};
+    while (!pending.empty()) {
+        Entry entry = pending.back();
+        pending.pop_back();
+        if (entry.leave) {
+            analyzed_[entry.value] = true;
+            continue;
+        }
+        auto [it, inserted] = analyzed_.try_emplace(entry.value, false);
+        if (!inserted) {
+            if (!it->second) labels_.try_emplace(entry.value, -1);
+            continue;
+        }
+        pending.push_back({entry.value, true});
+        forEachChild(*entry.value, [&](const Value& child) {
+            if (isContainer(child)) pending.push_back({&child, false});
+        });
+    }
+}
+
+void Printer::writeString(std::string_view text) {
+    // 不需要转义的片段整段写入
+    port_.put('"');
+    size_t begin = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] != '"' && text[i] != '\\') continue;
+        port_.write(text.substr(begin, i - begin));
+        port_.put('\\');
+        begin = i;
+    }
+    port_.write(text.substr(begin));
+    port_.put('"');
+}
+
+void Printer::writeLabel(long label, char suffix) {
+    char buffer[NUMBER_BUFFER_SIZE];
+    buffer[0] = '#';
+    auto result = std::to_chars(buffer + 1, buffer + sizeof(buffer), label);
+    *result.ptr++ = suffix;
+    port_.write(std::string_view(buffer, result.ptr - buffer));
+}
+
+}  // namespace
+
+void printValue(OutputPort& port, const Value& value) {
+    Printer(port).print(value);
+}
+
+std::string printToString(const Value& value) {
+    StringPort port;
+    printValue(port, value);
+    return port.take();
+}
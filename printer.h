@@ -0,0 +1,24 @@
+#ifndef PRINTER_H
+#define PRINTER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+class OutputPort;
+class Value;
+
+// formatNumber 所需缓冲区的大小，足够容纳最长的最短往返形式
+constexpr std::size_t NUMBER_BUFFER_SIZE = 32;
+
+// 数值的外部表示：整数不带小数点，其余为能精确读回原值的最短十进制形式。
+// 结果写在 buffer 中，不分配内存
+std::string_view formatNumber(double value,
+                              char (&buffer)[NUMBER_BUFFER_SIZE]);
+
+// 把 value 的外部表示直接写入 port。嵌套结构用显式栈遍历，深度不受调用栈
+// 限制；经由向量、记录等可变对象形成的环以 SRFI-38 标签 #n= / #n# 表示
+void printValue(OutputPort& port, const Value& value);
+std::string printToString(const Value& value);
+
+#endif  // PRINTER_H
@@ -0,0 +1,206 @@
+#include "region.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr std::size_t CHUNK_SIZE = 32 * 1024;
+constexpr std::size_t ALIGNMENT = alignof(std::max_align_t);
+// 超过该大小的对象直接向全局堆申请，避免浪费块空间
+constexpr std::size_t LARGE_OBJECT_SIZE = CHUNK_SIZE / 4;
+// 最多保留的空块数量
+constexpr std::size_t MAX_FREE_CHUNKS = 8;
+
+constexpr std::size_t alignUp(std::size_t size) {
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+void* allocateChunk() {
+    return ::operator new(CHUNK_SIZE);
+}
+
+void freeChunk(void* chunk) {
+    ::operator delete(chunk);
+}
+
+// 每次分配前的对象头，记录所属的块（大对象为 nullptr）和占用的字节数
+struct alignas(std::max_align_t) AllocationHeader {
+    void* chunk;
+    std::size_t size;  // 含对象头，块内按它顺序遍历各个对象
+};
+
+thread_local Region* currentRegion = nullptr;
+
+Region& threadRegion() {
+    static thread_local Region region;
+    return region;
+}
+
+}  // namespace
+
+struct Region::Chunk {
+    Chunk* prev;
+    Chunk* next;
+    Region* owner;     // 脱离区域后为 nullptr
+    std::size_t live;  // 块内尚未释放的对象数
+    std::size_t used;  // 已分配的字节数（从数据区起算）
+
+    // 数据区紧跟在块头之后
+    char* data() {
+        return reinterpret_cast<char*>(this) + alignUp(sizeof(Chunk));
+    }
+    static std::size_t capacity() {
+        return CHUNK_SIZE - alignUp(sizeof(Chunk));
+    }
+};
+
+// 已释放对象的空间，链接在同样大小的空闲链表中
+struct Region::FreeSlot {
+    FreeSlot* prev;
+    FreeSlot* next;
+};
+
+Region::Region() : freeSlots_(LARGE_OBJECT_SIZE / ALIGNMENT + 1, nullptr) {}
+
+Region::~Region() {
+    // 线程结束时仍有存活对象的块脱离区域，由最后一个对象释放时归还
+    Chunk* chunk = active_;
+    while (chunk) {
+        Chunk* next = chunk->next;
+        chunk->owner = nullptr;
+        chunk = next;
+    }
+    while (free_) {
+        Chunk* next = free_->next;
+        freeChunk(free_);
+        free_ = next;
+    }
+}
+
+Region* Region::current() {
+    return currentRegion;
+}
+
+Region::Chunk* Region::newChunk() {
+    Chunk* chunk = free_;
+    if (chunk) {
+        free_ = chunk->next;
+        freeCount_--;
+    } else {
+        chunk = static_cast<Chunk*>(allocateChunk());
+    }
+    chunk->prev = nullptr;
+    chunk->next = active_;
+    if (active_) active_->prev = chunk;
+    chunk->owner = this;
+    chunk->live = 0;
+    chunk->used = 0;
+    active_ = chunk;
+    return chunk;
+}
+
+void Region::release(Chunk* chunk, FreeSlot* slot, std::size_t size) {
+    FreeSlot*& head = freeSlots_[size / ALIGNMENT];
+    slot->prev = nullptr;
+    slot->next = head;
+    if (head) head->prev = slot;
+    head = slot;
+    if (--chunk->live == 0) recycle(chunk);
+}
+
+void Region::recycle(Chunk* chunk) {
+    // 块内的对象都已释放，先把它们从空闲链表中摘除
+    for (std::size_t offset = 0; offset < chunk->used;) {
+        auto* header =
+            reinterpret_cast<AllocationHeader*>(chunk->data() + offset);
+        unlinkSlot(reinterpret_cast<FreeSlot*>(header + 1), header->size);
+        offset += header->size;
+    }
+    if (chunk == active_) {
+        chunk->used = 0;
+        return;
+    }
+    chunk->prev->next = chunk->next;
+    if (chunk->next) chunk->next->prev = chunk->prev;
+    releaseChunk(chunk);
+}
+
+void Region::releaseChunk(Chunk* chunk) {
+    if (freeCount_ < MAX_FREE_CHUNKS) {
+        chunk->next = free_;
+        free_ = chunk;
+        freeCount_++;
+    } else {
+        freeChunk(chunk);
+    }
+}
+
+void Region::unlinkSlot(FreeSlot* slot, std::size_t size) {
+    if (slot->prev) {
+        slot->prev->next = slot->next;
+    } else {
+        freeSlots_[size / ALIGNMENT] = slot->next;
+    }
+    if (slot->next) slot->next->prev = slot->prev;
+}
+
+void* Region::allocate(std::size_t size) {
+    // 释放后要在原位存放空闲链表的指针，至少占用一个 FreeSlot
+    std::size_t total = alignUp(sizeof(AllocationHeader) +
+                                std::max(size, sizeof(FreeSlot)));
+    if (total > LARGE_OBJECT_SIZE) {
+        auto* header =
+            static_cast<AllocationHeader*>(::operator new(total));
+        header->chunk = nullptr;
+        header->size = total;
+        return header + 1;
+    }
+
+    // 优先复用已释放对象留下的同样大小的空间
+    if (FreeSlot* slot = freeSlots_[total / ALIGNMENT]) {
+        unlinkSlot(slot, total);
+        auto* header = reinterpret_cast<AllocationHeader*>(slot) - 1;
+        static_cast<Chunk*>(header->chunk)->live++;
+        return slot;
+    }
+
+    Chunk* chunk = active_;
+    if (!chunk || chunk->used + total > Chunk::capacity()) {
+        chunk = newChunk();
+    }
+    auto* header =
+        reinterpret_cast<AllocationHeader*>(chunk->data() + chunk->used);
+    header->chunk = chunk;
+    header->size = total;
+    chunk->used += total;
+    chunk->live++;
+    return header + 1;
+}
+
+void Region::deallocate(void* ptr) {
+    auto* header = static_cast<AllocationHeader*>(ptr) - 1;
+    auto* chunk = static_cast<Chunk*>(header->chunk);
+    if (!chunk) {
+        ::operator delete(header);
+        return;
+    }
+    if (chunk->owner) {
+        chunk->owner->release(chunk, static_cast<FreeSlot*>(ptr),
+                              header->size);
+    } else if (--chunk->live == 0) {
+        // 已脱离区域的块归还给全局堆
+        freeChunk(chunk);
+    }
+}
+
+RegionScope::RegionScope() : owner_(currentRegion == nullptr) {
+    if (owner_) {
+        currentRegion = &threadRegion();
+    }
+}
+
+RegionScope::~RegionScope() {
+    if (owner_) {
+        currentRegion = nullptr;
+    }
+}
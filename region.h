@@ -0,0 +1,87 @@
+#ifndef REGION_H
+#define REGION_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+// 请求级内存区域：顶层求值期间产生的对象在块中顺序分配。
+// 块内对象全部释放后立即复用，长时间的求值不会无限占用内存；
+// 块中单个对象释放后，它的空间按大小挂入空闲链表，供之后同样大小的分配
+// 复用，因此逃逸出求值的少量对象不会让整块的其余空间一直闲置。
+// 对象从不移动，身份保持不变
+class Region {
+public:
+    Region();
+    ~Region();
+    Region(const Region&) = delete;
+    Region& operator=(const Region&) = delete;
+
+    // 当前线程上活动的区域，没有则为 nullptr
+    static Region* current();
+
+    void* allocate(std::size_t size);
+    // 释放由任意区域分配的内存（通过对象头找到所属的块）
+    static void deallocate(void* ptr);
+
+private:
+    struct Chunk;
+    struct FreeSlot;
+
+    Chunk* newChunk();
+    // 对象释放后把它的空间挂入空闲链表，块中已无存活对象时回收整块
+    void release(Chunk* chunk, FreeSlot* slot, std::size_t size);
+    // 区域中的块已无存活对象：正在分配的块从头重用，其余块移出链表
+    void recycle(Chunk* chunk);
+    void releaseChunk(Chunk* chunk);
+    void unlinkSlot(FreeSlot* slot, std::size_t size);
+
+    Chunk* active_ = nullptr;  // 正在分配的块，及其之前用过的块组成的双向链表
+    Chunk* free_ = nullptr;    // 可直接复用的空块
+    std::size_t freeCount_ = 0;
+    // 按大小分类的空闲位置链表，下标为对象占用的字节数除以对齐单位
+    std::vector<FreeSlot*> freeSlots_;
+};
+
+// 在作用域内激活当前线程的区域；嵌套时只有最外层生效
+class RegionScope {
+public:
+    RegionScope();
+    ~RegionScope();
+    RegionScope(const RegionScope&) = delete;
+    RegionScope& operator=(const RegionScope&) = delete;
+
+private:
+    bool owner_;
+};
+
+// 标准库风格的分配器，用于把 std::shared_ptr 的控制块也放在区域中
+template <typename T>
+class RegionAllocator {
+public:
+    using value_type = T;
+
+    explicit RegionAllocator(Region* region) : region_(region) {}
+    template <typename U>
+    RegionAllocator(const RegionAllocator<U>& other) : region_(other.region_) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(region_->allocate(n * sizeof(T)));
+    }
+    void deallocate(T* ptr, std::size_t) {
+        Region::deallocate(ptr);
+    }
+
+    template <typename U>
+    bool operator==(const RegionAllocator<U>& other) const {
+        return region_ == other.region_;
+    }
+
+private:
+    template <typename U>
+    friend class RegionAllocator;
+    Region* region_;
+};
+
+#endif  // REGION_H
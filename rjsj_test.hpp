@@ -1129,6 +1129,371 @@ RMLT_CASE("(define (len s) (if (eq? s '()) 0 (+ 1 (len (cdr s)))))")
 RMLT_CASE("(len '(1 2 3 4))", "4")
 RMLT_END_CASES()
 
+// 解释器扩展功能的行为测试
+RMLT_BEGIN_CASES(Ext)
+// set! 修改最近的已有绑定
+RMLT_CASE("(define (make-counter n) (lambda () (set! n (+ n 1)) n))")
+RMLT_CASE("(define c (make-counter 10))")
+RMLT_CASE("(c)", "11")
+RMLT_CASE("(c)", "12")
+RMLT_CASE("((make-counter 0))", "1")
+RMLT_CASE("(define v 1)")
+RMLT_CASE("(let ((v 2)) (set! v 3) v)", "3")
+RMLT_CASE("v", "1")
+RMLT_CASE("(set! undefined-variable 1)", "ERROR:")
+RMLT_CASE("(define (make-cell n) (list (lambda () n) (lambda (v) (set! n v))))")
+RMLT_CASE("(define cell (make-cell 1))")
+RMLT_CASE("((car (cdr cell)) 7)")
+RMLT_CASE("((car cell))", "7")
+// case 按常量分派；拼出的不同 case 共用首个子句时不能串用分派表
+RMLT_CASE("(define (kind x) (case x ((a e i o u) 'vowel) ((1 2 3) 'small) "
+          "((#t) 'yes) ((()) 'empty) (else 'other)))")
+RMLT_CASE("(kind 'e)", "vowel")
+RMLT_CASE("(kind 2)", "small")
+RMLT_CASE("(kind #t)", "yes")
+RMLT_CASE("(kind '())", "empty")
+RMLT_CASE("(kind 'z)", "other")
+RMLT_CASE("(case 5 ((1) 'one))", "()")
+RMLT_CASE("(define first-clause '((a) 1))")
+RMLT_CASE("(define case1 (list 'case 'x first-clause '((b) 2)))")
+RMLT_CASE("(define case2 (list 'case 'x first-clause '((b) 3)))")
+RMLT_CASE("(define x 'b)")
+RMLT_CASE("(eval case1)", "2")
+RMLT_CASE("(eval case2)", "3")
+RMLT_CASE("(eval case1)", "2")
+RMLT_CASE("(reduce + (map (lambda (i) (eval (list 'case i '((1) 1) '(else 0)))) (range 3000)))",
+          "1")
+RMLT_CASE("(reduce + (map (lambda (i) (if (eq? (kind i) 'small) 1 0)) (range 3000)))", "3")
+// map/filter 逐层完成，副作用顺序不变；转换器显式单遍执行
+RMLT_CASE("(define (tag s) (lambda (x) (display s) x))")
+RMLT_CASE("(with-output-to-string (lambda () (map (tag \"m\") "
+          "(map (tag \"f\") '(1 2 3)))))",
+          "\"fffmmm\"")
+RMLT_CASE("(reduce + (map (lambda (x) (* x x)) (filter odd? '(1 2 3 4 5))))",
+          "35")
+RMLT_CASE("(define xf (compose (filtering odd?) (mapping (lambda (x) (* x x)))))")
+RMLT_CASE("(transduce xf + 0 '(1 2 3 4 5))", "35")
+RMLT_CASE("(transduce xf cons '() '(1 2 3))", "((() . 1) . 9)")
+// 惰性整数区间：元素个数超出 size_t 或不是有限值时报错
+RMLT_CASE("(range 5)", "(0 1 2 3 4)")
+RMLT_CASE("(range 1 10 3)", "(1 4 7)")
+RMLT_CASE("(range 5 1)", "()")
+RMLT_CASE("(iota 3 1)", "(1 2 3)")
+RMLT_CASE("(length (range 1000000))", "1000000")
+RMLT_CASE("(length (range 1e15))", "1e15")
+RMLT_CASE("(range 1e30)", "ERROR:")
+RMLT_CASE("(range 0 (* 1e300 1e300))", "ERROR:")
+RMLT_CASE("(iota (* 1e300 1e300))", "ERROR:")
+RMLT_CASE("(range 0 1 0)", "ERROR:")
+// 紧凑列表：读入和 list 构造的列表按块存放，行为与序对链相同
+RMLT_CASE("(define lst (list 1 2 3 4))")
+RMLT_CASE("(cdr (cdr lst))", "(3 4)")
+RMLT_CASE("(cons 0 (cdr lst))", "(0 2 3 4)")
+RMLT_CASE("(length (cdr lst))", "3")
+RMLT_CASE("(list? (cdr lst))", "#t")
+RMLT_CASE("'(1 2 . 3)", "(1 2 . 3)")
+RMLT_CASE("(cdr '(1 2 . 3))", "(2 . 3)")
+RMLT_CASE("(list? '(1 2 . 3))", "#f")
+RMLT_CASE("(reduce + '(1 2 . 3))", "ERROR:")
+// 区域分配：逃逸到全局的对象保持原有标识
+RMLT_CASE("(define g '())")
+RMLT_CASE("(define x (list 1 2 3))")
+RMLT_CASE("(set! g x)")
+RMLT_CASE("(eq? g x)", "#t")
+RMLT_CASE("(define y (list (list 1) 2))")
+RMLT_CASE("(eq? (car y) (car y))", "#t")
+RMLT_CASE("(define (nest n acc) (if (= n 0) acc (nest (- n 1) (list acc))))")
+RMLT_CASE("(define deep (nest 5000 '()))")
+RMLT_CASE("(pair? deep)", "#t")
+RMLT_CASE("(reduce + (map (lambda (i) (length (list i i))) (range 100000)))",
+          "200000")
+// 按类型分池分配：每个对象池报告名字、对象大小、存活数等
+RMLT_CASE("(list? (pool-stats))", "#t")
+RMLT_CASE("(string? (car (car (pool-stats))))", "#t")
+RMLT_CASE("(define vs (map (lambda (i) (vector i)) (range 1000)))")
+RMLT_CASE("(vector-ref (car (cdr vs)) 0)", "1")
+// 侵入式引用计数：共享的对象和闭包捕获的环境在最后一个引用消失前有效
+RMLT_CASE("(define (make-adder n) (lambda (x) (+ x n)))")
+RMLT_CASE("(define add5 (make-adder 5))")
+RMLT_CASE("(set! make-adder '())")
+RMLT_CASE("(add5 10)", "15")
+RMLT_CASE("(define shared (list 1 2))")
+RMLT_CASE("(define pair-of-shared (cons shared shared))")
+RMLT_CASE("(set! shared '())")
+RMLT_CASE("(eq? (car pair-of-shared) (cdr pair-of-shared))", "#t")
+RMLT_CASE("(car pair-of-shared)", "(1 2)")
+// 释放长链和深层嵌套结构时逐个回收，不占用调用栈
+RMLT_CASE("(define chain (reduce (lambda (acc x) (cons x acc)) "
+          "(cons '() (range 300000))))")
+RMLT_CASE("(length chain)", "300000")
+RMLT_CASE("(set! chain '())")
+RMLT_CASE("(define nested (reduce (lambda (acc x) (list acc)) (range 200000)))")
+RMLT_CASE("(pair? nested)", "#t")
+RMLT_CASE("(set! nested '())")
+RMLT_CASE("chain", "()")
+// 列表遍历：紧凑列表、序对链与惰性区间都走同一遍历接口
+RMLT_CASE("(apply + (range 1000))", "499500")
+RMLT_CASE("(append '(1 2) (cons 3 '(4)) (range 5 7))", "(1 2 3 4 5 6)")
+RMLT_CASE("(length (cons 'a (list 'b 'c 'd)))", "4")
+RMLT_CASE("(filter even? (cons 1 (range 2 7)))", "(2 4 6)")
+RMLT_CASE("(map (lambda (x) (* x 10)) (cons 1 (range 2 4)))", "(10 20 30)")
+// 共享的常量对象：空表、布尔值和小整数只有一份
+RMLT_CASE("(eq? '() (cdr (list 1)))", "#t")
+RMLT_CASE("(eq? #t (= 1 1))", "#t")
+RMLT_CASE("(eq? 5 (+ 2 3))", "#t")
+RMLT_CASE("(eq? #f (null? 1))", "#t")
+// 读入时合并：同一表达式中重复的常量和引用子列表共享对象
+RMLT_CASE("(list? (hash-cons-stats))", "#t")
+RMLT_CASE("(define quoted '((1 2) (1 2)))")
+RMLT_CASE("(equal? (car quoted) (car (cdr quoted)))", "#t")
+RMLT_CASE("(eq? (string-append \"a\" \"b\") (string-append \"a\" \"b\"))", "#f")
+// equal? 与 equal-hash：深层嵌套不占用调用栈，含自身的向量也能结束
+RMLT_CASE("(= (equal-hash (list 1 2 3)) (equal-hash (cons 1 (cons 2 (cons 3 '())))))",
+          "#t")
+RMLT_CASE("(= (equal-hash (range 3)) (equal-hash '(0 1 2)))", "#t")
+RMLT_CASE("(define deep-a (reduce (lambda (acc x) (list acc)) (range 200000)))")
+RMLT_CASE("(define deep-b (reduce (lambda (acc x) (list acc)) (range 200000)))")
+RMLT_CASE("(= (equal-hash deep-a) (equal-hash deep-b))", "#t")
+RMLT_CASE("(equal? deep-a deep-b)", "#t")
+RMLT_CASE("(define self (make-vector 2 0))")
+RMLT_CASE("(vector-set! self 0 self)")
+RMLT_CASE("(number? (equal-hash self))", "#t")
+RMLT_CASE("(define inner (vector 1 2))")
+RMLT_CASE("(define holder (list inner 3))")
+RMLT_CASE("(define old-hash (equal-hash holder))")
+RMLT_CASE("(vector-set! inner 0 5)")
+RMLT_CASE("(equal? holder (list (vector 5 2) 3))", "#t")
+RMLT_CASE("(= (equal-hash holder) (equal-hash (list (vector 5 2) 3)))", "#t")
+// 哈希表：eq? 表以对象本身为键，equal? 表按结构
+RMLT_CASE("(define hq (make-hash-table eq?))")
+RMLT_CASE("(let ((k (list 1 2))) (hash-set! hq k 'v) (hash-ref hq k 'missing))", "v")
+RMLT_CASE("(define key (list 1 2))")
+RMLT_CASE("(hash-set! hq key 'stored)")
+RMLT_CASE("(hash-ref hq key 'missing)", "stored")
+RMLT_CASE("(hash-ref hq (list 1 2) 'missing)", "missing")
+RMLT_CASE("(define he (make-hash-table))")
+RMLT_CASE("(hash-set! he (list 1 2) 'by-value)")
+RMLT_CASE("(hash-ref he (list 1 2) 'missing)", "by-value")
+RMLT_CASE("(hash-count he)", "1")
+RMLT_CASE("(hash-delete! he '(1 2))")
+RMLT_CASE("(hash-contains? he '(1 2))", "#f")
+RMLT_CASE("(hash-fold hq (lambda (k v acc) (+ acc 1)) 0)", "2")
+// 向量：槽位保存对象本身，不复制
+RMLT_CASE("(define mv (make-vector 3 (list 1 2 3)))")
+RMLT_CASE("(eq? (vector-ref mv 0) (vector-ref mv 2))", "#t")
+RMLT_CASE("(define elem (list 4 5))")
+RMLT_CASE("(define vv (vector elem elem))")
+RMLT_CASE("(eq? (vector-ref vv 0) elem)", "#t")
+RMLT_CASE("(vector-set! vv 1 mv)")
+RMLT_CASE("(eq? (vector-ref vv 1) mv)", "#t")
+RMLT_CASE("#(1 \"a\" (b))", "#(1 \"a\" (b))")
+RMLT_CASE("(vector->list (list->vector '(1 2 3)))", "(1 2 3)")
+RMLT_CASE("(vector-length (make-vector 5 0))", "5")
+// 类型化数组：按元素类型紧凑存放，逐元素运算和归约
+RMLT_CASE("(array->list (array+ (f64vector 1 2 3) (f64vector 10 20 30)))",
+          "(11 22 33)")
+RMLT_CASE("(array->list (array* (f64vector 1 2) 3))", "(3 6)")
+RMLT_CASE("(array-sum (list->s64vector (range 100)))", "4950")
+RMLT_CASE("(array-dot (f64vector 1 2 3) (f64vector 4 5 6))", "32")
+RMLT_CASE("(array-max (u8vector 3 9 2))", "9")
+RMLT_CASE("(array->list (array< (f64vector 1 5) (f64vector 2 2)))", "(1 0)")
+RMLT_CASE("(define bytes (make-u8vector 3 0))")
+RMLT_CASE("(array-set! bytes 1 255)")
+RMLT_CASE("(array-ref bytes 1)", "255")
+RMLT_CASE("(array-length bytes)", "3")
+RMLT_CASE("(equal? (f64vector 1 2) (f64vector 1 2))", "#t")
+RMLT_CASE("(array+ (f64vector 1 2) (f64vector 1 2 3))", "ERROR:")
+// 矩阵：行主序存放，乘法、转置与矩阵向量积
+RMLT_CASE("(define m2 (list->matrix '((1 2) (3 4))))")
+RMLT_CASE("(matrix->list (matrix-mul m2 m2))", "((7 10) (15 22))")
+RMLT_CASE("(matrix->list (transpose m2))", "((1 3) (2 4))")
+RMLT_CASE("(array->list (mat-vec m2 (f64vector 1 1)))", "(3 7)")
+RMLT_CASE("(matrix->list (matrix+ m2 m2))", "((2 4) (6 8))")
+RMLT_CASE("(matrix-ref m2 1 0)", "3")
+RMLT_CASE("(matrix-cols (make-matrix 2 3 0))", "3")
+RMLT_CASE("(matrix-mul m2 (make-matrix 3 3 0))", "ERROR:")
+// 记录类型：构造和修改都保存对象本身
+RMLT_CASE("(define-record-type point (make-point x y) point? "
+          "(x point-x set-point-x!) (y point-y))")
+RMLT_CASE("(define coords (list 1 2))")
+RMLT_CASE("(define pt (make-point coords coords))")
+RMLT_CASE("(eq? (point-x pt) coords)", "#t")
+RMLT_CASE("(eq? (point-x pt) (point-y pt))", "#t")
+RMLT_CASE("(define other (list 3))")
+RMLT_CASE("(set-point-x! pt other)")
+RMLT_CASE("(eq? (point-x pt) other)", "#t")
+RMLT_CASE("(point? pt)", "#t")
+RMLT_CASE("(point? 5)", "#f")
+// 排序：稳定；大的数值向量和数组分段并行排序
+RMLT_CASE("(sort '(3 1 2) <)", "(1 2 3)")
+RMLT_CASE("(sort (list 3 1 2) >)", "(3 2 1)")
+RMLT_CASE("(sort '((1 . b) (0 . a) (1 . a)) (lambda (x y) (< (car x) (car y))))",
+          "((0 . a) (1 . b) (1 . a))")
+RMLT_CASE("(define big (list->vector (map (lambda (i) (- 100000 i)) (range 100000))))")
+RMLT_CASE("(sort! big <)")
+RMLT_CASE("(list (vector-ref big 0) (vector-ref big 50000) (vector-ref big 99999))",
+          "(1 50001 100000)")
+RMLT_CASE("(define big-array (list->f64vector (map (lambda (i) (- 100000 i)) (range 100000))))")
+RMLT_CASE("(sort! big-array >)")
+RMLT_CASE("(list (array-ref big-array 0) (array-ref big-array 99999))", "(100000 1)")
+// 持久化字典、集合与向量：更新返回新版本，旧版本不变
+RMLT_CASE("(define pm (pmap 'a 1 'b 2))")
+RMLT_CASE("(pmap-get (pmap-assoc pm 'c 3) 'c)", "3")
+RMLT_CASE("(pmap-count pm)", "2")
+RMLT_CASE("(pmap-contains? (pmap-dissoc pm 'a) 'a)", "#f")
+RMLT_CASE("(pmap-contains? pm 'a)", "#t")
+RMLT_CASE("(pmap-get pm 'missing 'none)", "none")
+RMLT_CASE("(pmap-get (pmap (list 1 2) 'v) (list 1 2))", "v")
+RMLT_CASE("(pset-count (pset-add (pset 1 2 3) 2))", "3")
+RMLT_CASE("(pset-contains? (pset-remove (pset 1 2 3) 2) 2)", "#f")
+RMLT_CASE("(define pv (pvec 1 2 3))")
+RMLT_CASE("(pvec->list (pvec-conj pv 4))", "(1 2 3 4)")
+RMLT_CASE("(pvec-nth (pvec-assoc pv 0 'x) 0)", "x")
+RMLT_CASE("(pvec->list pv)", "(1 2 3)")
+RMLT_CASE("(pvec-count (reduce pvec-conj (cons (pvec) (range 5000))))", "5000")
+// 有序字典：按键有序遍历，区间查询为左闭右开
+RMLT_CASE("(define om (make-omap))")
+RMLT_CASE("(omap-insert! om 3 'c)")
+RMLT_CASE("(omap-insert! om 1 'a)")
+RMLT_CASE("(omap-insert! om 2 'b)")
+RMLT_CASE("(omap->list om)", "((1 . a) (2 . b) (3 . c))")
+RMLT_CASE("(omap-ref om 2)", "b")
+RMLT_CASE("(omap-min om)", "(1 . a)")
+RMLT_CASE("(omap-max om)", "(3 . c)")
+RMLT_CASE("(omap-range om 2 3)", "((2 . b))")
+RMLT_CASE("(omap-delete! om 2)")
+RMLT_CASE("(omap-count om)", "2")
+RMLT_CASE("(omap-contains? om 2)", "#f")
+RMLT_CASE("(omap-ref om 9 'none)", "none")
+RMLT_CASE("(define big-om (make-omap))")
+RMLT_CASE("(reduce + (map (lambda (i) (omap-insert! big-om (- 10000 i) i) 1) (range 10000)))",
+          "10000")
+RMLT_CASE("(omap-min big-om)", "(1 . 9999)")
+RMLT_CASE("(length (omap-range big-om 100 200))", "100")
+// 字符串：子串共享缓冲区，反复追加只新建 rope 节点
+RMLT_CASE("(define acc \"\")")
+RMLT_CASE("(reduce + (map (lambda (i) (set! acc (string-append acc \"abc\")) 1) (range 100000)))",
+          "100000")
+RMLT_CASE("(string-length acc)", "300000")
+RMLT_CASE("(substring acc 299997)", "\"abc\"")
+RMLT_CASE("(string-index acc \"cab\")", "2")
+RMLT_CASE("(define (grow n) (if (= n 0) 'done (begin (set! acc (string-append acc \"x\")) (grow (- n 1)))))")
+RMLT_CASE("(grow 1000)", "done")
+RMLT_CASE("(string-length acc)", "301000")
+RMLT_CASE("(string-split \"a,b,,c\" \",\")", "(\"a\" \"b\" \"\" \"c\")")
+RMLT_CASE("(string-join '(\"a\" \"b\" \"c\") \"-\")", "\"a-b-c\"")
+RMLT_CASE("(equal? (string-append \"ab\" \"cd\") \"abcd\")", "#t")
+RMLT_CASE("(string->number \"2.5\")", "2.5")
+RMLT_CASE("(number->string 42)", "\"42\"")
+// 输出端口：字符串端口收集输出，关闭后不能再写
+RMLT_CASE("(define sp (open-output-string))")
+RMLT_CASE("(display \"hi\" sp)")
+RMLT_CASE("(display 42 sp)")
+RMLT_CASE("(get-output-string sp)", "\"hi42\"")
+RMLT_CASE("(output-port? sp)", "#t")
+RMLT_CASE("(output-port? 1)", "#f")
+RMLT_CASE("(with-output-to-string (lambda () (display \"a\") (display 1)))", "\"a1\"")
+RMLT_CASE("(output-port? (current-output-port))", "#t")
+RMLT_CASE("(close-output-port sp)")
+RMLT_CASE("(display \"x\" sp)", "ERROR:")
+// 打印：数值取能读回的最短形式，-0.0 保留符号，经由向量的环用标签表示
+RMLT_CASE("(number->string (- 0.0))", "\"-0\"")
+RMLT_CASE("(number->string (- 5 5))", "\"0\"")
+RMLT_CASE("(number->string 0.1)", "\"0.1\"")
+RMLT_CASE("(number->string (/ 1 3))", "\"0.3333333333333333\"")
+RMLT_CASE("(number->string -42)", "\"-42\"")
+RMLT_CASE("(define cyc (vector 1 2))")
+RMLT_CASE("(vector-set! cyc 0 cyc)")
+RMLT_CASE("(with-output-to-string (lambda () (display cyc)))", "\"#0=#(#0# 2)\"")
+RMLT_CASE("(with-output-to-string (lambda () (display (list 1 (vector 2) \"s\"))))",
+          "\"(1 #(2) \\\"s\\\")\"")
+// 记忆化：相同参数只计算一次，结果保持对象标识
+RMLT_CASE("(define calls 0)")
+RMLT_CASE("(define slow-sq (memoize (lambda (x) (set! calls (+ calls 1)) (* x x))))")
+RMLT_CASE("(list (slow-sq 4) (slow-sq 4) calls)", "(16 16 1)")
+RMLT_CASE("(memo-stats slow-sq)", "(1 1 1 1024)")
+RMLT_CASE("(memo-clear! slow-sq)")
+RMLT_CASE("(slow-sq 4)", "16")
+RMLT_CASE("calls", "2")
+RMLT_CASE("(define-memoized (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))")
+RMLT_CASE("(fib 60)", "1548008755920")
+RMLT_CASE("(define memo-key (list 1 2))")
+RMLT_CASE("(define memo-id (memoize (lambda (x) (list x))))")
+RMLT_CASE("(eq? (memo-id memo-key) (memo-id memo-key))", "#t")
+RMLT_CASE("(eq? (car (memo-id memo-key)) memo-key)", "#t")
+// 区间与其他列表表示按内容比较，区间本身为真值
+RMLT_CASE("(equal? (range 3) (list 0 1 2))", "#t")
+RMLT_CASE("(equal? (list 0 1 2) (range 3))", "#t")
+RMLT_CASE("(equal? (range 3) (range 3))", "#t")
+RMLT_CASE("(equal? (range 3) (list 0 1))", "#f")
+RMLT_CASE("(if (range 2) 'yes 'no)", "yes")
+// 逃逸对象所在块中已释放的空间被之后的分配复用，存活对象保持不变
+RMLT_CASE("(define kept (list 1 2 3))", "()")
+RMLT_CASE("(length (map (lambda (x) (list x x)) (range 5000)))", "5000")
+RMLT_CASE("kept", "(1 2 3)")
+RMLT_CASE("(define kept-table (make-hash-table))", "()")
+RMLT_CASE("(length (map (lambda (i) (hash-set! kept-table i (list i (* i 2)))) (range 2000)))", "2000")
+RMLT_CASE("(hash-ref kept-table 1999)", "(1999 3998)")
+RMLT_CASE("(eq? (hash-ref kept-table 7) (hash-ref kept-table 7))", "#t")
+// 对象池统计随一批分配和释放变化：存活数回落，已申请的内存和补充次数保留
+RMLT_CASE("(define (pool-entry name) (car (filter (lambda (e) (equal? (car e) name)) (pool-stats))))", "()")
+RMLT_CASE("(define (pool-field entry i) (if (= i 0) (car entry) (pool-field (cdr entry) (- i 1))))", "()")
+RMLT_CASE("(define keep-vector (vector 1))", "()")
+RMLT_CASE("(define stats-before (pool-entry \"VectorValue\"))", "()")
+RMLT_CASE("(define burst (map (lambda (i) (make-vector 1 i)) (range 3000)))", "()")
+RMLT_CASE("(define stats-during (pool-entry \"VectorValue\"))", "()")
+RMLT_CASE("(- (pool-field stats-during 2) (pool-field stats-before 2))", "3000")
+RMLT_CASE("(> (pool-field stats-during 3) (pool-field stats-before 3))", "#t")
+RMLT_CASE("(> (pool-field stats-during 4) (pool-field stats-before 4))", "#t")
+RMLT_CASE("(set! burst '())", "()")
+RMLT_CASE("(define stats-after (pool-entry \"VectorValue\"))", "()")
+RMLT_CASE("(= (pool-field stats-after 2) (pool-field stats-before 2))", "#t")
+RMLT_CASE("(= (pool-field stats-after 3) (pool-field stats-during 3))", "#t")
+RMLT_CASE("(= (pool-field stats-after 4) (pool-field stats-during 4))", "#t")
+// memq 按指针比较：计算得到的小整数和布尔值与常量池中的对象是同一个
+RMLT_CASE("(memq (+ 2 3) (list 5))", "(5)")
+RMLT_CASE("(memq (* 1.5 2) (list 3))", "(3)")
+RMLT_CASE("(memq (+ 1000 24) (list 1024))", "(1024)")
+RMLT_CASE("(memq (- 0 1024) (list (- 1 1025)))", "(-1024)")
+RMLT_CASE("(memq (+ 1000 25) (list 1025))", "#f")
+RMLT_CASE("(memq (- 0 1025) (list (- 1 1026)))", "#f")
+RMLT_CASE("(memq (= 1 1) (list (< 1 2)))", "(#t)")
+RMLT_CASE("(memq (null? 1) (list (pair? 1)))", "(#f)")
+// 符号键按编号哈希和比较，同名符号命中同一项
+RMLT_CASE("(define hs (make-hash-table eq?))", "()")
+RMLT_CASE("(hash-set! hs 'alpha 1)", "()")
+RMLT_CASE("(hash-set! hs 'alpha 2)", "()")
+RMLT_CASE("(hash-ref hs 'alpha)", "2")
+RMLT_CASE("(hash-ref hs 'beta 'missing)", "missing")
+RMLT_CASE("(define hl (make-hash-table))", "()")
+RMLT_CASE("(hash-set! hl (list 'a 'b) 'found)", "()")
+RMLT_CASE("(hash-ref hl (list 'a 'b))", "found")
+// 包含自身的向量：equal? 不会无限展开，哈希表键同样可用
+RMLT_CASE("(define ca (vector 1 2 0))", "()")
+RMLT_CASE("(define cb (vector 1 2 0))", "()")
+RMLT_CASE("(define cc (vector 1 3 0))", "()")
+RMLT_CASE("(begin (vector-set! ca 2 ca) (vector-set! cb 2 cb) (vector-set! cc 2 cc) 'ok)", "ok")
+RMLT_CASE("(equal? ca cb)", "#t")
+RMLT_CASE("(equal? ca cc)", "#f")
+RMLT_CASE("(equal? (list ca) (list cb))", "#t")
+RMLT_CASE("(define hc (make-hash-table))", "()")
+RMLT_CASE("(hash-set! hc ca 'cyclic)", "()")
+RMLT_CASE("(hash-ref hc cb 'none)", "cyclic")
+// array-min/array-max 遇到 NaN 时结果为 NaN，标量路径（少于 4 个元素）与 AVX2 路径一致
+RMLT_CASE("(define nan (- (* 1e300 1e300) (* 1e300 1e300)))", "()")
+RMLT_CASE("(let ((m (array-min (f64vector 1 nan 2)))) (= m m))", "#f")
+RMLT_CASE("(let ((m (array-max (f64vector 1 2 nan)))) (= m m))", "#f")
+RMLT_CASE("(let ((m (array-min (f64vector nan 1 2 3 4 5 6 7 8)))) (= m m))", "#f")
+RMLT_CASE("(let ((m (array-max (f64vector 1 2 3 4 nan 6 7 8)))) (= m m))", "#f")
+RMLT_CASE("(let ((m (array-min (f64vector 1 2 3 4 5 6 7 8 nan)))) (= m m))", "#f")
+RMLT_CASE("(array-min (f64vector 5 3 9 1 7 2 8 6 4))", "1")
+RMLT_CASE("(array-max (f64vector 5 3 9 1 7 2 8 6 4))", "9")
+// 足够大的矩阵乘法按行分给多个线程，各段结果都正确
+RMLT_CASE("(define ones (make-matrix 160 160 1))", "()")
+RMLT_CASE("(define ones-sq (matrix-mul ones ones))", "()")
+RMLT_CASE("(list (matrix-ref ones-sq 0 0) (matrix-ref ones-sq 80 17) (matrix-ref ones-sq 159 159))", "(160 160 160)")
+RMLT_END_CASES()
+
 #undef RMLT_BEGIN_CASES
 #undef RMLT_CASE
 #undef RMLT_END_CASES
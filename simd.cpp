@@ -0,0 +1,602 @@
+#include "simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+#define MINI_LISP_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+// MSVC 不需要额外的编译选项即可使用 AVX2 内建函数
+#define MINI_LISP_AVX2
+#else
+// GCC/Clang 按函数开启 AVX2，其余代码仍按基线指令集编译
+#define MINI_LISP_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+// ===== 标量实现 =====
+// 整数运算先转换为无符号类型，溢出时按补码回绕而不是未定义行为
+template <typename T>
+using Unsigned = std::make_unsigned_t<T>;
+
+template <ArithmeticOp Op, typename T>
+T applyOp(T x, T y) {
+    if constexpr (std::is_floating_point_v<T>) {
+        if constexpr (Op == ArithmeticOp::Add) return x + y;
+        if constexpr (Op == ArithmeticOp::Subtract) return x - y;
+        if constexpr (Op == ArithmeticOp::Multiply) return x * y;
+        if constexpr (Op == ArithmeticOp::Divide) return x / y;
+    } else {
+        using U = Unsigned<T>;
+        if constexpr (Op == ArithmeticOp::Add) return T(U(x) + U(y));
+        if constexpr (Op == ArithmeticOp::Subtract) return T(U(x) - U(y));
+        if constexpr (Op == ArithmeticOp::Multiply) return T(U(x) * U(y));
+        if constexpr (Op == ArithmeticOp::Divide) {
+            // 最小负数除以 -1 会溢出，按取反回绕处理
+            if constexpr (std::is_signed_v<T>) {
+                if (y == -1) return T(U(0) - U(x));
+            }
+            return T(x / y);
+        }
+    }
+}
+
+template <CompareOp Op, typename T>
+bool compareOp(T x, T y) {
+    if constexpr (Op == CompareOp::Less) return x < y;
+    if constexpr (Op == CompareOp::LessEqual) return x <= y;
+    if constexpr (Op == CompareOp::Greater) return x > y;
+    if constexpr (Op == CompareOp::GreaterEqual) return x >= y;
+    if constexpr (Op == CompareOp::Equal) return x == y;
+}
+
+// 按两个操作数是否广播分别展开循环，使编译器能够自动向量化
+template <typename In, typename Out, typename Fn>
+void forEachPair(const In* a, std::size_t aStep, const In* b,
+                 std::size_t bStep, Out* out, std::size_t n, Fn fn) {
+    if (aStep && bStep) {
+        for (std::size_t i = 0; i < n; i++) out[i] = fn(a[i], b[i]);
+    } else if (aStep) {
+        const In y = *b;
+        for (std::size_t i = 0; i < n; i++) out[i] = fn(a[i], y);
+    } else if (bStep) {
+        const In x = *a;
+        for (std::size_t i = 0; i < n; i++) out[i] = fn(x, b[i]);
+    } else {
+        std::fill(out, out + n, fn(*a, *b));
+    }
+}
+
+template <ArithmeticOp Op, typename T>
+void arithmeticScalar(const T* a, std::size_t aStep, const T* b,
+                      std::size_t bStep, T* out, std::size_t n) {
+    forEachPair(a, aStep, b, bStep, out, n,
+                [](T x, T y) { return applyOp<Op>(x, y); });
+}
+
+template <CompareOp Op, typename T>
+void compareScalar(const T* a, std::size_t aStep, const T* b,
+                   std::size_t bStep, std::uint8_t* out, std::size_t n) {
+    forEachPair(a, aStep, b, bStep, out, n, [](T x, T y) {
+        return static_cast<std::uint8_t>(compareOp<Op>(x, y));
+    });
+}
+
+template <typename Acc, typename T>
+Acc sumScalar(const T* a, std::size_t n) {
+    Acc total = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        total = applyOp<ArithmeticOp::Add>(total, static_cast<Acc>(a[i]));
+    }
+    return total;
+}
+
+template <typename Acc, typename T>
+Acc dotScalar(const T* a, const T* b, std::size_t n) {
+    Acc total = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        Acc product = applyOp<ArithmeticOp::Multiply>(static_cast<Acc>(a[i]),
+                                                      static_cast<Acc>(b[i]));
+        total = applyOp<ArithmeticOp::Add>(total, product);
+    }
+    return total;
+}
+
+// 浮点数的最值在遇到 NaN 时返回 NaN，与 AVX2 实现一致。
+// std::min/std::max 在第一个参数为 NaN 时已返回它，只需检查第二个参数
+template <bool Max, typename T>
+T pickExtreme(T result, T x) {
+    if constexpr (std::is_floating_point_v<T>) {
+        if (std::isnan(x)) return x;
+    }
+    return Max ? std::max(result, x) : std::min(result, x);
+}
+
+template <typename T>
+T minScalar(const T* a, std::size_t n) {
+    T result = a[0];
+    for (std::size_t i = 1; i < n; i++) {
+        result = pickExtreme<false>(result, a[i]);
+    }
+    return result;
+}
+
+template <typename T>
+T maxScalar(const T* a, std::size_t n) {
+    T result = a[0];
+    for (std::size_t i = 1; i < n; i++) {
+        result = pickExtreme<true>(result, a[i]);
+    }
+    return result;
+}
+
+// ===== AVX2 实现 =====
+#ifdef MINI_LISP_X86
+
+bool detectAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    // 还需要操作系统在上下文切换时保存 YMM 寄存器
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+template <typename T>
+constexpr std::size_t LANES = 32 / sizeof(T);
+
+template <typename T>
+MINI_LISP_AVX2 __m256i broadcastInt(T value) {
+    if constexpr (sizeof(T) == 8) {
+        return _mm256_set1_epi64x(static_cast<long long>(value));
+    } else {
+        return _mm256_set1_epi8(static_cast<char>(value));
+    }
+}
+
+template <ArithmeticOp Op>
+MINI_LISP_AVX2 __m256d applyAvx2(__m256d x, __m256d y) {
+    if constexpr (Op == ArithmeticOp::Add) return _mm256_add_pd(x, y);
+    if constexpr (Op == ArithmeticOp::Subtract) return _mm256_sub_pd(x, y);
+    if constexpr (Op == ArithmeticOp::Multiply) return _mm256_mul_pd(x, y);
+    if constexpr (Op == ArithmeticOp::Divide) return _mm256_div_pd(x, y);
+}
+
+// AVX2 只有整数加减的逐元素指令，乘除由调用者走标量路径
+template <ArithmeticOp Op, typename T>
+MINI_LISP_AVX2 __m256i applyAvx2(__m256i x, __m256i y) {
+    static_assert(Op == ArithmeticOp::Add || Op == ArithmeticOp::Subtract);
+    if constexpr (sizeof(T) == 8) {
+        return Op == ArithmeticOp::Add ? _mm256_add_epi64(x, y)
+                                       : _mm256_sub_epi64(x, y);
+    } else {
+        return Op == ArithmeticOp::Add ? _mm256_add_epi8(x, y)
+                                       : _mm256_sub_epi8(x, y);
+    }
+}
+
+template <ArithmeticOp Op, typename T>
+MINI_LISP_AVX2 void arithmeticAvx2(const T* a, std::size_t aStep, const T* b,
+                                   std::size_t bStep, T* out, std::size_t n) {
+    std::size_t i = 0;
+    if constexpr (std::is_same_v<T, double>) {
+        const __m256d va = _mm256_set1_pd(*a);
+        const __m256d vb = _mm256_set1_pd(*b);
+        for (; i + LANES<T> <= n; i += LANES<T>) {
+            __m256d x = aStep ? _mm256_loadu_pd(a + i) : va;
+            __m256d y = bStep ? _mm256_loadu_pd(b + i) : vb;
+            _mm256_storeu_pd(out + i, applyAvx2<Op>(x, y));
+        }
+    } else {
+        const __m256i va = broadcastInt(*a);
+        const __m256i vb = broadcastInt(*b);
+        for (; i + LANES<T> <= n; i += LANES<T>) {
+            __m256i x = aStep ? _mm256_loadu_si256(
+                                    reinterpret_cast<const __m256i*>(a + i))
+                              : va;
+            __m256i y = bStep ? _mm256_loadu_si256(
+                                    reinterpret_cast<const __m256i*>(b + i))
+                              : vb;
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                                applyAvx2<Op, T>(x, y));
+        }
+    }
+    for (; i < n; i++) {
+        out[i] = applyOp<Op>(a[i * aStep], b[i * bStep]);
+    }
+}
+
+template <CompareOp Op>
+MINI_LISP_AVX2 void compareAvx2(const double* a, std::size_t aStep,
+                                const double* b, std::size_t bStep,
+                                std::uint8_t* out, std::size_t n) {
+    constexpr int PREDICATE = Op == CompareOp::Less           ? _CMP_LT_OQ
+                              : Op == CompareOp::LessEqual    ? _CMP_LE_OQ
+                              : Op == CompareOp::Greater      ? _CMP_GT_OQ
+                              : Op == CompareOp::GreaterEqual ? _CMP_GE_OQ
+                                                              : _CMP_EQ_OQ;
+    const __m256d va = _mm256_set1_pd(*a);
+    const __m256d vb = _mm256_set1_pd(*b);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = aStep ? _mm256_loadu_pd(a + i) : va;
+        __m256d y = bStep ? _mm256_loadu_pd(b + i) : vb;
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(x, y, PREDICATE));
+        for (int k = 0; k < 4; k++) out[i + k] = (mask >> k) & 1;
+    }
+    for (; i < n; i++) {
+        out[i] = compareOp<Op>(a[i * aStep], b[i * bStep]);
+    }
+}
+
+// 水平相加 4 个双精度分量
+MINI_LISP_AVX2 double horizontalSum(__m256d v) {
+    __m128d low = _mm256_castpd256_pd128(v);
+    __m128d high = _mm256_extractf128_pd(v, 1);
+    __m128d pair = _mm_add_pd(low, high);
+    return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+MINI_LISP_AVX2 std::uint64_t horizontalSum(__m256i v) {
+    alignas(32) std::uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+// 两组累加器交替使用，隐藏加法延迟
+MINI_LISP_AVX2 double sumAvx2(const double* a, std::size_t n) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(a + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(a + i + 4));
+    }
+    double total = horizontalSum(_mm256_add_pd(acc0, acc1));
+    for (; i < n; i++) total += a[i];
+    return total;
+}
+
+MINI_LISP_AVX2 std::int64_t sumAvx2(const std::int64_t* a, std::size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm256_add_epi64(
+            acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+    }
+    auto total = static_cast<std::int64_t>(horizontalSum(acc));
+    for (; i < n; i++) total = applyOp<ArithmeticOp::Add>(total, a[i]);
+    return total;
+}
+
+// 与零做绝对差求和，每 8 个字节得到一个 64 位部分和
+MINI_LISP_AVX2 std::uint64_t sumAvx2(const std::uint8_t* a, std::size_t n) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = zero;
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i bytes =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(bytes, zero));
+    }
+    std::uint64_t total = horizontalSum(acc);
+    for (; i < n; i++) total += a[i];
+    return total;
+}
+
+MINI_LISP_AVX2 double dotAvx2(const double* a, const double* b,
+                              std::size_t n) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(
+            acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4),
+                                                 _mm256_loadu_pd(b + i + 4)));
+    }
+    double total = horizontalSum(_mm256_add_pd(acc0, acc1));
+    for (; i < n; i++) total += a[i] * b[i];
+    return total;
+}
+
+MINI_LISP_AVX2 void axpyAvx2(double alpha, const double* x, double* y,
+                             std::size_t n) {
+    const __m256d va = _mm256_set1_pd(alpha);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d y0 = _mm256_add_pd(_mm256_loadu_pd(y + i),
+                                   _mm256_mul_pd(va, _mm256_loadu_pd(x + i)));
+        __m256d y1 =
+            _mm256_add_pd(_mm256_loadu_pd(y + i + 4),
+                          _mm256_mul_pd(va, _mm256_loadu_pd(x + i + 4)));
+        _mm256_storeu_pd(y + i, y0);
+        _mm256_storeu_pd(y + i + 4, y1);
+    }
+    for (; i < n; i++) y[i] += alpha * x[i];
+}
+
+template <bool Max>
+MINI_LISP_AVX2 double extremeAvx2(const double* a, std::size_t n) {
+    if (n < 4) return Max ? maxScalar(a, n) : minScalar(a, n);
+    __m256d acc = _mm256_loadu_pd(a);
+    // vminpd/vmaxpd 遇到 NaN 时返回第二个操作数，会丢掉累加器中的 NaN，
+    // 因此单独记录出现过 NaN 的通道，出现时改用标量实现得到相同的结果
+    __m256d nan = _mm256_cmp_pd(acc, acc, _CMP_UNORD_Q);
+    std::size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(a + i);
+        nan = _mm256_or_pd(nan, _mm256_cmp_pd(x, x, _CMP_UNORD_Q));
+        acc = Max ? _mm256_max_pd(acc, x) : _mm256_min_pd(acc, x);
+    }
+    if (_mm256_movemask_pd(nan)) {
+        return Max ? maxScalar(a, n) : minScalar(a, n);
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, acc);
+    double result = Max ? maxScalar(lanes, 4) : minScalar(lanes, 4);
+    for (; i < n; i++) result = pickExtreme<Max>(result, a[i]);
+    return result;
+}
+
+template <bool Max>
+MINI_LISP_AVX2 std::uint8_t extremeAvx2(const std::uint8_t* a,
+                                        std::size_t n) {
+    if (n < 32) return Max ? maxScalar(a, n) : minScalar(a, n);
+    __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+    std::size_t i = 32;
+    for (; i + 32 <= n; i += 32) {
+        __m256i x =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        acc = Max ? _mm256_max_epu8(acc, x) : _mm256_min_epu8(acc, x);
+    }
+    alignas(32) std::uint8_t lanes[32];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    std::uint8_t result = Max ? maxScalar(lanes, 32) : minScalar(lanes, 32);
+    for (; i < n; i++) {
+        result = pickExtreme<Max>(result, a[i]);
+    }
+    return result;
+}
+
+#endif  // MINI_LISP_X86
+
+// 检测结果只计算一次
+bool useAvx2() {
+#ifdef MINI_LISP_X86
+    static const bool supported = detectAvx2();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+// 把运行时的运算种类分派到编译期展开的内核
+template <typename T>
+void dispatchArithmetic(ArithmeticOp op, const T* a, std::size_t aStep,
+                        const T* b, std::size_t bStep, T* out,
+                        std::size_t n) {
+    if (n == 0) return;
+#ifdef MINI_LISP_X86
+    constexpr bool integral = std::is_integral_v<T>;
+    if (useAvx2()) {
+        switch (op) {
+            case ArithmeticOp::Add:
+                return arithmeticAvx2<ArithmeticOp::Add>(a, aStep, b, bStep,
+                                                         out, n);
+            case ArithmeticOp::Subtract:
+                return arithmeticAvx2<ArithmeticOp::Subtract>(a, aStep, b,
+                                                              bStep, out, n);
+            case ArithmeticOp::Multiply:
+                if constexpr (!integral) {
+                    return arithmeticAvx2<ArithmeticOp::Multiply>(
+                        a, aStep, b, bStep, out, n);
+                }
+                break;
+            case ArithmeticOp::Divide:
+                if constexpr (!integral) {
+                    return arithmeticAvx2<ArithmeticOp::Divide>(
+                        a, aStep, b, bStep, out, n);
+                }
+                break;
+        }
+    }
+#endif
+    switch (op) {
+        case ArithmeticOp::Add:
+            return arithmeticScalar<ArithmeticOp::Add>(a, aStep, b, bStep, out,
+                                                       n);
+        case ArithmeticOp::Subtract:
+            return arithmeticScalar<ArithmeticOp::Subtract>(a, aStep, b, bStep,
+                                                            out, n);
+        case ArithmeticOp::Multiply:
+            return arithmeticScalar<ArithmeticOp::Multiply>(a, aStep, b, bStep,
+                                                            out, n);
+        case ArithmeticOp::Divide:
+            return arithmeticScalar<ArithmeticOp::Divide>(a, aStep, b, bStep,
+                                                          out, n);
+    }
+}
+
+template <typename T>
+void dispatchCompare(CompareOp op, const T* a, std::size_t aStep, const T* b,
+                     std::size_t bStep, std::uint8_t* out, std::size_t n) {
+    if (n == 0) return;
+#ifdef MINI_LISP_X86
+    if constexpr (std::is_same_v<T, double>) {
+        if (useAvx2()) {
+            switch (op) {
+                case CompareOp::Less:
+                    return compareAvx2<CompareOp::Less>(a, aStep, b, bStep,
+                                                        out, n);
+                case CompareOp::LessEqual:
+                    return compareAvx2<CompareOp::LessEqual>(a, aStep, b,
+                                                             bStep, out, n);
+                case CompareOp::Greater:
+                    return compareAvx2<CompareOp::Greater>(a, aStep, b, bStep,
+                                                           out, n);
+                case CompareOp::GreaterEqual:
+                    return compareAvx2<CompareOp::GreaterEqual>(a, aStep, b,
+                                                                bStep, out, n);
+                case CompareOp::Equal:
+                    return compareAvx2<CompareOp::Equal>(a, aStep, b, bStep,
+                                                         out, n);
+            }
+        }
+    }
+#endif
+    switch (op) {
+        case CompareOp::Less:
+            return compareScalar<CompareOp::Less>(a, aStep, b, bStep, out, n);
+        case CompareOp::LessEqual:
+            return compareScalar<CompareOp::LessEqual>(a, aStep, b, bStep, out,
+                                                       n);
+        case CompareOp::Greater:
+            return compareScalar<CompareOp::Greater>(a, aStep, b, bStep, out,
+                                                     n);
+        case CompareOp::GreaterEqual:
+            return compareScalar<CompareOp::GreaterEqual>(a, aStep, b, bStep,
+                                                          out, n);
+        case CompareOp::Equal:
+            return compareScalar<CompareOp::Equal>(a, aStep, b, bStep, out, n);
+    }
+}
+
+}  // namespace
+
+const char* simdLevel() {
+    return useAvx2() ? "avx2" : "scalar";
+}
+
+void arithmetic(ArithmeticOp op, const double* a, std::size_t aStep,
+                const double* b, std::size_t bStep, double* out,
+                std::size_t n) {
+    dispatchArithmetic(op, a, aStep, b, bStep, out, n);
+}
+
+void arithmetic(ArithmeticOp op, const std::int64_t* a, std::size_t aStep,
+                const std::int64_t* b, std::size_t bStep, std::int64_t* out,
+                std::size_t n) {
+    dispatchArithmetic(op, a, aStep, b, bStep, out, n);
+}
+
+void arithmetic(ArithmeticOp op, const std::uint8_t* a, std::size_t aStep,
+                const std::uint8_t* b, std::size_t bStep, std::uint8_t* out,
+                std::size_t n) {
+    dispatchArithmetic(op, a, aStep, b, bStep, out, n);
+}
+
+void compare(CompareOp op, const double* a, std::size_t aStep,
+             const double* b, std::size_t bStep, std::uint8_t* out,
+             std::size_t n) {
+    dispatchCompare(op, a, aStep, b, bStep, out, n);
+}
+
+void compare(CompareOp op, const std::int64_t* a, std::size_t aStep,
+             const std::int64_t* b, std::size_t bStep, std::uint8_t* out,
+             std::size_t n) {
+    dispatchCompare(op, a, aStep, b, bStep, out, n);
+}
+
+void compare(CompareOp op, const std::uint8_t* a, std::size_t aStep,
+             const std::uint8_t* b, std::size_t bStep, std::uint8_t* out,
+             std::size_t n) {
+    dispatchCompare(op, a, aStep, b, bStep, out, n);
+}
+
+double sum(const double* a, std::size_t n) {
+#ifdef MINI_LISP_X86
+    if (useAvx2()) return sumAvx2(a, n);
+#endif
+    return sumScalar<double>(a, n);
+}
+
+std::int64_t sum(const std::int64_t* a, std::size_t n) {
+#ifdef MINI_LISP_X86
+    if (useAvx2()) return sumAvx2(a, n);
+#endif
+    return sumScalar<std::int64_t>(a, n);
+}
+
+std::uint64_t sum(const std::uint8_t* a, std::size_t n) {
+#ifdef MINI_LISP_X86
+    if (useAvx2()) return sumAvx2(a, n);
+#endif
+    return sumScalar<std::uint64_t>(a, n);
+}
+
+double dot(const double* a, const double* b, std::size_t n) {
+#ifdef MINI_LISP_X86
+    if (useAvx2()) return dotAvx2(a, b, n);
+#endif
+    return dotScalar<double>(a, b, n);
+}
+
+// AVX2 没有 64 位整数乘法指令，整数点积使用标量循环
+std::int64_t dot(const std::int64_t* a, const std::int64_t* b,
+                 std::size_t n) {
+    return dotScalar<std::int64_t>(a, b, n);
+}
+
+std::uint64_t dot(const std::uint8_t* a, const std::uint8_t* b,
+                  std::size_t n) {
+    return dotScalar<std::uint64_t>(a, b, n);
+}
+
+void axpy(double alpha, const double* x, double* y, std::size_t n) {
+#ifdef MINI_LISP_X86
+    if (useAvx2()) return axpyAvx2(alpha, x, y, n);
+#endif
+    for (std::size_t i = 0; i < n; i++) y[i] += alpha * x[i];
+}
+
+double minElement(const double* a, std::size_t n) {
+#ifdef MINI_LISP_X86
+    if (useAvx2()) return extremeAvx2<false>(a, n);
+#endif
+    return minScalar(a, n);
+}
+
+std::int64_t minElement(const std::int64_t* a, std::size_t n) {
+    return minScalar(a, n);
+}
+
+std::uint8_t minElement(const std::uint8_t* a, std::size_t n) {
+#ifdef MINI_LISP_X86
+    if (useAvx2()) return extremeAvx2<false>(a, n);
+#endif
+    return minScalar(a, n);
+}
+
+double maxElement(const double* a, std::size_t n) {
+#ifdef MINI_LISP_X86
+    if (useAvx2()) return extremeAvx2<true>(a, n);
+#endif
+    return maxScalar(a, n);
+}
+
+std::int64_t maxElement(const std::int64_t* a, std::size_t n) {
+    return maxScalar(a, n);
+}
+
+std::uint8_t maxElement(const std::uint8_t* a, std::size_t n) {
+#ifdef MINI_LISP_X86
+    if (useAvx2()) return extremeAvx2<true>(a, n);
+#endif
+    return maxScalar(a, n);
+}
@@ -0,0 +1,58 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 类型化数组的逐元素运算内核。x86 上运行时检测到 AVX2 时使用向量指令，
+// 否则（包括非 x86 平台）退回普通循环，由编译器按基线指令集自动向量化。
+// 浮点归约（sum/dot）在两条路径上的累加顺序不同，结果可能有舍入误差
+enum class ArithmeticOp { Add, Subtract, Multiply, Divide };
+enum class CompareOp { Less, LessEqual, Greater, GreaterEqual, Equal };
+
+// 当前使用的内核："avx2" 或 "scalar"
+const char* simdLevel();
+
+// out[i] = a[i] op b[i]。aStep/bStep 为 0 时对应操作数是广播的标量，为 1
+// 时是数组。整数运算按补码回绕；整数除法的除数由调用者保证非零
+void arithmetic(ArithmeticOp op, const double* a, std::size_t aStep,
+                const double* b, std::size_t bStep, double* out,
+                std::size_t n);
+void arithmetic(ArithmeticOp op, const std::int64_t* a, std::size_t aStep,
+                const std::int64_t* b, std::size_t bStep, std::int64_t* out,
+                std::size_t n);
+void arithmetic(ArithmeticOp op, const std::uint8_t* a, std::size_t aStep,
+                const std::uint8_t* b, std::size_t bStep, std::uint8_t* out,
+                std::size_t n);
+
+// out[i] = (a[i] op b[i]) ? 1 : 0，步长含义同上
+void compare(CompareOp op, const double* a, std::size_t aStep,
+             const double* b, std::size_t bStep, std::uint8_t* out,
+             std::size_t n);
+void compare(CompareOp op, const std::int64_t* a, std::size_t aStep,
+             const std::int64_t* b, std::size_t bStep, std::uint8_t* out,
+             std::size_t n);
+void compare(CompareOp op, const std::uint8_t* a, std::size_t aStep,
+             const std::uint8_t* b, std::size_t bStep, std::uint8_t* out,
+             std::size_t n);
+
+// 归约。整数求和按补码回绕；min/max 要求 n > 0
+double sum(const double* a, std::size_t n);
+std::int64_t sum(const std::int64_t* a, std::size_t n);
+std::uint64_t sum(const std::uint8_t* a, std::size_t n);
+
+double dot(const double* a, const double* b, std::size_t n);
+std::int64_t dot(const std::int64_t* a, const std::int64_t* b, std::size_t n);
+std::uint64_t dot(const std::uint8_t* a, const std::uint8_t* b, std::size_t n);
+
+// y[i] += alpha * x[i]，矩阵乘法的内层循环
+void axpy(double alpha, const double* x, double* y, std::size_t n);
+
+double minElement(const double* a, std::size_t n);
+std::int64_t minElement(const std::int64_t* a, std::size_t n);
+std::uint8_t minElement(const std::uint8_t* a, std::size_t n);
+double maxElement(const double* a, std::size_t n);
+std::int64_t maxElement(const std::int64_t* a, std::size_t n);
+std::uint8_t maxElement(const std::uint8_t* a, std::size_t n);
+
+#endif  // SIMD_H
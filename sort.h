@@ -0,0 +1,135 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 稳定的归并排序：先对短段做插入排序，再自底向上两两归并。
+// 比较函数即使不满足严格弱序（如 Lisp 过程）也不会越界；
+// 比较函数抛出异常时 data 中的内容未定义，调用者应在副本上排序
+
+namespace sort_detail {
+
+constexpr std::size_t INSERTION_RUN = 16;
+// 元素数超过该值且有多个硬件线程时，分段并行排序
+constexpr std::size_t PARALLEL_THRESHOLD = std::size_t(1) << 16;
+// 并行排序最多使用的线程数，更多线程时归并层数增加而收益有限
+constexpr std::size_t MAX_THREADS = 8;
+
+template <typename T, typename Less>
+void insertionSort(T* data, std::size_t n, Less& less) {
+    for (std::size_t i = 1; i < n; i++) {
+        T item = std::move(data[i]);
+        std::size_t j = i;
+        while (j > 0 && less(item, data[j - 1])) {
+            data[j] = std::move(data[j - 1]);
+            j--;
+        }
+        data[j] = std::move(item);
+    }
+}
+
+// 把 [left, mid) 与 [mid, right) 归并到 out；相等时先取左边，保证稳定
+template <typename T, typename Less>
+void mergeRuns(T* left, T* mid, T* right, T* out, Less& less) {
+    T* a = left;
+    T* b = mid;
+    while (a != mid && b != right) {
+        if (less(*b, *a)) {
+            *out++ = std::move(*b++);
+        } else {
+            *out++ = std::move(*a++);
+        }
+    }
+    out = std::move(a, mid, out);
+    std::move(b, right, out);
+}
+
+// 对已按 run 长度分段有序的 data 逐层归并，buffer 至少有 n 个元素
+template <typename T, typename Less>
+void mergeLevels(T* data, T* buffer, std::size_t n, std::size_t run,
+                 Less& less) {
+    T* from = data;
+    T* to = buffer;
+    for (std::size_t width = run; width < n; width *= 2) {
+        for (std::size_t begin = 0; begin < n; begin += 2 * width) {
+            std::size_t mid = std::min(begin + width, n);
+            std::size_t end = std::min(begin + 2 * width, n);
+            mergeRuns(from + begin, from + mid, from + end, to + begin, less);
+        }
+        std::swap(from, to);
+    }
+    if (from != data) std::move(from, from + n, data);
+}
+
+template <typename T, typename Less>
+void sortRange(T* data, T* buffer, std::size_t n, Less& less) {
+    for (std::size_t begin = 0; begin < n; begin += INSERTION_RUN) {
+        insertionSort(data + begin, std::min(INSERTION_RUN, n - begin), less);
+    }
+    mergeLevels(data, buffer, n, INSERTION_RUN, less);
+}
+
+}  // namespace sort_detail
+
+template <typename T, typename Less>
+void mergeSort(std::vector<T>& items, Less less) {
+    std::vector<T> buffer(items.size());
+    sort_detail::sortRange(items.data(), buffer.data(), items.size(), less);
+}
+
+// 并行版本：各线程先排好一段，再逐层归并。比较函数会被多个线程同时调用，
+// 只能用于不涉及解释器状态的原生比较（如数值键）
+template <typename T, typename Less>
+void parallelMergeSort(std::vector<T>& items, Less less) {
+    using namespace sort_detail;
+    std::size_t n = items.size();
+    std::size_t threads =
+        std::min<std::size_t>(std::thread::hardware_concurrency(), MAX_THREADS);
+    if (n < PARALLEL_THRESHOLD || threads <= 1) {
+        mergeSort(items, less);
+        return;
+    }
+
+    std::vector<T> buffer(n);
+    T* data = items.data();
+    std::size_t chunk = (n + threads - 1) / threads;
+    // 无法再创建线程时，其余各段在当前线程中完成
+    auto forEachSegment = [&](std::size_t width, auto work) {
+        // 预留空间后 emplace_back 不会再因分配失败而在已有线程运行时抛出
+        std::vector<std::thread> workers;
+        workers.reserve((n + width - 1) / width);
+        for (std::size_t begin = 0; begin < n; begin += width) {
+            std::size_t end = std::min(begin + width, n);
+            try {
+                workers.emplace_back(work, begin, end);
+            } catch (const std::system_error&) {
+                work(begin, end);
+            }
+        }
+        for (auto& worker : workers) worker.join();
+    };
+
+    forEachSegment(chunk, [&](std::size_t begin, std::size_t end) {
+        Less local = less;
+        sortRange(data + begin, buffer.data() + begin, end - begin, local);
+    });
+    // 每层把相邻两段归并到另一块缓冲区，各对之间互不重叠
+    T* from = data;
+    T* to = buffer.data();
+    for (std::size_t width = chunk; width < n; width *= 2) {
+        forEachSegment(2 * width, [&](std::size_t begin, std::size_t end) {
+            Less local = less;
+            std::size_t mid = std::min(begin + width, end);
+            mergeRuns(from + begin, from + mid, from + end, to + begin, local);
+        });
+        std::swap(from, to);
+    }
+    if (from != data) std::move(from, from + n, data);
+}
+
+#endif  // SORT_H
@@ -0,0 +1,105 @@
+#include "strsearch.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+using Index = std::ptrdiff_t;
+
+// 按字节序（reversed 时为逆序）求 x 的最大后缀，返回其起点减一，
+// 并通过 period 返回该后缀的周期
+Index maximalSuffix(const unsigned char* x, Index m, bool reversed,
+                    Index& period) {
+    Index start = -1;
+    Index j = 0;
+    Index k = 1;
+    period = 1;
+    while (j + k < m) {
+        unsigned char a = x[j + k];
+        unsigned char b = x[start + k];
+        if (reversed ? a > b : a < b) {
+            j += k;
+            k = 1;
+            period = j - start;
+        } else if (a == b) {
+            if (k != period) {
+                k++;
+            } else {
+                j += period;
+                k = 1;
+            }
+        } else {
+            start = j++;
+            k = period = 1;
+        }
+    }
+    return start;
+}
+
+Index twoWay(const unsigned char* y, Index n, const unsigned char* x,
+             Index m) {
+    // 临界分解：needle = x[0..ell] + x[ell+1..m)
+    Index p;
+    Index q;
+    Index i = maximalSuffix(x, m, false, p);
+    Index j = maximalSuffix(x, m, true, q);
+    Index ell = i > j ? i : j;
+    Index period = i > j ? p : q;
+
+    if (std::memcmp(x, x + period, ell + 1) == 0) {
+        // 模式是周期的：匹配失败后记住已比较过的前缀，避免重复比较
+        Index memory = -1;
+        for (Index pos = 0; pos <= n - m;) {
+            Index k = std::max(ell, memory) + 1;
+            while (k < m && x[k] == y[pos + k]) k++;
+            if (k < m) {
+                pos += k - ell;
+                memory = -1;
+                continue;
+            }
+            k = ell;
+            while (k > memory && x[k] == y[pos + k]) k--;
+            if (k <= memory) return pos;
+            pos += period;
+            memory = m - period - 1;
+        }
+        return -1;
+    }
+
+    period = std::max(ell + 1, m - ell - 1) + 1;
+    for (Index pos = 0; pos <= n - m;) {
+        Index k = ell + 1;
+        while (k < m && x[k] == y[pos + k]) k++;
+        if (k < m) {
+            pos += k - ell;
+            continue;
+        }
+        k = ell;
+        while (k >= 0 && x[k] == y[pos + k]) k--;
+        if (k < 0) return pos;
+        pos += period;
+    }
+    return -1;
+}
+
+}  // namespace
+
+std::size_t findSubstring(std::string_view haystack, std::string_view needle,
+                          std::size_t from) {
+    if (from > haystack.size()) return std::string_view::npos;
+    if (needle.empty()) return from;
+    const char* base = haystack.data() + from;
+    std::size_t n = haystack.size() - from;
+    if (needle.size() > n) return std::string_view::npos;
+
+    if (needle.size() == 1) {
+        auto found = static_cast<const char*>(std::memchr(base, needle[0], n));
+        return found ? found - haystack.data() : std::string_view::npos;
+    }
+    Index pos = twoWay(reinterpret_cast<const unsigned char*>(base),
+                       static_cast<Index>(n),
+                       reinterpret_cast<const unsigned char*>(needle.data()),
+                       static_cast<Index>(needle.size()));
+    return pos < 0 ? std::string_view::npos : from + pos;
+}
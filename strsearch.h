@@ -0,0 +1,14 @@
+#ifndef STRSEARCH_H
+#define STRSEARCH_H
+
+#include <cstddef>
+#include <string_view>
+
+// 在 haystack 中从 from 开始查找 needle 第一次出现的位置，找不到时返回
+// std::string_view::npos。单字节模式交给 memchr（标准库实现已向量化）；
+// 更长的模式使用 Crochemore-Perrin 双向匹配算法：最坏 O(n + m) 时间、
+// O(1) 额外空间，不会像朴素查找那样在重复模式上退化为 O(nm)
+std::size_t findSubstring(std::string_view haystack, std::string_view needle,
+                          std::size_t from = 0);
+
+#endif  // STRSEARCH_H
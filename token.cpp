@@ -54,6 +54,17 @@ TokenPtr Token::dot() {
     return std::make_unique<DotToken>();
 }
 
+TokenPtr Token::vectorParen() {
+    class VectorParenToken : public Token {
+    public:
+        VectorParenToken() : Token(TokenType::VECTOR_PAREN) {}
+        std::string toString() const override {
+            return "#(";
+        }
+    };
+    return std::make_unique<VectorParenToken>();
+}
+
 std::string Token::toString() const {
     switch (type) {
         case TokenType::LEFT_PAREN: return "(LEFT_PAREN)"; break;
@@ -62,6 +73,7 @@ std::string Token::toString() const {
         case TokenType::QUASIQUOTE: return "(QUASIQUOTE)"; break;
         case TokenType::UNQUOTE: return "(UNQUOTE)"; break;
         case TokenType::DOT: return "(DOT)"; break;
+        case TokenType::VECTOR_PAREN: return "(VECTOR_PAREN)"; break;
         default: return "(UNKNOWN)";
     }
 }
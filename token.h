@@ -13,6 +13,7 @@ enum class TokenType {
     QUASIQUOTE,
     UNQUOTE,
     DOT,
+    VECTOR_PAREN,  // #(
     BOOLEAN_LITERAL,
     NUMERIC_LITERAL,
     STRING_LITERAL,
@@ -34,6 +35,7 @@ public:
 
     static TokenPtr fromChar(char c);
     static TokenPtr dot();
+    static TokenPtr vectorParen();
 
     TokenType getType() const {
         return type;
@@ -8,7 +8,7 @@
 
 const std::set<char> TOKEN_END{'(', ')', '\'', '`', ',', '"'};
 
-TokenPtr Tokenizer::nextToken(int& pos) {
+TokenPtr Tokenizer::nextToken(std::size_t& pos) {
     while (pos < input.size()) {
         auto c = input[pos];
         if (c == ';') {
@@ -21,6 +21,10 @@ TokenPtr Tokenizer::nextToken(int& pos) {
             pos++;
             return token;
         } else if (c == '#') {
+            if (pos + 1 < input.size() && input[pos + 1] == '(') {
+                pos += 2;
+                return Token::vectorParen();
+            }
             if (auto result = BooleanLiteralToken::fromChar(input[pos + 1])) {
                 pos += 2;
                 return result;
@@ -52,7 +56,7 @@ TokenPtr Tokenizer::nextToken(int& pos) {
             }
             throw SyntaxError("Unexpected end of string literal");
         } else {
-            int start = pos;
+            std::size_t start = pos;
             do {
                 pos++;
             } while (pos < input.size() && !std::isspace(input[pos]) &&
@@ -75,7 +79,7 @@ TokenPtr Tokenizer::nextToken(int& pos) {
 
 std::deque<TokenPtr> Tokenizer::tokenize() {
     std::deque<TokenPtr> tokens;
-    int pos = 0;
+    std::size_t pos = 0;
     while (true) {
         auto token = nextToken(pos);
         if (!token) {
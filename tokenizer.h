@@ -8,7 +8,7 @@
 
 class Tokenizer {
 private:
-    TokenPtr nextToken(int& pos);
+    TokenPtr nextToken(std::size_t& pos);
     std::deque<TokenPtr> tokenize();
 
     std::string input;
@@ -1,10 +1,12 @@
 #include "value.h"
 
 #include <cmath>
-#include <iomanip>
-#include <sstream>
+#include <mutex>
+#include <set>
+#include <unordered_set>
 
 #include "eval_env.h"
+#include "printer.h"
 
 Value::operator std::vector<ValuePtr>() const {
     if (this->isList()) {
@@ -22,6 +24,439 @@ bool Value::isSymbol() const {
     return false;
 }
 
+// ===== 延迟回收 =====
+namespace {
+
+// 必须保持平凡析构：线程退出后仍可能有对象被释放（见 ReclaimGuard）
+struct ReclaimQueue {
+    std::vector<Value*>* pending;
+    std::size_t budget;
+    bool draining;  // 正在析构队列中的对象，新归零的对象只入队
+    bool retired;   // 线程已退出，之后直接析构
+};
+
+thread_local ReclaimQueue reclaimQueue{nullptr, 0, false, false};
+
+// 线程退出时回收剩余对象并释放队列本身
+struct ReclaimGuard {
+    ~ReclaimGuard() {
+        Value::drainReclaim();
+        delete reclaimQueue.pending;
+        reclaimQueue.pending = nullptr;
+        reclaimQueue.retired = true;
+    }
+};
+
+ReclaimQueue& threadReclaimQueue() {
+    static thread_local ReclaimGuard guard;
+    if (!reclaimQueue.pending && !reclaimQueue.retired) {
+        reclaimQueue.pending = new std::vector<Value*>();
+    }
+    return reclaimQueue;
+}
+
+}  // namespace
+
+void Value::reclaim(Value* value) noexcept {
+    ReclaimQueue& queue = threadReclaimQueue();
+    if (queue.retired) {
+        value->deleter_(value);
+        return;
+    }
+    queue.pending->push_back(value);
+    if (!queue.draining) {
+        drainReclaim(queue.budget ? queue.budget
+                                  : static_cast<std::size_t>(-1));
+    }
+}
+
+void Value::setReclaimBudget(std::size_t budget) noexcept {
+    threadReclaimQueue().budget = budget;
+}
+
+std::size_t Value::drainReclaim(std::size_t budget) noexcept {
+    ReclaimQueue& queue = threadReclaimQueue();
+    if (!queue.pending) return 0;
+    if (queue.draining) return queue.pending->size();
+
+    queue.draining = true;
+    for (std::size_t done = 0; done < budget && !queue.pending->empty();
+         done++) {
+        Value* value = queue.pending->back();
+        queue.pending->pop_back();
+        value->deleter_(value);
+    }
+    queue.draining = false;
+    return queue.pending->size();
+}
+
+// ===== 常量池 =====
+namespace {
+
+// 在对象池中创建并额外持有一次引用，保证计数永不归零
+template <typename T, typename... Args>
+ValuePtr makeImmortal(Args&&... args) {
+    ValuePtr value = makePooledValue<T>(std::forward<Args>(args)...);
+    value->retain();
+    return value;
+}
+
+}  // namespace
+
+const ValuePtr& makeNil() {
+    static const ValuePtr nil = makeImmortal<NilValue>();
+    return nil;
+}
+
+const ValuePtr& makeBoolean(bool value) {
+    static const ValuePtr trueValue = makeImmortal<BooleanValue>(true);
+    static const ValuePtr falseValue = makeImmortal<BooleanValue>(false);
+    return value ? trueValue : falseValue;
+}
+
+ValuePtr makeNumber(double value) {
+    static const std::vector<ValuePtr> smallInts = [] {
+        std::vector<ValuePtr> values;
+        for (int i = SMALL_INT_MIN; i <= SMALL_INT_MAX; i++) {
+            values.push_back(makeImmortal<NumericValue>(i));
+        }
+        return values;
+    }();
+    // -0.0 与 0 打印相同但作除数时结果不同，不能共享
+    if (value >= SMALL_INT_MIN && value <= SMALL_INT_MAX &&
+        value == std::floor(value) && !(value == 0 && std::signbit(value))) {
+        return smallInts[static_cast<int>(value) - SMALL_INT_MIN];
+    }
+    return makeValue<NumericValue>(value);
+}
+
+// ===== 结构相等与哈希 =====
+namespace {
+
+constexpr std::size_t NIL_HASH = 0x6e696c;
+
+std::size_t combineHash(std::size_t element, std::size_t rest) {
+    return rest ^ (element + 0x9e3779b97f4a7c15ULL + (rest << 6) + (rest >> 2));
+}
+
+std::size_t numberHash(double value) {
+    // 0 与 -0.0 在 equal? 下相等
+    return std::hash<double>()(value == 0 ? 0.0 : value);
+}
+
+const HashCache* hashCacheOf(const Value* value) {
+    const auto& type = typeid(*value);
+    if (type == typeid(PairValue)) {
+        return &static_cast<const PairValue*>(value)->hashCache();
+    }
+    if (type == typeid(CompactListValue)) {
+        return &static_cast<const CompactListValue*>(value)->hashCache();
+    }
+    if (type == typeid(StringValue)) {
+        return &static_cast<const StringValue*>(value)->hashCache();
+    }
+    return nullptr;
+}
+
+// 持久化结构的 contentHash 会再调用 equalHash，嵌套超过这个层数的
+// 子结构只计入固定值，保证经由它们形成的环也能结束
+constexpr int MAX_HASH_NESTING = 64;
+thread_local int hashNesting = 0;
+// 正在计算哈希的向量，包括外层 equalHash 中的。再次遇到说明有环
+thread_local std::unordered_set<const VectorValue*> openVectors;
+
+// 列表、向量以外的值的哈希。stable 为假表示值的内容可变（或含有可变的
+// 值），包含它的列表节点不能缓存哈希
+std::size_t leafHash(const Value* value, bool& stable) {
+    if (auto array = dynamic_cast<const TypedArrayBase*>(value)) {
+        stable = false;
+        return array->contentHash();
+    }
+    if (auto matrix = dynamic_cast<const MatrixValue*>(value)) {
+        stable = false;
+        return matrix->contentHash();
+    }
+    const auto& type = typeid(*value);
+    if (type == typeid(PersistentMapValue) ||
+        type == typeid(PersistentVectorValue)) {
+        stable = false;
+        if (hashNesting >= MAX_HASH_NESTING) return 0x706572;
+        hashNesting++;
+        std::size_t hash =
+            type == typeid(PersistentMapValue)
+                ? static_cast<const PersistentMapValue*>(value)->contentHash()
+                : static_cast<const PersistentVectorValue*>(value)
+                      ->contentHash();
+        hashNesting--;
+        return hash;
+    }
+    if (value->isNil()) return NIL_HASH;
+    if (value->isNumber()) return numberHash(value->asNumber());
+    if (value->isBoolean()) return value->getValue() ? 0x7423 : 0x6623;
+    if (value->isString()) {
+        const HashCache& cache =
+            static_cast<const StringValue*>(value)->hashCache();
+        std::size_t hash = cache.get();
+        if (!hash) {
+            hash = std::hash<std::string_view>()(
+                static_cast<const StringValue*>(value)->view());
+            cache.set(hash);
+        }
+        return hash;
+    }
+    if (value->isSymbol()) {
+        // 同名符号编号相同，按编号哈希不必每次扫描名字
+        return std::hash<std::size_t>()(
+                   static_cast<const SymbolValue*>(value)->getId()) ^
+               0x73796d;
+    }
+    // 其余类型按对象身份比较
+    return std::hash<const Value*>()(value);
+}
+
+// equal? 的哈希。列表和向量的嵌套用显式栈展开，深度不受调用栈限制。
+// 列表的哈希按元素从后向前折叠，与列表的具体表示无关，并缓存在各节点中；
+// 向量可变，哈希不缓存，经由向量形成的环只计入固定值
+class StructureHasher {
+public:
+    std::size_t run(const Value* root) {
+        bool stable = true;
+        if (auto hash = visit(root, stable)) return *hash;
+        std::size_t hash = 0;
+        while (!stack_.empty()) {
+            Frame& frame = stack_.back();
+            if (const Value* child = nextChild(frame)) {
+                bool childStable = true;
+                // visit 可能压入新帧，frame 引用随之失效，结果稍后再取
+                if (auto childHash = visit(child, childStable)) {
+                    accept(*childHash, childStable);
+                }
+                continue;
+            }
+            hash = frame.hash;
+            stable = frame.stable;
+            if (frame.vector) openVectors.erase(frame.vector);
+            stack_.pop_back();
+            if (!stack_.empty()) accept(hash, stable);
+        }
+        return hash;
+    }
+
+private:
+    struct Frame {
+        const VectorValue* vector = nullptr;  // 向量帧；列表帧为空
+        // 列表：沿 cdr 收集的、尚未缓存哈希的节点，从后向前处理
+        std::vector<const Value*> nodes;
+        const Value* node = nullptr;  // 列表：正在计入元素的节点
+        const Value* tail = nullptr;  // 列表：需要先算出哈希的结尾
+        bool replace = false;  // 下一个结果是结尾的哈希，作为折叠的初值
+        size_t item = 0;  // 列表：当前节点剩余的元素数；向量：已计入的元素数
+        std::size_t hash = 0;
+        bool stable = true;
+    };
+
+    // 叶子直接返回哈希；列表和向量入栈，哈希在出栈时得出
+    std::optional<std::size_t> visit(const Value* value, bool& stable) {
+        if (value->isPair()) return pushList(value);
+        if (typeid(*value) == typeid(VectorValue)) {
+            auto vector = static_cast<const VectorValue*>(value);
+            stable = false;
+            if (!openVectors.insert(vector).second) return 0x766563;
+            Frame& frame = stack_.emplace_back();
+            frame.vector = vector;
+            frame.hash = vector->size();
+            frame.stable = false;
+            return std::nullopt;
+        }
+        return leafHash(value, stable);
+    }
+
+    std::optional<std::size_t> pushList(const Value* list) {
+        Frame frame;
+        const Value* current = list;
+        while (true) {
+            if (!current->isPair()) {
+                bool stable = true;
+                if (current->isNil()) {
+                    frame.hash = NIL_HASH;
+                } else if (typeid(*current) == typeid(VectorValue)) {
+                    frame.tail = current;
+                    frame.replace = true;
+                } else {
+                    frame.hash = leafHash(current, stable);
+                    frame.stable = stable;
+                }
+                break;
+            }
+            if (const HashCache* cache = hashCacheOf(current)) {
+                if (std::size_t cached = cache->get()) {
+                    frame.hash = cached;
+                    break;
+                }
+            }
+            const auto& type = typeid(*current);
+            if (type == typeid(RangeValue)) {
+                auto range = static_cast<const RangeValue*>(current);
+                frame.hash = NIL_HASH;
+                for (size_t i = range->size(); i-- > 0;) {
+                    frame.hash =
+                        combineHash(numberHash(range->at(i)), frame.hash);
+                }
+                break;
+            }
+            frame.nodes.push_back(current);
+            current = type == typeid(CompactListValue)
+                          ? static_cast<const CompactListValue*>(current)
+                                ->getTail()
+                                .get()
+                          : current->getCdr().get();
+        }
+        if (frame.nodes.empty() && !frame.tail) return frame.hash;
+        stack_.push_back(std::move(frame));
+        return std::nullopt;
+    }
+
+    // 帧中下一个要计入的子值，全部计入后返回 nullptr
+    const Value* nextChild(Frame& frame) {
+        if (frame.vector) {
+            if (frame.item == frame.vector->size()) return nullptr;
+            return frame.vector->at(frame.item++).get();
+        }
+        if (frame.tail) return std::exchange(frame.tail, nullptr);
+        while (true) {
+            if (frame.node) {
+                if (frame.item > 0) {
+                    frame.item--;
+                    if (typeid(*frame.node) == typeid(CompactListValue)) {
+                        auto compact =
+                            static_cast<const CompactListValue*>(frame.node);
+                        return compact->begin()[frame.item].get();
+                    }
+                    return frame.node->getCar().get();
+                }
+                // 节点表示的后缀已全部计入
+                if (frame.stable) hashCacheOf(frame.node)->set(frame.hash);
+                frame.node = nullptr;
+            }
+            if (frame.nodes.empty()) return nullptr;
+            frame.node = frame.nodes.back();
+            frame.nodes.pop_back();
+            frame.item =
+                typeid(*frame.node) == typeid(CompactListValue)
+                    ? static_cast<const CompactListValue*>(frame.node)->size()
+                    : 1;
+        }
+    }
+
+    // 把子值的哈希计入栈顶的帧
+    void accept(std::size_t hash, bool stable) {
+        Frame& frame = stack_.back();
+        frame.stable = frame.stable && stable;
+        frame.hash = std::exchange(frame.replace, false)
+                         ? hash
+                         : combineHash(hash, frame.hash);
+    }
+
+    std::vector<Frame> stack_;
+};
+
+std::size_t hashOf(const Value* value) {
+    return StructureHasher().run(value);
+}
+
+// 两个哈希都已缓存且不同时，两个值必然不相等
+bool cachedHashesDiffer(const Value* a, const Value* b) {
+    const HashCache* cacheA = hashCacheOf(a);
+    const HashCache* cacheB = hashCacheOf(b);
+    if (!cacheA || !cacheB) return false;
+    std::size_t hashA = cacheA->get();
+    std::size_t hashB = cacheB->get();
+    return hashA && hashB && hashA != hashB;
+}
+
+// 序对和向量需要逐个比较其中的元素
+bool isCompound(const Value* value) {
+    return value->isPair() || typeid(*value) == typeid(VectorValue);
+}
+
+// 比较两个非序对、非向量的值
+bool atomsEqual(const Value* a, const Value* b) {
+    if (a == b) return true;
+    if (a->isNumber()) return b->isNumber() && a->asNumber() == b->asNumber();
+    if (a->isString()) {
+        return b->isString() && !cachedHashesDiffer(a, b) &&
+               static_cast<const StringValue*>(a)->view() ==
+                   static_cast<const StringValue*>(b)->view();
+    }
+    if (a->isSymbol()) {
+        return b->isSymbol() &&
+               static_cast<const SymbolValue*>(a)->getId() ==
+                   static_cast<const SymbolValue*>(b)->getId();
+    }
+    if (a->isBoolean()) {
+        return b->isBoolean() && a->getValue() == b->getValue();
+    }
+    if (a->isNil()) return b->isNil();
+    // 其余类型由 operator== 决定，如类型化数组按内容比较
+    return *a == *b;
+}
+
+}  // namespace
+
+bool valuesEqual(const ValuePtr& a, const ValuePtr& b) {
+    // 待比较的序对用显式栈保存：cdr 方向在循环内推进，car 方向入栈
+    std::vector<std::pair<const Value*, const Value*>> pending{
+        {a.get(), b.get()}};
+    // 已经展开过的向量对。向量可以通过 vector-set! 包含自身，
+    // 再次遇到同一对时视为相等，结果由其余元素的比较决定
+    std::set<std::pair<const Value*, const Value*>> expandedVectors;
+    while (!pending.empty()) {
+        auto [x, y] = pending.back();
+        pending.pop_back();
+        if (x == y) continue;
+        if (!isCompound(x) || !isCompound(y)) {
+            if (isCompound(x) || isCompound(y) || !atomsEqual(x, y)) {
+                return false;
+            }
+            continue;
+        }
+        if (typeid(*x) == typeid(VectorValue) ||
+            typeid(*y) == typeid(VectorValue)) {
+            auto vectorX = dynamic_cast<const VectorValue*>(x);
+            auto vectorY = dynamic_cast<const VectorValue*>(y);
+            if (!vectorX || !vectorY || vectorX->size() != vectorY->size()) {
+                return false;
+            }
+            if (!expandedVectors.emplace(x, y).second) continue;
+            for (size_t i = 0; i < vectorX->size(); i++) {
+                pending.emplace_back(vectorX->at(i).get(),
+                                     vectorY->at(i).get());
+            }
+            continue;
+        }
+        if (cachedHashesDiffer(x, y)) return false;
+
+        ListIterator itemX(x, true), itemY(y, true), end;
+        for (; itemX != end && itemY != end; ++itemX, ++itemY) {
+            const Value* carX = itemX->get();
+            const Value* carY = itemY->get();
+            if (isCompound(carX) && isCompound(carY)) {
+                pending.emplace_back(carX, carY);
+            } else if (isCompound(carX) || isCompound(carY) ||
+                       !atomsEqual(carX, carY)) {
+                return false;
+            }
+        }
+        if (itemX != end || itemY != end) return false;
+        if (!atomsEqual(itemX.tail(), itemY.tail())) return false;
+    }
+    return true;
+}
+
+std::size_t equalHash(const ValuePtr& value) {
+    return hashOf(value.get());
+}
+
 // ===== BooleanValue实现 =====
 BooleanValue::BooleanValue(bool value) : value_(value) {}
 
@@ -101,14 +536,8 @@ const std::string& BooleanValue::getString() const {
 NumericValue::NumericValue(double value) : value_(value) {}
 
 std::string NumericValue::toString() const {
-    double intPart;
-    if (std::modf(value_, &intPart) == 0.0) {
-        return std::to_string(static_cast<long>(intPart));
-    }
-
-    std::ostringstream oss;
-    oss << std::setprecision(15) << value_;
-    return oss.str();
+    char buffer[NUMBER_BUFFER_SIZE];
+    return std::string(formatNumber(value_, buffer));
 }
 
 std::string NumericValue::getType() const {
@@ -187,20 +616,61 @@ bool NumericValue::operator==(const Value& other) const {
 }
 
 // ===== StringValue实现 =====
-StringValue::StringValue(std::string value) : value_(std::move(value)) {}
-
-std::string StringValue::toString() const {
-    std::ostringstream oss;
-    oss << '"';
-    for (char c : value_) {
-        switch (c) {
-            case '"': oss << "\\\""; break;
-            case '\\': oss << "\\\\"; break;
-            default: oss << c;
+StringValue::StringValue(std::string value)
+    : buffer_(std::make_shared<const std::string>(std::move(value))),
+      length_(buffer_->size()) {}
+
+StringValue::StringValue(std::shared_ptr<const std::string> buffer,
+                         size_t offset, size_t length)
+    : buffer_(std::move(buffer)), offset_(offset), length_(length) {}
+
+StringValue::StringValue(Ref<StringValue> left, Ref<StringValue> right)
+    : length_(left->length_ + right->length_),
+      left_(std::move(left)),
+      right_(std::move(right)) {}
+
+StringValue::StringValue(const StringValue& other)
+    : Value(other),
+      buffer_(other.buffer_),
+      offset_(other.offset_),
+      length_(other.length_),
+      left_(other.left_),
+      right_(other.right_),
+      hash_(other.hash_) {}
+
+void StringValue::flatten() const {
+    std::string result;
+    result.reserve(length_);
+    // 按从左到右的顺序收集叶子，用显式栈避免深层 rope 递归过深
+    std::vector<const StringValue*> pending{this};
+    while (!pending.empty()) {
+        const StringValue* node = pending.back();
+        pending.pop_back();
+        if (node->buffer_) {
+            result.append(*node->buffer_, node->offset_, node->length_);
+        } else {
+            pending.push_back(node->right_.get());
+            pending.push_back(node->left_.get());
         }
     }
-    oss << '"';
-    return oss.str();
+    buffer_ = std::make_shared<const std::string>(std::move(result));
+    offset_ = 0;
+    left_ = nullptr;
+    right_ = nullptr;
+}
+
+std::string_view StringValue::view() const {
+    if (!buffer_) flatten();
+    return std::string_view(*buffer_).substr(offset_, length_);
+}
+
+Ref<StringValue> StringValue::slice(size_t offset, size_t length) const {
+    view();
+    return makeValue<StringValue>(buffer_, offset_ + offset, length);
+}
+
+std::string StringValue::toString() const {
+    return printToString(*this);
 }
 
 std::string StringValue::getType() const {
@@ -260,11 +730,16 @@ bool StringValue::isProcedure() const {
 }
 
 const std::string& StringValue::getString() const {
-    return value_;
+    // 切片只占缓冲区的一部分时，复制出独立的缓冲区
+    if (!buffer_ || offset_ != 0 || length_ != buffer_->size()) {
+        buffer_ = std::make_shared<const std::string>(view());
+        offset_ = 0;
+    }
+    return *buffer_;
 }
 
 const std::string& StringValue::getStringValue() const {
-    return value_;
+    return getString();
 }
 
 bool StringValue::isTrue() const {
@@ -273,7 +748,7 @@ bool StringValue::isTrue() const {
 
 bool StringValue::operator==(const Value& other) const {
     if (auto str = dynamic_cast<const StringValue*>(&other)) {
-        return value_ == str->value_;
+        return view() == str->view();
     }
     return false;
 }
@@ -354,7 +829,20 @@ const std::string& NilValue::getString() const {
 }
 
 // ===== SymbolValue实现 =====
-SymbolValue::SymbolValue(std::string name) : name_(std::move(name)) {}
+namespace {
+
+// 符号名到编号的全局表，只增不减。符号只在读入代码等少数场合创建
+std::size_t internSymbol(const std::string& name) {
+    static std::mutex mutex;
+    static auto* ids = new std::unordered_map<std::string, std::size_t>();
+    std::lock_guard<std::mutex> lock(mutex);
+    return ids->try_emplace(name, ids->size()).first->second;
+}
+
+}  // namespace
+
+SymbolValue::SymbolValue(std::string name)
+    : name_(std::move(name)), id_(internSymbol(name_)) {}
 
 std::string SymbolValue::toString() const {
     return name_;
@@ -428,6 +916,14 @@ const std::string& SymbolValue::getString() const {
     throw LispError("Symbol is not a string");
 }
 
+const std::string& SymbolValue::getName() const {
+    return name_;
+}
+
+std::size_t SymbolValue::getId() const {
+    return id_;
+}
+
 // ===== PairValue实现 =====
 PairValue::PairValue(ValuePtr car, ValuePtr cdr)
     : car_(std::move(car)), cdr_(std::move(cdr)) {}
@@ -437,36 +933,20 @@ PairValue::PairValue(const std::vector<ValuePtr>& car_list, ValuePtr cdr) {
 
     // 从右向左构建列表
     for (auto it = car_list.rbegin(); it != car_list.rend(); ++it) {
-        current = std::make_shared<PairValue>(*it, current);
+        current = makeValue<PairValue>(*it, current);
     }
     car_ = current;
     cdr_ = cdr;
 }
 
 PairValue::PairValue(ValuePtr car)
-    : car_(std::move(car)), cdr_(std::make_shared<NilValue>()) {}
+    : car_(std::move(car)), cdr_(makeNil()) {}
 
 PairValue::PairValue()
-    : car_(std::make_shared<NilValue>()), cdr_(std::make_shared<NilValue>()) {}
+    : car_(makeNil()), cdr_(makeNil()) {}
 
 std::string PairValue::toString() const {
-    std::ostringstream oss;
-    oss << '(' << car_->toString();
-
-    ValuePtr current = cdr_;
-    while (true) {
-        if (current->isNil()) {
-            oss << ')';
-            break;
-        } else if (auto pair = std::dynamic_pointer_cast<PairValue>(current)) {
-            oss << ' ' << pair->getCar()->toString();
-            current = pair->getCdr();
-        } else {
-            oss << " . " << current->toString() << ')';
-            break;
-        }
-    }
-    return oss.str();
+    return printToString(*this);
 }
 
 std::string PairValue::getType() const {
@@ -507,12 +987,9 @@ std::optional<std::string> PairValue::asSymbol() const {
 
 std::vector<ValuePtr> PairValue::toVector() const {
     std::vector<ValuePtr> result;
-    const Value* current = this;
-    while (const auto* pair = dynamic_cast<const PairValue*>(current)) {
-        result.push_back(pair->car_);
-        current = pair->cdr_.get();
+    for (ListIterator it(this), end; it != end; ++it) {
+        result.push_back(*it);
     }
-    if (!current->isNil()) throw LispError("Malformed list.");
     return result;
 }
 
@@ -544,11 +1021,11 @@ const std::string& PairValue::getString() const {
     throw LispError("Pair is not a string");
 }
 
-ValuePtr PairValue::getCar() const {
+const ValuePtr& PairValue::getCar() const {
     return car_;
 }
 
-ValuePtr PairValue::getCdr() const {
+const ValuePtr& PairValue::getCdr() const {
     return cdr_;
 }
 
@@ -732,9 +1209,1868 @@ ValuePtr LambdaValue::apply(const std::vector<ValuePtr>& args,
     }
 
     // 执行函数体
-    ValuePtr result = std::make_shared<NilValue>();
+    ValuePtr result = makeNil();
     for (auto& expr : body) {  // 使用成员变量 body
         result = env->eval(expr);
     }
     return result;
 }
+
+// ===== TransducerValue实现 =====
+TransducerValue::TransducerValue(std::vector<Stage> stages)
+    : stages_(std::move(stages)) {}
+
+std::string TransducerValue::toString() const {
+    return "#<transducer>";
+}
+
+std::string TransducerValue::getType() const {
+    return "transducer";
+}
+
+bool TransducerValue::isSelfEvaluating() const {
+    return true;
+}
+
+bool TransducerValue::isNil() const {
+    return false;
+}
+
+bool TransducerValue::isBoolean() const {
+    return false;
+}
+
+bool TransducerValue::getValue() const {
+    throw LispError("Transducer value is not a boolean");
+}
+
+bool TransducerValue::isSymbol() const {
+    return false;
+}
+
+bool TransducerValue::isTrue() const {
+    return false;
+}
+
+bool TransducerValue::operator==(const Value& other) const {
+    return false;
+}
+
+std::optional<std::string> TransducerValue::asSymbol() const {
+    return std::nullopt;
+}
+
+std::vector<ValuePtr> TransducerValue::toVector() const {
+    throw std::runtime_error("Transducer cannot be converted to vector");
+}
+
+double TransducerValue::asNumber() const {
+    throw LispError("Transducer is not a number");
+}
+
+bool TransducerValue::isNumber() const {
+    return false;
+}
+
+bool TransducerValue::isList() const {
+    return false;
+}
+
+bool TransducerValue::isPair() const {
+    return false;
+}
+
+bool TransducerValue::isString() const {
+    return false;
+}
+
+bool TransducerValue::isProcedure() const {
+    return false;
+}
+
+const std::string& TransducerValue::getString() const {
+    throw LispError("Transducer is not a string");
+}
+
+const std::vector<TransducerValue::Stage>& TransducerValue::getStages() const {
+    return stages_;
+}
+
+// ===== VectorValue实现 =====
+VectorValue::VectorValue(std::vector<ValuePtr> elements)
+    : elements_(std::move(elements)) {}
+
+std::string VectorValue::toString() const {
+    return printToString(*this);
+}
+
+std::string VectorValue::getType() const {
+    return "vector";
+}
+
+bool VectorValue::isSelfEvaluating() const {
+    return true;
+}
+
+bool VectorValue::isNil() const {
+    return false;
+}
+
+bool VectorValue::isBoolean() const {
+    return false;
+}
+
+bool VectorValue::getValue() const {
+    throw LispError("Vector is not a boolean");
+}
+
+bool VectorValue::isSymbol() const {
+    return false;
+}
+
+bool VectorValue::isTrue() const {
+    return false;
+}
+
+bool VectorValue::operator==(const Value& other) const {
+    return this == &other;
+}
+
+std::optional<std::string> VectorValue::asSymbol() const {
+    return std::nullopt;
+}
+
+std::vector<ValuePtr> VectorValue::toVector() const {
+    throw std::runtime_error("Vector cannot be converted to vector");
+}
+
+double VectorValue::asNumber() const {
+    throw LispError("Vector is not a number");
+}
+
+bool VectorValue::isNumber() const {
+    return false;
+}
+
+bool VectorValue::isList() const {
+    return false;
+}
+
+bool VectorValue::isPair() const {
+    return false;
+}
+
+bool VectorValue::isString() const {
+    return false;
+}
+
+bool VectorValue::isProcedure() const {
+    return false;
+}
+
+const std::string& VectorValue::getString() const {
+    throw LispError("Vector is not a string");
+}
+
+size_t VectorValue::size() const {
+    return elements_.size();
+}
+
+const ValuePtr& VectorValue::at(size_t index) const {
+    return elements_[index];
+}
+
+void VectorValue::set(size_t index, ValuePtr value) {
+    elements_[index] = std::move(value);
+}
+
+const std::vector<ValuePtr>& VectorValue::getElements() const {
+    return elements_;
+}
+
+// ===== TypedArrayValue实现 =====
+template <typename T>
+TypedArrayValue<T>::TypedArrayValue(std::vector<T> elements)
+    : elements_(std::move(elements)) {}
+
+template <typename T>
+std::string TypedArrayValue<T>::toString() const {
+    std::string result = "#";
+    result += elementName();
+    result += '(';
+    char buffer[NUMBER_BUFFER_SIZE];
+    for (size_t i = 0; i < elements_.size(); i++) {
+        if (i > 0) result += ' ';
+        result += formatNumber(numberAt(i), buffer);
+    }
+    return result + ')';
+}
+
+template <typename T>
+std::string TypedArrayValue<T>::getType() const {
+    return std::string(elementName()) + "vector";
+}
+
+template <typename T>
+bool TypedArrayValue<T>::isSelfEvaluating() const {
+    return true;
+}
+
+template <typename T>
+bool TypedArrayValue<T>::isNil() const {
+    return false;
+}
+
+template <typename T>
+bool TypedArrayValue<T>::isBoolean() const {
+    return false;
+}
+
+template <typename T>
+bool TypedArrayValue<T>::getValue() const {
+    throw LispError("Typed array is not a boolean");
+}
+
+template <typename T>
+bool TypedArrayValue<T>::isSymbol() const {
+    return false;
+}
+
+template <typename T>
+bool TypedArrayValue<T>::isTrue() const {
+    return false;
+}
+
+template <typename T>
+bool TypedArrayValue<T>::operator==(const Value& other) const {
+    auto array = dynamic_cast<const TypedArrayValue<T>*>(&other);
+    return array && array->elements_ == elements_;
+}
+
+template <typename T>
+std::optional<std::string> TypedArrayValue<T>::asSymbol() const {
+    return std::nullopt;
+}
+
+template <typename T>
+std::vector<ValuePtr> TypedArrayValue<T>::toVector() const {
+    throw std::runtime_error("Typed array cannot be converted to vector");
+}
+
+template <typename T>
+double TypedArrayValue<T>::asNumber() const {
+    throw LispError("Typed array is not a number");
+}
+
+template <typename T>
+bool TypedArrayValue<T>::isNumber() const {
+    return false;
+}
+
+template <typename T>
+bool TypedArrayValue<T>::isList() const {
+    return false;
+}
+
+template <typename T>
+bool TypedArrayValue<T>::isPair() const {
+    return false;
+}
+
+template <typename T>
+bool TypedArrayValue<T>::isString() const {
+    return false;
+}
+
+template <typename T>
+bool TypedArrayValue<T>::isProcedure() const {
+    return false;
+}
+
+template <typename T>
+const std::string& TypedArrayValue<T>::getString() const {
+    throw LispError("Typed array is not a string");
+}
+
+template <typename T>
+TypedArrayBase::ElementType TypedArrayValue<T>::elementType() const {
+    if constexpr (std::is_same_v<T, double>) return ElementType::F64;
+    if constexpr (std::is_same_v<T, std::int64_t>) return ElementType::S64;
+    if constexpr (std::is_same_v<T, std::uint8_t>) return ElementType::U8;
+}
+
+template <typename T>
+size_t TypedArrayValue<T>::size() const {
+    return elements_.size();
+}
+
+template <typename T>
+double TypedArrayValue<T>::numberAt(size_t index) const {
+    return static_cast<double>(elements_[index]);
+}
+
+template <typename T>
+void TypedArrayValue<T>::setNumber(size_t index, double value) {
+    elements_[index] = fromNumber(value);
+}
+
+template <typename T>
+std::size_t TypedArrayValue<T>::contentHash() const {
+    std::size_t hash = std::hash<std::string>()(elementName());
+    for (T element : elements_) {
+        // 0.0 与 -0.0 相等，哈希也要相同
+        if (element == T{}) element = T{};
+        hash = hash * 31 + std::hash<T>()(element);
+    }
+    return hash;
+}
+
+template <typename T>
+std::vector<T>& TypedArrayValue<T>::getElements() {
+    return elements_;
+}
+
+template <typename T>
+const std::vector<T>& TypedArrayValue<T>::getElements() const {
+    return elements_;
+}
+
+template <typename T>
+const char* TypedArrayValue<T>::elementName() {
+    if constexpr (std::is_same_v<T, double>) return "f64";
+    if constexpr (std::is_same_v<T, std::int64_t>) return "s64";
+    if constexpr (std::is_same_v<T, std::uint8_t>) return "u8";
+}
+
+template <typename T>
+T TypedArrayValue<T>::fromNumber(double value) {
+    if constexpr (std::is_floating_point_v<T>) {
+        return value;
+    } else {
+        // 2^63 可以用 double 精确表示，作为 s64 的开区间上界
+        constexpr double LOWER = std::is_signed_v<T> ? -9223372036854775808.0
+                                                     : 0.0;
+        constexpr double UPPER = std::is_signed_v<T> ? 9223372036854775808.0
+                                                     : 256.0;
+        if (value != std::floor(value) || value < LOWER || value >= UPPER) {
+            throw LispError(NumericValue(value).toString() +
+                            " is not representable as " + elementName());
+        }
+        return static_cast<T>(value);
+    }
+}
+
+template class TypedArrayValue<double>;
+template class TypedArrayValue<std::int64_t>;
+template class TypedArrayValue<std::uint8_t>;
+
+// ===== MatrixValue实现 =====
+MatrixValue::MatrixValue(size_t rows, size_t cols, std::vector<double> data)
+    : rows_(rows), cols_(cols), data_(std::move(data)) {}
+
+std::string MatrixValue::toString() const {
+    std::string result = "#matrix(";
+    char buffer[NUMBER_BUFFER_SIZE];
+    for (size_t i = 0; i < rows_; i++) {
+        if (i > 0) result += ' ';
+        result += '(';
+        for (size_t j = 0; j < cols_; j++) {
+            if (j > 0) result += ' ';
+            result += formatNumber(at(i, j), buffer);
+        }
+        result += ')';
+    }
+    return result + ')';
+}
+
+std::string MatrixValue::getType() const {
+    return "matrix";
+}
+
+bool MatrixValue::isSelfEvaluating() const {
+    return true;
+}
+
+bool MatrixValue::isNil() const {
+    return false;
+}
+
+bool MatrixValue::isBoolean() const {
+    return false;
+}
+
+bool MatrixValue::getValue() const {
+    throw LispError("Matrix is not a boolean");
+}
+
+bool MatrixValue::isSymbol() const {
+    return false;
+}
+
+bool MatrixValue::isTrue() const {
+    return false;
+}
+
+bool MatrixValue::operator==(const Value& other) const {
+    auto matrix = dynamic_cast<const MatrixValue*>(&other);
+    return matrix && matrix->rows_ == rows_ && matrix->cols_ == cols_ &&
+           matrix->data_ == data_;
+}
+
+std::optional<std::string> MatrixValue::asSymbol() const {
+    return std::nullopt;
+}
+
+std::vector<ValuePtr> MatrixValue::toVector() const {
+    throw std::runtime_error("Matrix cannot be converted to vector");
+}
+
+double MatrixValue::asNumber() const {
+    throw LispError("Matrix is not a number");
+}
+
+bool MatrixValue::isNumber() const {
+    return false;
+}
+
+bool MatrixValue::isList() const {
+    return false;
+}
+
+bool MatrixValue::isPair() const {
+    return false;
+}
+
+bool MatrixValue::isString() const {
+    return false;
+}
+
+bool MatrixValue::isProcedure() const {
+    return false;
+}
+
+const std::string& MatrixValue::getString() const {
+    throw LispError("Matrix is not a string");
+}
+
+size_t MatrixValue::rows() const {
+    return rows_;
+}
+
+size_t MatrixValue::cols() const {
+    return cols_;
+}
+
+double MatrixValue::at(size_t row, size_t col) const {
+    return data_[row * cols_ + col];
+}
+
+void MatrixValue::set(size_t row, size_t col, double value) {
+    data_[row * cols_ + col] = value;
+}
+
+std::vector<double>& MatrixValue::getData() {
+    return data_;
+}
+
+const std::vector<double>& MatrixValue::getData() const {
+    return data_;
+}
+
+std::size_t MatrixValue::contentHash() const {
+    std::size_t hash = rows_ * 31 + cols_;
+    for (double element : data_) {
+        hash = hash * 31 + std::hash<double>()(element == 0 ? 0.0 : element);
+    }
+    return hash;
+}
+
+// ===== RecordTypeValue实现 =====
+RecordTypeValue::RecordTypeValue(std::string name,
+                                 std::vector<std::string> fields)
+    : name_(std::move(name)), fields_(std::move(fields)) {}
+
+std::string RecordTypeValue::toString() const {
+    return "#<record-type " + name_ + ">";
+}
+
+std::string RecordTypeValue::getType() const {
+    return "record-type";
+}
+
+bool RecordTypeValue::isSelfEvaluating() const {
+    return true;
+}
+
+bool RecordTypeValue::isNil() const {
+    return false;
+}
+
+bool RecordTypeValue::isBoolean() const {
+    return false;
+}
+
+bool RecordTypeValue::getValue() const {
+    throw LispError("Record type is not a boolean");
+}
+
+bool RecordTypeValue::isSymbol() const {
+    return false;
+}
+
+bool RecordTypeValue::isTrue() const {
+    return false;
+}
+
+bool RecordTypeValue::operator==(const Value& other) const {
+    return this == &other;
+}
+
+std::optional<std::string> RecordTypeValue::asSymbol() const {
+    return std::nullopt;
+}
+
+std::vector<ValuePtr> RecordTypeValue::toVector() const {
+    throw std::runtime_error("Record type cannot be converted to vector");
+}
+
+double RecordTypeValue::asNumber() const {
+    throw LispError("Record type is not a number");
+}
+
+bool RecordTypeValue::isNumber() const {
+    return false;
+}
+
+bool RecordTypeValue::isList() const {
+    return false;
+}
+
+bool RecordTypeValue::isPair() const {
+    return false;
+}
+
+bool RecordTypeValue::isString() const {
+    return false;
+}
+
+bool RecordTypeValue::isProcedure() const {
+    return false;
+}
+
+const std::string& RecordTypeValue::getString() const {
+    throw LispError("Record type is not a string");
+}
+
+const std::string& RecordTypeValue::getName() const {
+    return name_;
+}
+
+const std::vector<std::string>& RecordTypeValue::getFields() const {
+    return fields_;
+}
+
+// ===== RecordValue实现 =====
+static_assert(sizeof(RecordValue) % alignof(ValuePtr) == 0);
+
+RecordValue::RecordValue(Ref<RecordTypeValue> type) : type_(std::move(type)) {}
+
+Ref<RecordValue> RecordValue::make(Ref<RecordTypeValue> type) {
+    size_t count = type->getFields().size();
+    void* memory =
+        ::operator new(sizeof(RecordValue) + count * sizeof(ValuePtr));
+    auto record = new (memory) RecordValue(std::move(type));
+    for (size_t i = 0; i < count; i++) {
+        new (record->slots() + i) ValuePtr(makeNil());
+    }
+    return Ref<RecordValue>(record);
+}
+
+RecordValue::~RecordValue() {
+    for (size_t i = type_->getFields().size(); i-- > 0;) {
+        slots()[i].~ValuePtr();
+    }
+}
+
+void RecordValue::operator delete(void* ptr) {
+    ::operator delete(ptr);
+}
+
+std::string RecordValue::toString() const {
+    return printToString(*this);
+}
+
+std::string RecordValue::getType() const {
+    return type_->getName();
+}
+
+bool RecordValue::isSelfEvaluating() const {
+    return true;
+}
+
+bool RecordValue::isNil() const {
+    return false;
+}
+
+bool RecordValue::isBoolean() const {
+    return false;
+}
+
+bool RecordValue::getValue() const {
+    throw LispError("Record is not a boolean");
+}
+
+bool RecordValue::isSymbol() const {
+    return false;
+}
+
+bool RecordValue::isTrue() const {
+    return false;
+}
+
+bool RecordValue::operator==(const Value& other) const {
+    return this == &other;
+}
+
+std::optional<std::string> RecordValue::asSymbol() const {
+    return std::nullopt;
+}
+
+std::vector<ValuePtr> RecordValue::toVector() const {
+    throw std::runtime_error("Record cannot be converted to vector");
+}
+
+double RecordValue::asNumber() const {
+    throw LispError("Record is not a number");
+}
+
+bool RecordValue::isNumber() const {
+    return false;
+}
+
+bool RecordValue::isList() const {
+    return false;
+}
+
+bool RecordValue::isPair() const {
+    return false;
+}
+
+bool RecordValue::isString() const {
+    return false;
+}
+
+bool RecordValue::isProcedure() const {
+    return false;
+}
+
+const std::string& RecordValue::getString() const {
+    throw LispError("Record is not a string");
+}
+
+// ===== RecordProcValue实现 =====
+RecordProcValue::RecordProcValue(Kind kind, Ref<RecordTypeValue> type,
+                                 std::vector<size_t> slots, std::string name)
+    : kind_(kind),
+      type_(std::move(type)),
+      slots_(std::move(slots)),
+      name_(std::move(name)) {}
+
+std::string RecordProcValue::toString() const {
+    return "#<procedure " + name_ + ">";
+}
+
+std::string RecordProcValue::getType() const {
+    return "procedure";
+}
+
+bool RecordProcValue::isSelfEvaluating() const {
+    return false;
+}
+
+bool RecordProcValue::isNil() const {
+    return false;
+}
+
+bool RecordProcValue::isBoolean() const {
+    return false;
+}
+
+bool RecordProcValue::getValue() const {
+    throw LispError("Procedure is not a boolean");
+}
+
+bool RecordProcValue::isSymbol() const {
+    return false;
+}
+
+bool RecordProcValue::isTrue() const {
+    return false;
+}
+
+bool RecordProcValue::operator==(const Value& other) const {
+    return this == &other;
+}
+
+std::optional<std::string> RecordProcValue::asSymbol() const {
+    return std::nullopt;
+}
+
+std::vector<ValuePtr> RecordProcValue::toVector() const {
+    throw std::runtime_error("Procedure cannot be converted to vector");
+}
+
+double RecordProcValue::asNumber() const {
+    throw LispError("Procedure is not a number");
+}
+
+bool RecordProcValue::isNumber() const {
+    return false;
+}
+
+bool RecordProcValue::isList() const {
+    return false;
+}
+
+bool RecordProcValue::isPair() const {
+    return false;
+}
+
+bool RecordProcValue::isString() const {
+    return false;
+}
+
+bool RecordProcValue::isProcedure() const {
+    return true;
+}
+
+const std::string& RecordProcValue::getString() const {
+    throw LispError("Procedure is not a string");
+}
+
+RecordValue& RecordProcValue::checkRecord(const ValuePtr& value) const {
+    if (typeid(*value) != typeid(RecordValue) ||
+        static_cast<RecordValue&>(*value).getRecordType() != type_.get()) {
+        throw LispError(name_ + ": expected " + type_->getName() + ", got " +
+                        value->toString());
+    }
+    return static_cast<RecordValue&>(*value);
+}
+
+ValuePtr RecordProcValue::apply(const std::vector<ValuePtr>& args) const {
+    size_t expected = kind_ == Kind::Constructor ? slots_.size()
+                      : kind_ == Kind::Modifier  ? 2
+                                                 : 1;
+    if (args.size() != expected) {
+        throw LispError(name_ + " requires " + std::to_string(expected) +
+                        " argument(s)");
+    }
+    switch (kind_) {
+        case Kind::Constructor: {
+            auto record = RecordValue::make(type_);
+            for (size_t i = 0; i < slots_.size(); i++) {
+                record->setSlot(slots_[i], args[i]);
+            }
+            return record;
+        }
+        case Kind::Predicate:
+            return makeBoolean(typeid(*args[0]) == typeid(RecordValue) &&
+                               static_cast<RecordValue&>(*args[0])
+                                       .getRecordType() == type_.get());
+        case Kind::Accessor:
+            return checkRecord(args[0]).slot(slots_[0]);
+        case Kind::Modifier:
+            checkRecord(args[0]).setSlot(slots_[0], args[1]);
+            return makeNil();
+    }
+    return makeNil();
+}
+
+// ===== MemoizedValue实现 =====
+MemoizedValue::MemoizedValue(ValuePtr proc, size_t capacity, std::string name)
+    : proc_(std::move(proc)), capacity_(capacity), name_(std::move(name)) {}
+
+std::string MemoizedValue::toString() const {
+    return name_.empty() ? "#<procedure>" : "#<procedure " + name_ + ">";
+}
+
+std::string MemoizedValue::getType() const {
+    return "procedure";
+}
+
+bool MemoizedValue::isSelfEvaluating() const {
+    return false;
+}
+
+bool MemoizedValue::isNil() const {
+    return false;
+}
+
+bool MemoizedValue::isBoolean() const {
+    return false;
+}
+
+bool MemoizedValue::getValue() const {
+    throw LispError("Procedure is not a boolean");
+}
+
+bool MemoizedValue::isSymbol() const {
+    return false;
+}
+
+bool MemoizedValue::isTrue() const {
+    return false;
+}
+
+bool MemoizedValue::operator==(const Value& other) const {
+    return this == &other;
+}
+
+std::optional<std::string> MemoizedValue::asSymbol() const {
+    return std::nullopt;
+}
+
+std::vector<ValuePtr> MemoizedValue::toVector() const {
+    throw std::runtime_error("Procedure cannot be converted to vector");
+}
+
+double MemoizedValue::asNumber() const {
+    throw LispError("Procedure is not a number");
+}
+
+bool MemoizedValue::isNumber() const {
+    return false;
+}
+
+bool MemoizedValue::isList() const {
+    return false;
+}
+
+bool MemoizedValue::isPair() const {
+    return false;
+}
+
+bool MemoizedValue::isString() const {
+    return false;
+}
+
+bool MemoizedValue::isProcedure() const {
+    return true;
+}
+
+const std::string& MemoizedValue::getString() const {
+    throw LispError("Procedure is not a string");
+}
+
+bool MemoizedValue::KeyEqual::operator()(const Key& a, const Key& b) const {
+    if (a.args->size() != b.args->size()) return false;
+    for (size_t i = 0; i < a.args->size(); i++) {
+        if (!valuesEqual((*a.args)[i], (*b.args)[i])) return false;
+    }
+    return true;
+}
+
+ValuePtr MemoizedValue::apply(const std::vector<ValuePtr>& args,
+                              EvalEnv& env) {
+    size_t hash = args.size();
+    for (auto& arg : args) hash = combineHash(equalHash(arg), hash);
+    auto found = index_.find(Key{&args, hash});
+    if (found != index_.end()) {
+        hits_++;
+        entries_.splice(entries_.begin(), entries_, found->second);
+        return found->second->result;
+    }
+
+    misses_++;
+    // 被包装的过程通常会递归调用本过程，期间缓存可能已经变化，
+    // 因此不持有任何迭代器，求值结束后再插入
+    ValuePtr result = env.apply(proc_, args);
+    if (index_.contains(Key{&args, hash})) return result;
+    entries_.push_front({args, result, hash});
+    index_.emplace(Key{&entries_.front().args, hash}, entries_.begin());
+    if (entries_.size() > capacity_) {
+        const Entry& oldest = entries_.back();
+        index_.erase(Key{&oldest.args, oldest.hash});
+        entries_.pop_back();
+    }
+    return entries_.front().result;
+}
+
+void MemoizedValue::clear() {
+    index_.clear();
+    entries_.clear();
+    hits_ = 0;
+    misses_ = 0;
+}
+
+// ===== PersistentMapValue实现 =====
+PersistentMapValue::PersistentMapValue(PersistentMap map, Kind kind)
+    : map_(std::move(map)), kind_(kind) {}
+
+std::string PersistentMapValue::toString() const {
+    return printToString(*this);
+}
+
+std::string PersistentMapValue::getType() const {
+    return kind_ == Kind::Set ? "pset" : "pmap";
+}
+
+bool PersistentMapValue::isSelfEvaluating() const {
+    return true;
+}
+
+bool PersistentMapValue::isNil() const {
+    return false;
+}
+
+bool PersistentMapValue::isBoolean() const {
+    return false;
+}
+
+bool PersistentMapValue::getValue() const {
+    throw LispError("Persistent map is not a boolean");
+}
+
+bool PersistentMapValue::isSymbol() const {
+    return false;
+}
+
+bool PersistentMapValue::isTrue() const {
+    return false;
+}
+
+bool PersistentMapValue::operator==(const Value& other) const {
+    auto map = dynamic_cast<const PersistentMapValue*>(&other);
+    if (!map || map->kind_ != kind_ || map->map_.size() != map_.size()) {
+        return false;
+    }
+    bool equal = true;
+    map_.forEach([&](const ValuePtr& key, const ValuePtr& value) {
+        if (!equal) return;
+        const ValuePtr* found = map->map_.find(key);
+        equal = found && valuesEqual(*found, value);
+    });
+    return equal;
+}
+
+std::optional<std::string> PersistentMapValue::asSymbol() const {
+    return std::nullopt;
+}
+
+std::vector<ValuePtr> PersistentMapValue::toVector() const {
+    throw std::runtime_error("Persistent map cannot be converted to vector");
+}
+
+double PersistentMapValue::asNumber() const {
+    throw LispError("Persistent map is not a number");
+}
+
+bool PersistentMapValue::isNumber() const {
+    return false;
+}
+
+bool PersistentMapValue::isList() const {
+    return false;
+}
+
+bool PersistentMapValue::isPair() const {
+    return false;
+}
+
+bool PersistentMapValue::isString() const {
+    return false;
+}
+
+bool PersistentMapValue::isProcedure() const {
+    return false;
+}
+
+const std::string& PersistentMapValue::getString() const {
+    throw LispError("Persistent map is not a string");
+}
+
+std::size_t PersistentMapValue::contentHash() const {
+    // 与遍历顺序无关：各条目的哈希相加
+    std::size_t hash = map_.size() * 31 + static_cast<std::size_t>(kind_);
+    map_.forEach([&](const ValuePtr& key, const ValuePtr& value) {
+        hash += combineHash(equalHash(key), equalHash(value));
+    });
+    return hash;
+}
+
+// ===== PersistentVectorValue实现 =====
+PersistentVectorValue::PersistentVectorValue(PersistentVector vector)
+    : vector_(std::move(vector)) {}
+
+std::string PersistentVectorValue::toString() const {
+    return printToString(*this);
+}
+
+std::string PersistentVectorValue::getType() const {
+    return "pvec";
+}
+
+bool PersistentVectorValue::isSelfEvaluating() const {
+    return true;
+}
+
+bool PersistentVectorValue::isNil() const {
+    return false;
+}
+
+bool PersistentVectorValue::isBoolean() const {
+    return false;
+}
+
+bool PersistentVectorValue::getValue() const {
+    throw LispError("Persistent vector is not a boolean");
+}
+
+bool PersistentVectorValue::isSymbol() const {
+    return false;
+}
+
+bool PersistentVectorValue::isTrue() const {
+    return false;
+}
+
+bool PersistentVectorValue::operator==(const Value& other) const {
+    auto vector = dynamic_cast<const PersistentVectorValue*>(&other);
+    if (!vector || vector->vector_.size() != vector_.size()) return false;
+    for (size_t i = 0; i < vector_.size(); i++) {
+        if (!valuesEqual(vector_.nth(i), vector->vector_.nth(i))) return false;
+    }
+    return true;
+}
+
+std::optional<std::string> PersistentVectorValue::asSymbol() const {
+    return std::nullopt;
+}
+
+std::vector<ValuePtr> PersistentVectorValue::toVector() const {
+    throw std::runtime_error("Persistent vector cannot be converted to vector");
+}
+
+double PersistentVectorValue::asNumber() const {
+    throw LispError("Persistent vector is not a number");
+}
+
+bool PersistentVectorValue::isNumber() const {
+    return false;
+}
+
+bool PersistentVectorValue::isList() const {
+    return false;
+}
+
+bool PersistentVectorValue::isPair() const {
+    return false;
+}
+
+bool PersistentVectorValue::isString() const {
+    return false;
+}
+
+bool PersistentVectorValue::isProcedure() const {
+    return false;
+}
+
+const std::string& PersistentVectorValue::getString() const {
+    throw LispError("Persistent vector is not a string");
+}
+
+std::size_t PersistentVectorValue::contentHash() const {
+    std::size_t hash = vector_.size();
+    vector_.forEach([&](const ValuePtr& element) {
+        hash = combineHash(equalHash(element), hash);
+    });
+    return hash;
+}
+
+// ===== HashTableValue实现 =====
+namespace {
+
+// 负载（含墓碑）超过 3/4 时扩容
+constexpr size_t MIN_TABLE_CAPACITY = 8;
+
+bool exceedsLoad(size_t used, size_t capacity) {
+    return used * 4 >= capacity * 3;
+}
+
+}  // namespace
+
+HashTableValue::HashTableValue(KeyEquality equality) : equality_(equality) {}
+
+std::string HashTableValue::toString() const {
+    return "#<hash-table>";
+}
+
+std::string HashTableValue::getType() const {
+    return "hash-table";
+}
+
+bool HashTableValue::isSelfEvaluating() const {
+    return true;
+}
+
+bool HashTableValue::isNil() const {
+    return false;
+}
+
+bool HashTableValue::isBoolean() const {
+    return false;
+}
+
+bool HashTableValue::getValue() const {
+    throw LispError("Hash table is not a boolean");
+}
+
+bool HashTableValue::isSymbol() const {
+    return false;
+}
+
+bool HashTableValue::isTrue() const {
+    return false;
+}
+
+bool HashTableValue::operator==(const Value& other) const {
+    return this == &other;
+}
+
+std::optional<std::string> HashTableValue::asSymbol() const {
+    return std::nullopt;
+}
+
+std::vector<ValuePtr> HashTableValue::toVector() const {
+    throw std::runtime_error("Hash table cannot be converted to vector");
+}
+
+double HashTableValue::asNumber() const {
+    throw LispError("Hash table is not a number");
+}
+
+bool HashTableValue::isNumber() const {
+    return false;
+}
+
+bool HashTableValue::isList() const {
+    return false;
+}
+
+bool HashTableValue::isPair() const {
+    return false;
+}
+
+bool HashTableValue::isString() const {
+    return false;
+}
+
+bool HashTableValue::isProcedure() const {
+    return false;
+}
+
+const std::string& HashTableValue::getString() const {
+    throw LispError("Hash table is not a string");
+}
+
+size_t HashTableValue::hashKey(const ValuePtr& key) const {
+    if (equality_ == KeyEquality::Equal) return equalHash(key);
+    if (key->isSymbol()) {
+        return std::hash<std::size_t>()(
+            static_cast<const SymbolValue*>(key.get())->getId());
+    }
+    if (key->isNumber()) return numberHash(key->asNumber());
+    return std::hash<const Value*>()(key.get());
+}
+
+bool HashTableValue::keysEqual(const ValuePtr& a, const ValuePtr& b) const {
+    if (a == b) return true;
+    if (equality_ == KeyEquality::Equal) return valuesEqual(a, b);
+    if (a->isSymbol() && b->isSymbol()) {
+        return static_cast<const SymbolValue*>(a.get())->getId() ==
+               static_cast<const SymbolValue*>(b.get())->getId();
+    }
+    if (a->isNumber() && b->isNumber()) {
+        return a->asNumber() == b->asNumber();
+    }
+    return false;
+}
+
+size_t HashTableValue::findSlot(const ValuePtr& key, size_t hash) const {
+    if (slots_.empty()) return 0;
+    size_t mask = slots_.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Slot& slot = slots_[i];
+        if (slot.state == SlotState::Empty) return slots_.size();
+        if (slot.state == SlotState::Full && slot.hash == hash &&
+            keysEqual(slot.key, key)) {
+            return i;
+        }
+    }
+}
+
+const ValuePtr* HashTableValue::find(const ValuePtr& key) const {
+    size_t index = findSlot(key, hashKey(key));
+    return index < slots_.size() ? &slots_[index].value : nullptr;
+}
+
+void HashTableValue::set(ValuePtr key, ValuePtr value) {
+    size_t hash = hashKey(key);
+    size_t index = findSlot(key, hash);
+    if (index < slots_.size()) {
+        slots_[index].value = std::move(value);
+        return;
+    }
+
+    if (slots_.empty() || exceedsLoad(used_ + 1, slots_.size())) {
+        // 墓碑较多时原地重建即可，否则容量翻倍
+        size_t capacity = std::max(MIN_TABLE_CAPACITY, slots_.size());
+        while (exceedsLoad(size_ + 1, capacity)) capacity *= 2;
+        rehash(capacity);
+    }
+
+    // 插入到探测链上第一个空槽或墓碑
+    size_t mask = slots_.size() - 1;
+    size_t i = hash & mask;
+    while (slots_[i].state == SlotState::Full) i = (i + 1) & mask;
+    if (slots_[i].state == SlotState::Empty) used_++;
+    slots_[i] = {std::move(key), std::move(value), hash, SlotState::Full};
+    size_++;
+}
+
+bool HashTableValue::remove(const ValuePtr& key) {
+    size_t index = findSlot(key, hashKey(key));
+    if (index >= slots_.size()) return false;
+    Slot& slot = slots_[index];
+    slot.key = nullptr;
+    slot.value = nullptr;
+    slot.state = SlotState::Deleted;
+    size_--;
+    return true;
+}
+
+void HashTableValue::clear() {
+    slots_.clear();
+    size_ = 0;
+    used_ = 0;
+}
+
+size_t HashTableValue::size() const {
+    return size_;
+}
+
+void HashTableValue::rehash(size_t capacity) {
+    std::vector<Slot> old = std::exchange(slots_, std::vector<Slot>(capacity));
+    used_ = size_;
+    size_t mask = capacity - 1;
+    for (auto& slot : old) {
+        if (slot.state != SlotState::Full) continue;
+        size_t i = slot.hash & mask;
+        while (slots_[i].state != SlotState::Empty) i = (i + 1) & mask;
+        slots_[i] = std::move(slot);
+    }
+}
+
+// ===== OrderedMapValue实现 =====
+std::string OrderedMapValue::toString() const {
+    return printToString(*this);
+}
+
+std::string OrderedMapValue::getType() const {
+    return "omap";
+}
+
+bool OrderedMapValue::isSelfEvaluating() const {
+    return true;
+}
+
+bool OrderedMapValue::isNil() const {
+    return false;
+}
+
+bool OrderedMapValue::isBoolean() const {
+    return false;
+}
+
+bool OrderedMapValue::getValue() const {
+    throw LispError("Ordered map is not a boolean");
+}
+
+bool OrderedMapValue::isSymbol() const {
+    return false;
+}
+
+bool OrderedMapValue::isTrue() const {
+    return false;
+}
+
+bool OrderedMapValue::operator==(const Value& other) const {
+    return this == &other;
+}
+
+std::optional<std::string> OrderedMapValue::asSymbol() const {
+    return std::nullopt;
+}
+
+std::vector<ValuePtr> OrderedMapValue::toVector() const {
+    throw std::runtime_error("Ordered map cannot be converted to vector");
+}
+
+double OrderedMapValue::asNumber() const {
+    throw LispError("Ordered map is not a number");
+}
+
+bool OrderedMapValue::isNumber() const {
+    return false;
+}
+
+bool OrderedMapValue::isList() const {
+    return false;
+}
+
+bool OrderedMapValue::isPair() const {
+    return false;
+}
+
+bool OrderedMapValue::isString() const {
+    return false;
+}
+
+bool OrderedMapValue::isProcedure() const {
+    return false;
+}
+
+const std::string& OrderedMapValue::getString() const {
+    throw LispError("Ordered map is not a string");
+}
+
+// ===== OrderedRangeValue实现 =====
+ValuePtr OrderedRangeValue::make(Ref<OrderedMapValue> map,
+                                 const ValuePtr& lower,
+                                 const ValuePtr& upper) {
+    const BTreeMap& tree = map->getTree();
+    auto position = lower ? tree.lowerBound(lower) : tree.first();
+    return fromPosition(map, position, upper);
+}
+
+ValuePtr OrderedRangeValue::fromPosition(const Ref<OrderedMapValue>& map,
+                                         BTreeMap::Position position,
+                                         const ValuePtr& upper) {
+    if (!position.valid()) return makeNil();
+    const BTreeMap& tree = map->getTree();
+    if (upper && BTreeMap::compareKeys(tree.keyAt(position), upper) >= 0) {
+        return makeNil();
+    }
+    return makeValue<OrderedRangeValue>(map, position, upper);
+}
+
+OrderedRangeValue::OrderedRangeValue(Ref<OrderedMapValue> map,
+                                     BTreeMap::Position position,
+                                     ValuePtr upper)
+    : map_(std::move(map)),
+      position_(position),
+      version_(map_->getTree().version()),
+      key_(map_->getTree().keyAt(position)),
+      value_(map_->getTree().valueAt(position)),
+      upper_(std::move(upper)) {}
+
+OrderedRangeValue::OrderedRangeValue(const OrderedRangeValue& other)
+    : Value(other),
+      map_(other.map_),
+      position_(other.position_),
+      version_(other.version_),
+      key_(other.key_),
+      value_(other.value_),
+      upper_(other.upper_) {}
+
+std::string OrderedRangeValue::toString() const {
+    return printToString(*this);
+}
+
+std::string OrderedRangeValue::getType() const {
+    return "pair";
+}
+
+bool OrderedRangeValue::isSelfEvaluating() const {
+    return false;
+}
+
+bool OrderedRangeValue::isNil() const {
+    return false;
+}
+
+bool OrderedRangeValue::isBoolean() const {
+    return false;
+}
+
+bool OrderedRangeValue::getValue() const {
+    throw LispError("Ordered range is not a boolean");
+}
+
+bool OrderedRangeValue::isSymbol() const {
+    return false;
+}
+
+bool OrderedRangeValue::isTrue() const {
+    return false;
+}
+
+bool OrderedRangeValue::operator==(const Value& other) const {
+    return false;
+}
+
+std::optional<std::string> OrderedRangeValue::asSymbol() const {
+    return std::nullopt;
+}
+
+std::vector<ValuePtr> OrderedRangeValue::toVector() const {
+    std::vector<ValuePtr> result;
+    for (const Value* node = this; node->isPair();
+         node = node->getCdr().get()) {
+        result.push_back(node->getCar());
+    }
+    return result;
+}
+
+double OrderedRangeValue::asNumber() const {
+    throw LispError("Ordered range is not a number");
+}
+
+bool OrderedRangeValue::isNumber() const {
+    return false;
+}
+
+bool OrderedRangeValue::isList() const {
+    return true;
+}
+
+bool OrderedRangeValue::isPair() const {
+    return true;
+}
+
+bool OrderedRangeValue::isString() const {
+    return false;
+}
+
+bool OrderedRangeValue::isProcedure() const {
+    return false;
+}
+
+const std::string& OrderedRangeValue::getString() const {
+    throw LispError("Ordered range is not a string");
+}
+
+const ValuePtr& OrderedRangeValue::getCar() const {
+    if (!car_) car_ = makeValue<PairValue>(key_, value_);
+    return car_;
+}
+
+const ValuePtr& OrderedRangeValue::getCdr() const {
+    if (!cdr_) {
+        const BTreeMap& tree = map_->getTree();
+        auto next = tree.version() == version_ ? tree.next(position_)
+                                               : tree.lowerBound(key_, true);
+        cdr_ = fromPosition(map_, next, upper_);
+    }
+    return cdr_;
+}
+
+// ===== PortValue实现 =====
+PortValue::PortValue(std::shared_ptr<OutputPort> port)
+    : port_(std::move(port)) {}
+
+std::string PortValue::toString() const {
+    return "#<output-port>";
+}
+
+std::string PortValue::getType() const {
+    return "output-port";
+}
+
+bool PortValue::isSelfEvaluating() const {
+    return true;
+}
+
+bool PortValue::isNil() const {
+    return false;
+}
+
+bool PortValue::isBoolean() const {
+    return false;
+}
+
+bool PortValue::getValue() const {
+    throw LispError("Output port is not a boolean");
+}
+
+bool PortValue::isSymbol() const {
+    return false;
+}
+
+bool PortValue::isTrue() const {
+    return false;
+}
+
+bool PortValue::operator==(const Value& other) const {
+    return this == &other;
+}
+
+std::optional<std::string> PortValue::asSymbol() const {
+    return std::nullopt;
+}
+
+std::vector<ValuePtr> PortValue::toVector() const {
+    throw std::runtime_error("Output port cannot be converted to vector");
+}
+
+double PortValue::asNumber() const {
+    throw LispError("Output port is not a number");
+}
+
+bool PortValue::isNumber() const {
+    return false;
+}
+
+bool PortValue::isList() const {
+    return false;
+}
+
+bool PortValue::isPair() const {
+    return false;
+}
+
+bool PortValue::isString() const {
+    return false;
+}
+
+bool PortValue::isProcedure() const {
+    return false;
+}
+
+const std::string& PortValue::getString() const {
+    throw LispError("Output port is not a string");
+}
+
+// ===== RangeValue实现 =====
+RangeValue::RangeValue(double start, double step, size_t count)
+    : start_(start), step_(step), count_(count) {}
+
+RangeValue::RangeValue(const RangeValue& other)
+    : Value(other),
+      start_(other.start_),
+      step_(other.step_),
+      count_(other.count_) {}
+
+std::string RangeValue::toString() const {
+    return printToString(*this);
+}
+
+std::string RangeValue::getType() const {
+    return "pair";
+}
+
+bool RangeValue::isSelfEvaluating() const {
+    return false;
+}
+
+bool RangeValue::isNil() const {
+    return false;
+}
+
+bool RangeValue::isBoolean() const {
+    return false;
+}
+
+bool RangeValue::getValue() const {
+    throw LispError("Range value is not a boolean");
+}
+
+bool RangeValue::isSymbol() const {
+    return false;
+}
+
+bool RangeValue::isTrue() const {
+    return true;
+}
+
+bool RangeValue::operator==(const Value& other) const {
+    if (this == &other) return true;
+    if (auto range = dynamic_cast<const RangeValue*>(&other)) {
+        if (count_ != range->count_) return false;
+        for (size_t i = 0; i < count_; i++) {
+            if (at(i) != range->at(i)) return false;
+        }
+        return true;
+    }
+    // 其他列表表示按元素逐个比较，与 equal? 对列表的语义一致
+    if (!other.isPair()) return false;
+    ListIterator item(&other, true), end;
+    size_t index = 0;
+    for (; item != end; ++item, ++index) {
+        const Value* car = item->get();
+        if (index >= count_ || !car->isNumber() ||
+            car->asNumber() != at(index)) {
+            return false;
+        }
+    }
+    return index == count_ && item.tail()->isNil();
+}
+
+std::optional<std::string> RangeValue::asSymbol() const {
+    return std::nullopt;
+}
+
+std::vector<ValuePtr> RangeValue::toVector() const {
+    std::vector<ValuePtr> result;
+    result.reserve(count_);
+    for (size_t i = 0; i < count_; i++) {
+        result.push_back(makeNumber(at(i)));
+    }
+    return result;
+}
+
+double RangeValue::asNumber() const {
+    throw LispError("Range is not a number");
+}
+
+bool RangeValue::isNumber() const {
+    return false;
+}
+
+bool RangeValue::isList() const {
+    return true;
+}
+
+bool RangeValue::isPair() const {
+    return true;
+}
+
+bool RangeValue::isString() const {
+    return false;
+}
+
+bool RangeValue::isProcedure() const {
+    return false;
+}
+
+const std::string& RangeValue::getString() const {
+    throw LispError("Range is not a string");
+}
+
+const ValuePtr& RangeValue::getCar() const {
+    if (!car_) car_ = makeNumber(start_);
+    return car_;
+}
+
+const ValuePtr& RangeValue::getCdr() const {
+    if (!cdr_) {
+        if (count_ == 1) {
+            cdr_ = makeNil();
+        } else {
+            cdr_ = makeValue<RangeValue>(start_ + step_, step_, count_ - 1);
+        }
+    }
+    return cdr_;
+}
+
+size_t RangeValue::size() const {
+    return count_;
+}
+
+double RangeValue::at(size_t index) const {
+    return start_ + step_ * static_cast<double>(index);
+}
+
+// ===== CompactListValue实现 =====
+CompactListValue::CompactListValue(std::shared_ptr<const Block> block,
+                                   size_t offset, ValuePtr tail)
+    : block_(std::move(block)), offset_(offset), tail_(std::move(tail)) {}
+
+ValuePtr CompactListValue::fromVector(Block elements, ValuePtr tail) {
+    if (!tail) tail = makeNil();
+    if (elements.empty()) return tail;
+    return makeValue<CompactListValue>(
+        std::make_shared<const Block>(std::move(elements)), 0,
+        std::move(tail));
+}
+
+std::string CompactListValue::toString() const {
+    return printToString(*this);
+}
+
+std::string CompactListValue::getType() const {
+    return "pair";
+}
+
+bool CompactListValue::isSelfEvaluating() const {
+    return false;
+}
+
+bool CompactListValue::isNil() const {
+    return false;
+}
+
+bool CompactListValue::isBoolean() const {
+    return false;
+}
+
+bool CompactListValue::getValue() const {
+    throw LispError("Pair value is not a boolean");
+}
+
+bool CompactListValue::isSymbol() const {
+    return false;
+}
+
+bool CompactListValue::isTrue() const {
+    return false;
+}
+
+bool CompactListValue::operator==(const Value& other) const {
+    return false;
+}
+
+std::optional<std::string> CompactListValue::asSymbol() const {
+    return std::nullopt;
+}
+
+std::vector<ValuePtr> CompactListValue::toVector() const {
+    std::vector<ValuePtr> result;
+    result.reserve(size());
+    for (ListIterator it(this), end; it != end; ++it) {
+        result.push_back(*it);
+    }
+    return result;
+}
+
+double CompactListValue::asNumber() const {
+    throw LispError("Pair is not a number");
+}
+
+bool CompactListValue::isNumber() const {
+    return false;
+}
+
+bool CompactListValue::isList() const {
+    // 是否为列表取决于最终的尾部；尾部可能仍是紧凑列表，逐段向后找
+    const Value* tail = tail_.get();
+    while (typeid(*tail) == typeid(CompactListValue)) {
+        tail = static_cast<const CompactListValue*>(tail)->tail_.get();
+    }
+    return tail->isList();
+}
+
+bool CompactListValue::isPair() const {
+    return true;
+}
+
+bool CompactListValue::isString() const {
+    return false;
+}
+
+bool CompactListValue::isProcedure() const {
+    return false;
+}
+
+const std::string& CompactListValue::getString() const {
+    throw LispError("Pair is not a string");
+}
+
+const ValuePtr& CompactListValue::getCar() const {
+    return (*block_)[offset_];
+}
+
+const ValuePtr& CompactListValue::getCdr() const {
+    if (offset_ + 1 == block_->size()) {
+        return tail_;
+    }
+    if (!cdr_) {
+        cdr_ = makeValue<CompactListValue>(block_, offset_ + 1, tail_);
+    }
+    return cdr_;
+}
+
+const ValuePtr* CompactListValue::begin() const {
+    return block_->data() + offset_;
+}
+
+const ValuePtr* CompactListValue::end() const {
+    return block_->data() + block_->size();
+}
+
+size_t CompactListValue::size() const {
+    return block_->size() - offset_;
+}
+
+const ValuePtr& CompactListValue::getTail() const {
+    return tail_;
+}
+
+// ===== ListIterator实现 =====
+void ListIterator::enter(const Value* node) {
+    node_ = node;
+    if (!node->isPair()) {
+        if (!node->isNil() && !allowImproper_) {
+            throw LispError("Malformed list.");
+        }
+        kind_ = Kind::End;
+        return;
+    }
+    // 按精确类型分派，避开 dynamic_cast 的开销
+    const auto& type = typeid(*node);
+    if (type == typeid(CompactListValue)) {
+        auto compact = static_cast<const CompactListValue*>(node);
+        kind_ = Kind::Compact;
+        cur_ = compact->begin();
+        last_ = compact->end();
+    } else if (type == typeid(RangeValue)) {
+        kind_ = Kind::Range;
+        index_ = 0;
+        item_ = makeNumber(static_cast<const RangeValue*>(node)->at(0));
+    } else {
+        kind_ = Kind::Pair;
+        cur_ = &node->getCar();
+    }
+}
+
+void ListIterator::advance() {
+    switch (kind_) {
+        case Kind::Pair:
+            enter(node_->getCdr().get());
+            break;
+        case Kind::Compact:
+            enter(static_cast<const CompactListValue*>(node_)
+                      ->getTail()
+                      .get());
+            break;
+        case Kind::Range: {
+            auto range = static_cast<const RangeValue*>(node_);
+            if (++index_ < range->size()) {
+                item_ = makeNumber(range->at(index_));
+            } else {
+                item_ = nullptr;
+                enter(makeNil().get());
+            }
+            break;
+        }
+        case Kind::End:
+            break;
+    }
+}
+
+// ===== ListView实现 =====
+size_t ListView::size() const {
+    size_t count = 0;
+    for (auto it = begin(); it != end(); ++it) {
+        count++;
+    }
+    return count;
+}
+
+std::vector<ValuePtr> ListView::toVector() const {
+    std::vector<ValuePtr> result;
+    for (auto& item : *this) {
+        result.push_back(item);
+    }
+    return result;
+}
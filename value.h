@@ -1,25 +1,71 @@
 #pragma once
 
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <functional>
+#include <iterator>
+#include <list>
 #include <memory>
 #include <new>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <typeinfo>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "btree.h"
 #include "error.h"
+#include "persistent.h"
+#include "pool.h"
+#include "region.h"
 
 class Value;
-using ValuePtr = std::shared_ptr<Value>;
+template <typename T>
+class Ref;
+using ValuePtr = Ref<Value>;
 class EvalEnv;
 class LambdaValue;
+class OutputPort;
+
+// 引用计数嵌在对象头中。解释器默认单线程运行，使用普通整数计数；
+// 定义 MINI_LISP_THREADS 时改用原子计数，以便跨线程共享 Value
+#ifdef MINI_LISP_THREADS
+using RefCount = std::atomic<std::uint32_t>;
+#else
+using RefCount = std::uint32_t;
+#endif
+
+// 结构哈希的缓存，0 表示尚未计算。值不可变，缓存一旦写入就不再改变；
+// 复制对象时一并复制
+class HashCache {
+public:
+    HashCache() = default;
+    HashCache(const HashCache& other) : value_(other.get()) {}
+    HashCache& operator=(const HashCache& other) {
+        set(other.get());
+        return *this;
+    }
+
+    std::size_t get() const {
+        return value_.load(std::memory_order_relaxed);
+    }
+    void set(std::size_t hash) const {
+        value_.store(hash, std::memory_order_relaxed);
+    }
+
+private:
+    mutable std::atomic<std::size_t> value_{0};
+};
 
 class Value {
 public:
+    // 计数归零时负责析构并归还内存，由创建对象的工厂设置
+    using Deleter = void (*)(Value*);
+
     virtual ~Value() = default;
     virtual std::string toString() const = 0;
     virtual bool isSelfEvaluating() const = 0;
@@ -38,11 +84,12 @@ public:
     virtual bool isBoolean() const = 0;
     virtual bool getValue() const;  // 获取布尔值
     virtual bool isSymbol() const = 0;
-    virtual ValuePtr getCar() const {
+    // 返回引用，遍历列表时不必增减引用计数
+    virtual const ValuePtr& getCar() const {
         throw LispError("Cannot get car of non-pair value");
     }
 
-    virtual ValuePtr getCdr() const {
+    virtual const ValuePtr& getCdr() const {
         throw LispError("Cannot get cdr of non-pair value");
     }
     virtual bool isTrue() const = 0;
@@ -52,11 +99,204 @@ public:
 
     operator std::vector<ValuePtr>() const;
     virtual bool operator==(const Value& other) const = 0;
+
+    void retain() const noexcept {
+#ifdef MINI_LISP_THREADS
+        refCount_.fetch_add(1, std::memory_order_relaxed);
+#else
+        ++refCount_;
+#endif
+    }
+    void release() const noexcept {
+#ifdef MINI_LISP_THREADS
+        if (refCount_.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+#else
+        if (--refCount_ != 0) return;
+#endif
+        reclaim(const_cast<Value*>(this));
+    }
+    std::uint32_t useCount() const noexcept {
+        return refCount_;
+    }
+
+    // 计数归零的对象先放入当前线程的回收队列，再由队列逐个析构。
+    // 析构中释放的成员只会入队，长列表和深层结构不会递归析构。
+    // budget 限制每次释放时最多析构的对象数，0 表示一次回收完毕；
+    // 超出部分留在队列中，由之后的释放或 drainReclaim 继续处理
+    static void setReclaimBudget(std::size_t budget) noexcept;
+    // 最多析构 budget 个排队对象，返回仍在排队的数量
+    static std::size_t drainReclaim(
+        std::size_t budget = static_cast<std::size_t>(-1)) noexcept;
+
+protected:
+    Value() = default;
+    // 复制得到的是新对象，引用计数和释放方式不随之复制
+    Value(const Value&) : Value() {}
+    Value& operator=(const Value&) {
+        return *this;
+    }
+
+private:
+    template <typename T>
+    friend struct ValueFactory;
+
+    static void deleteValue(Value* value) {
+        delete value;
+    }
+    static void reclaim(Value* value) noexcept;
+
+    mutable RefCount refCount_{0};
+    Deleter deleter_ = &deleteValue;
+};
+
+// 侵入式引用计数句柄，用法与 std::shared_ptr 相同
+template <typename T>
+class Ref {
+public:
+    Ref() noexcept = default;
+    Ref(std::nullptr_t) noexcept {}
+    explicit Ref(T* ptr) noexcept : ptr_(ptr) {
+        if (ptr_) ptr_->retain();
+    }
+    Ref(const Ref& other) noexcept : Ref(other.ptr_) {}
+    Ref(Ref&& other) noexcept : ptr_(std::exchange(other.ptr_, nullptr)) {}
+    template <typename U,
+              typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    Ref(const Ref<U>& other) noexcept : Ref(other.get()) {}
+    template <typename U,
+              typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    Ref(Ref<U>&& other) noexcept : ptr_(other.detach()) {}
+    ~Ref() {
+        if (ptr_) ptr_->release();
+    }
+
+    Ref& operator=(const Ref& other) noexcept {
+        // 先持有新对象再释放旧对象：other 可能正是旧对象的成员
+        T* old = ptr_;
+        ptr_ = other.ptr_;
+        if (ptr_) ptr_->retain();
+        if (old) old->release();
+        return *this;
+    }
+    Ref& operator=(Ref&& other) noexcept {
+        Ref(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    T* get() const noexcept {
+        return ptr_;
+    }
+    T& operator*() const noexcept {
+        return *ptr_;
+    }
+    T* operator->() const noexcept {
+        return ptr_;
+    }
+    explicit operator bool() const noexcept {
+        return ptr_ != nullptr;
+    }
+    std::uint32_t useCount() const noexcept {
+        return ptr_ ? ptr_->useCount() : 0;
+    }
+    void swap(Ref& other) noexcept {
+        std::swap(ptr_, other.ptr_);
+    }
+    // 交出所有权而不改变计数
+    T* detach() noexcept {
+        return std::exchange(ptr_, nullptr);
+    }
+
+    template <typename U>
+    bool operator==(const Ref<U>& other) const noexcept {
+        return ptr_ == other.get();
+    }
+    bool operator==(std::nullptr_t) const noexcept {
+        return ptr_ == nullptr;
+    }
+
+private:
+    T* ptr_ = nullptr;
+};
+
+// 与 std::dynamic_pointer_cast 相同，类型不符时返回空句柄
+template <typename T, typename U>
+Ref<T> dynamicRefCast(const Ref<U>& ref) {
+    return Ref<T>(dynamic_cast<T*>(ref.get()));
+}
+
+// 负责在区域或对象池中构造 Value，并设置对应的释放方式
+template <typename T>
+struct ValueFactory {
+    template <typename... Args>
+    static Ref<T> inRegion(Region& region, Args&&... args) {
+        void* memory = region.allocate(sizeof(T));
+        try {
+            T* value = new (memory) T(std::forward<Args>(args)...);
+            value->deleter_ = &destroyInRegion;
+            return Ref<T>(value);
+        } catch (...) {
+            Region::deallocate(memory);
+            throw;
+        }
+    }
+
+    template <typename... Args>
+    static Ref<T> inPool(Args&&... args) {
+        void* memory =
+            poolFor<T>().allocate(threadCacheFor<T>(), sizeof(T));
+        try {
+            T* value = new (memory) T(std::forward<Args>(args)...);
+            value->deleter_ = &destroyInPool;
+            return Ref<T>(value);
+        } catch (...) {
+            poolFor<T>().deallocate(threadCacheFor<T>(), memory, sizeof(T));
+            throw;
+        }
+    }
+
+private:
+    static void destroyInRegion(Value* value) {
+        static_cast<T*>(value)->~T();
+        Region::deallocate(static_cast<T*>(value));
+    }
+    static void destroyInPool(Value* value) {
+        T* object = static_cast<T*>(value);
+        object->~T();
+        poolFor<T>().deallocate(threadCacheFor<T>(), object, sizeof(T));
+    }
 };
 
+// 在该类型的对象池中创建，不受请求区域影响（用于需要长期存活的对象）
+template <typename T, typename... Args>
+Ref<T> makePooledValue(Args&&... args) {
+    return ValueFactory<T>::inPool(std::forward<Args>(args)...);
+}
+
+// 创建 Value 对象的统一入口：有活动的请求区域时在区域中分配，否则使用对象池
+template <typename T, typename... Args>
+Ref<T> makeValue(Args&&... args) {
+    if (Region* region = Region::current()) {
+        return ValueFactory<T>::inRegion(*region, std::forward<Args>(args)...);
+    }
+    return makePooledValue<T>(std::forward<Args>(args)...);
+}
+
+// 常量池：空表、#t、#f 各只有一个永不释放的实例，可以直接比较指针；
+// [SMALL_INT_MIN, SMALL_INT_MAX] 内的整数也预先分配、共享同一对象
+constexpr int SMALL_INT_MIN = -1024;
+constexpr int SMALL_INT_MAX = 1024;
+const ValuePtr& makeNil();
+const ValuePtr& makeBoolean(bool value);
+ValuePtr makeNumber(double value);
+
+// equal? 语义的结构相等：沿 cdr 链迭代比较，长列表不会导致递归过深
+bool valuesEqual(const ValuePtr& a, const ValuePtr& b);
+// 与 valuesEqual 一致的结构哈希（相等的值哈希相同），
+// 序对、紧凑列表和字符串会缓存计算结果
+std::size_t equalHash(const ValuePtr& value);
+
 class BooleanValue : public Value {
 public:
-    explicit BooleanValue(bool value);
     std::string toString() const override;
     bool isSelfEvaluating() const override;
     bool isNil() const override;
@@ -81,6 +321,11 @@ public:
     std::string getType() const override;
 
 private:
+    // 只能通过 makeBoolean 取得
+    template <typename T>
+    friend struct ValueFactory;
+    explicit BooleanValue(bool value);
+
     bool value_;
 };
 
@@ -115,9 +360,22 @@ private:
     double value_;
 };
 
+// 字符串，内容不可变，内部有三种表示：
+//   独立的缓冲区（字面量、拼接展平后的结果）；
+//   共享缓冲区中的一段切片（substring、string-split 的结果，不复制字符）；
+//   rope 节点（string-append 的结果，只记录左右两部分）。
+// 需要连续内容时 rope 才一次性展平并缓存，getString 还会把切片物化成
+// 独立的 std::string。这些只改变内部表示，对外的值不变
 class StringValue : public Value {
 public:
     explicit StringValue(std::string value);
+    // buffer 中从 offset 开始的 length 个字节
+    StringValue(std::shared_ptr<const std::string> buffer, size_t offset,
+                size_t length);
+    // left 与 right 的连接
+    StringValue(Ref<StringValue> left, Ref<StringValue> right);
+    // 与 other 共享缓冲区或 rope 子节点，不展平、不复制字符
+    StringValue(const StringValue& other);
     std::string toString() const override;
     bool isSelfEvaluating() const override;
     bool isNil() const override;
@@ -142,13 +400,33 @@ public:
     // 新增 getType
     std::string getType() const override;
 
+    const HashCache& hashCache() const {
+        return hash_;
+    }
+
+    // 字节数，不需要展平
+    size_t length() const {
+        return length_;
+    }
+    // 连续的内容，在本对象存活且不再调用 getString 期间有效
+    std::string_view view() const;
+    // 与本字符串共享缓冲区的子串，调用者保证范围合法
+    Ref<StringValue> slice(size_t offset, size_t length) const;
+
 private:
-    std::string value_;
+    // 把 rope 展平为独立的缓冲区
+    void flatten() const;
+
+    mutable std::shared_ptr<const std::string> buffer_;  // rope 节点为空
+    mutable size_t offset_ = 0;
+    size_t length_;
+    mutable Ref<StringValue> left_;  // 展平后释放
+    mutable Ref<StringValue> right_;
+    HashCache hash_;  // equalHash 的缓存
 };
 
 class NilValue : public Value {
 public:
-    NilValue();
     std::string toString() const override;
     bool isSelfEvaluating() const override;
     bool isNil() const override;
@@ -171,6 +449,12 @@ public:
 
     // 新增 getType
     std::string getType() const override;
+
+private:
+    // 只能通过 makeNil 取得
+    template <typename T>
+    friend struct ValueFactory;
+    NilValue();
 };
 
 class SymbolValue : public Value {
@@ -199,21 +483,22 @@ public:
 
     // 新增 getType
     std::string getType() const override;
+    const std::string& getName() const;
+    // 同名符号的编号相同，可代替名字作为查找键
+    std::size_t getId() const;
 
 private:
     std::string name_;
+    std::size_t id_;
 };
 
-class PairValue : public Value, public std::enable_shared_from_this<PairValue> {
+class PairValue : public Value {
 public:
     PairValue(ValuePtr car, ValuePtr cdr);
     PairValue(const std::vector<ValuePtr>& car, ValuePtr cdr);
     explicit PairValue(ValuePtr car);
     PairValue();
 
-    std::shared_ptr<PairValue> shared_from_this() {
-        return std::enable_shared_from_this<PairValue>::shared_from_this();
-    }
     std::string toString() const override;
     bool isSelfEvaluating() const override;
     bool isNil() const override;
@@ -238,12 +523,17 @@ public:
     // 新增 getType
     std::string getType() const override;
 
-    ValuePtr getCar() const override;
-    ValuePtr getCdr() const;
+    const ValuePtr& getCar() const override;
+    const ValuePtr& getCdr() const override;
+
+    const HashCache& hashCache() const {
+        return hash_;
+    }
 
 private:
     ValuePtr car_;
     ValuePtr cdr_;
+    HashCache hash_;  // equalHash 的缓存
 };
 
 class BuiltinProcValue : public Value {
@@ -318,3 +608,841 @@ private:
     std::vector<ValuePtr> body;
     std::shared_ptr<EvalEnv> closureEnv;  // 闭包环境
 };
+
+class TransducerValue : public Value {
+public:
+    // 流水线中的一步：映射或过滤
+    struct Stage {
+        enum class Kind { Map, Filter };
+        Kind kind;
+        ValuePtr proc;
+    };
+
+    explicit TransducerValue(std::vector<Stage> stages);
+
+    std::string toString() const override;
+    bool isSelfEvaluating() const override;
+    bool isNil() const override;
+    std::optional<std::string> asSymbol() const override;
+    std::vector<ValuePtr> toVector() const override;
+    double asNumber() const override;
+    bool isNumber() const override;
+    bool isList() const override;
+    bool isPair() const override;
+    bool isString() const override;
+    bool isProcedure() const override;
+    const std::string& getString() const override;
+
+    bool isBoolean() const override;
+    bool getValue() const override;
+    bool isSymbol() const override;
+    bool isTrue() const override;
+    bool operator==(const Value& other) const override;
+    const std::vector<Stage>& getStages() const;
+
+    std::string getType() const override;
+
+private:
+    std::vector<Stage> stages_;
+};
+
+// 连续存储的向量，下标访问 O(1)。元素可以被 vector-set! 修改，
+// 通常比创建它的求值活得更久，因此和哈希表一样总在对象池中创建
+class VectorValue : public Value {
+public:
+    explicit VectorValue(std::vector<ValuePtr> elements);
+
+    std::string toString() const override;
+    bool isSelfEvaluating() const override;
+    bool isNil() const override;
+    std::optional<std::string> asSymbol() const override;
+    std::vector<ValuePtr> toVector() const override;
+    double asNumber() const override;
+    bool isNumber() const override;
+    bool isList() const override;
+    bool isPair() const override;
+    bool isString() const override;
+    bool isProcedure() const override;
+    const std::string& getString() const override;
+
+    bool isBoolean() const override;
+    bool getValue() const override;
+    bool isSymbol() const override;
+    bool isTrue() const override;
+    bool operator==(const Value& other) const override;
+
+    std::string getType() const override;
+
+    size_t size() const;
+    const ValuePtr& at(size_t index) const;
+    void set(size_t index, ValuePtr value);
+    const std::vector<ValuePtr>& getElements() const;
+
+private:
+    std::vector<ValuePtr> elements_;
+};
+
+// 不装箱、同类元素连续存放的数值数组（f64/s64/u8），逐元素运算见 simd.h。
+// 元素可以修改，总在对象池中创建
+class TypedArrayBase : public Value {
+public:
+    enum class ElementType { F64, S64, U8 };
+
+    virtual ElementType elementType() const = 0;
+    virtual size_t size() const = 0;
+    // 按数值读写单个元素，写入时检查数值能否用元素类型精确表示
+    virtual double numberAt(size_t index) const = 0;
+    virtual void setNumber(size_t index, double value) = 0;
+    virtual std::size_t contentHash() const = 0;
+};
+
+template <typename T>
+class TypedArrayValue : public TypedArrayBase {
+public:
+    explicit TypedArrayValue(std::vector<T> elements);
+
+    std::string toString() const override;
+    bool isSelfEvaluating() const override;
+    bool isNil() const override;
+    std::optional<std::string> asSymbol() const override;
+    std::vector<ValuePtr> toVector() const override;
+    double asNumber() const override;
+    bool isNumber() const override;
+    bool isList() const override;
+    bool isPair() const override;
+    bool isString() const override;
+    bool isProcedure() const override;
+    const std::string& getString() const override;
+
+    bool isBoolean() const override;
+    bool getValue() const override;
+    bool isSymbol() const override;
+    bool isTrue() const override;
+    bool operator==(const Value& other) const override;
+
+    std::string getType() const override;
+
+    ElementType elementType() const override;
+    size_t size() const override;
+    double numberAt(size_t index) const override;
+    void setNumber(size_t index, double value) override;
+    std::size_t contentHash() const override;
+
+    std::vector<T>& getElements();
+    const std::vector<T>& getElements() const;
+
+    // 元素类型的名字，如 "f64"
+    static const char* elementName();
+    // 把数值转换为元素类型，无法精确表示时抛出 LispError
+    static T fromNumber(double value);
+
+private:
+    std::vector<T> elements_;
+};
+
+using F64VectorValue = TypedArrayValue<double>;
+using S64VectorValue = TypedArrayValue<std::int64_t>;
+using U8VectorValue = TypedArrayValue<std::uint8_t>;
+
+extern template class TypedArrayValue<double>;
+extern template class TypedArrayValue<std::int64_t>;
+extern template class TypedArrayValue<std::uint8_t>;
+
+// 行主序连续存储的 double 矩阵，计算内核见 matrix.h。元素可以修改，
+// 总在对象池中创建
+class MatrixValue : public Value {
+public:
+    MatrixValue(size_t rows, size_t cols, std::vector<double> data);
+
+    std::string toString() const override;
+    bool isSelfEvaluating() const override;
+    bool isNil() const override;
+    std::optional<std::string> asSymbol() const override;
+    std::vector<ValuePtr> toVector() const override;
+    double asNumber() const override;
+    bool isNumber() const override;
+    bool isList() const override;
+    bool isPair() const override;
+    bool isString() const override;
+    bool isProcedure() const override;
+    const std::string& getString() const override;
+
+    bool isBoolean() const override;
+    bool getValue() const override;
+    bool isSymbol() const override;
+    bool isTrue() const override;
+    bool operator==(const Value& other) const override;
+
+    std::string getType() const override;
+
+    size_t rows() const;
+    size_t cols() const;
+    double at(size_t row, size_t col) const;
+    void set(size_t row, size_t col, double value);
+    std::vector<double>& getData();
+    const std::vector<double>& getData() const;
+    std::size_t contentHash() const;
+
+private:
+    size_t rows_;
+    size_t cols_;
+    std::vector<double> data_;
+};
+
+// define-record-type 定义的记录类型：类型名和各字段名，字段下标即槽位号
+class RecordTypeValue : public Value {
+public:
+    RecordTypeValue(std::string name, std::vector<std::string> fields);
+
+    std::string toString() const override;
+    bool isSelfEvaluating() const override;
+    bool isNil() const override;
+    std::optional<std::string> asSymbol() const override;
+    std::vector<ValuePtr> toVector() const override;
+    double asNumber() const override;
+    bool isNumber() const override;
+    bool isList() const override;
+    bool isPair() const override;
+    bool isString() const override;
+    bool isProcedure() const override;
+    const std::string& getString() const override;
+
+    bool isBoolean() const override;
+    bool getValue() const override;
+    bool isSymbol() const override;
+    bool isTrue() const override;
+    bool operator==(const Value& other) const override;
+
+    std::string getType() const override;
+
+    const std::string& getName() const;
+    const std::vector<std::string>& getFields() const;
+
+private:
+    std::string name_;
+    std::vector<std::string> fields_;
+};
+
+// 记录实例。槽位数组紧跟在对象之后，与对象头在同一次分配中，
+// 读取字段只需一次类型检查和一次访存。记录通常比创建它的求值
+// 活得更久，因此不在请求区域中分配
+class RecordValue : public Value {
+public:
+    // 创建槽位均为空表的实例
+    static Ref<RecordValue> make(Ref<RecordTypeValue> type);
+    ~RecordValue() override;
+
+    // 槽位与对象一起分配，释放时也一起归还
+    static void operator delete(void* ptr);
+
+    std::string toString() const override;
+    bool isSelfEvaluating() const override;
+    bool isNil() const override;
+    std::optional<std::string> asSymbol() const override;
+    std::vector<ValuePtr> toVector() const override;
+    double asNumber() const override;
+    bool isNumber() const override;
+    bool isList() const override;
+    bool isPair() const override;
+    bool isString() const override;
+    bool isProcedure() const override;
+    const std::string& getString() const override;
+
+    bool isBoolean() const override;
+    bool getValue() const override;
+    bool isSymbol() const override;
+    bool isTrue() const override;
+    bool operator==(const Value& other) const override;
+
+    std::string getType() const override;
+
+    const RecordTypeValue* getRecordType() const {
+        return type_.get();
+    }
+    const ValuePtr& slot(size_t index) const {
+        return slots()[index];
+    }
+    void setSlot(size_t index, ValuePtr value) {
+        slots()[index] = std::move(value);
+    }
+
+private:
+    explicit RecordValue(Ref<RecordTypeValue> type);
+
+    ValuePtr* slots() const {
+        return reinterpret_cast<ValuePtr*>(const_cast<RecordValue*>(this) + 1);
+    }
+
+    Ref<RecordTypeValue> type_;
+};
+
+// define-record-type 生成的过程，固定绑定到某个记录类型和槽位
+class RecordProcValue : public Value {
+public:
+    enum class Kind { Constructor, Predicate, Accessor, Modifier };
+
+    // 构造器的 slots 为各参数依次写入的槽位；访问器和修改器只用 slots[0]
+    RecordProcValue(Kind kind, Ref<RecordTypeValue> type,
+                    std::vector<size_t> slots, std::string name);
+
+    std::string toString() const override;
+    bool isSelfEvaluating() const override;
+    bool isNil() const override;
+    std::optional<std::string> asSymbol() const override;
+    std::vector<ValuePtr> toVector() const override;
+    double asNumber() const override;
+    bool isNumber() const override;
+    bool isList() const override;
+    bool isPair() const override;
+    bool isString() const override;
+    bool isProcedure() const override;
+    const std::string& getString() const override;
+
+    bool isBoolean() const override;
+    bool getValue() const override;
+    bool isSymbol() const override;
+    bool isTrue() const override;
+    bool operator==(const Value& other) const override;
+
+    std::string getType() const override;
+
+    ValuePtr apply(const std::vector<ValuePtr>& args) const;
+
+private:
+    // 检查参数是该类型的记录
+    RecordValue& checkRecord(const ValuePtr& value) const;
+
+    Kind kind_;
+    Ref<RecordTypeValue> type_;
+    std::vector<size_t> slots_;
+    std::string name_;
+};
+
+// memoize 产生的过程：以参数的结构哈希（equal? 语义）为键缓存被包装过程的
+// 结果，条目超过容量时淘汰最久未使用的一项。缓存的参数之后不应再被修改
+class MemoizedValue : public Value {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    // name 为空时表示匿名过程
+    MemoizedValue(ValuePtr proc, size_t capacity, std::string name = "");
+
+    std::string toString() const override;
+    bool isSelfEvaluating() const override;
+    bool isNil() const override;
+    std::optional<std::string> asSymbol() const override;
+    std::vector<ValuePtr> toVector() const override;
+    double asNumber() const override;
+    bool isNumber() const override;
+    bool isList() const override;
+    bool isPair() const override;
+    bool isString() const override;
+    bool isProcedure() const override;
+    const std::string& getString() const override;
+
+    bool isBoolean() const override;
+    bool getValue() const override;
+    bool isSymbol() const override;
+    bool isTrue() const override;
+    bool operator==(const Value& other) const override;
+
+    std::string getType() const override;
+
+    ValuePtr apply(const std::vector<ValuePtr>& args, EvalEnv& env);
+    void clear();
+    size_t hits() const {
+        return hits_;
+    }
+    size_t misses() const {
+        return misses_;
+    }
+    size_t size() const {
+        return entries_.size();
+    }
+    size_t capacity() const {
+        return capacity_;
+    }
+
+private:
+    struct Entry {
+        std::vector<ValuePtr> args;
+        ValuePtr result;
+        size_t hash;
+    };
+    using EntryList = std::list<Entry>;
+
+    // 索引的键指向条目中保存的参数；查找时指向本次调用的参数，不必复制
+    struct Key {
+        const std::vector<ValuePtr>* args;
+        size_t hash;
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return key.hash;
+        }
+    };
+    struct KeyEqual {
+        bool operator()(const Key& a, const Key& b) const;
+    };
+
+    ValuePtr proc_;
+    size_t capacity_;
+    std::string name_;
+    EntryList entries_;  // 最近使用的在前
+    std::unordered_map<Key, EntryList::iterator, KeyHash, KeyEqual> index_;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+};
+
+// 持久化字典（pmap）或集合（pset），结构见 persistent.h。
+// 更新返回新值，旧值保持不变；集合中每个键对应的值都是 #t。
+// 节点在各版本间共享、寿命无法预知，因此总在对象池中创建
+class PersistentMapValue : public Value {
+public:
+    enum class Kind { Map, Set };
+
+    PersistentMapValue(PersistentMap map, Kind kind);
+
+    std::string toString() const override;
+    bool isSelfEvaluating() const override;
+    bool isNil() const override;
+    std::optional<std::string> asSymbol() const override;
+    std::vector<ValuePtr> toVector() const override;
+    double asNumber() const override;
+    bool isNumber() const override;
+    bool isList() const override;
+    bool isPair() const override;
+    bool isString() const override;
+    bool isProcedure() const override;
+    const std::string& getString() const override;
+
+    bool isBoolean() const override;
+    bool getValue() const override;
+    bool isSymbol() const override;
+    bool isTrue() const override;
+    bool operator==(const Value& other) const override;
+
+    std::string getType() const override;
+
+    Kind kind() const {
+        return kind_;
+    }
+    const PersistentMap& getMap() const {
+        return map_;
+    }
+    std::size_t contentHash() const;
+
+private:
+    PersistentMap map_;
+    Kind kind_;
+};
+
+// 持久化向量（pvec），结构见 persistent.h。与 PersistentMapValue 相同，
+// 总在对象池中创建
+class PersistentVectorValue : public Value {
+public:
+    explicit PersistentVectorValue(PersistentVector vector);
+
+    std::string toString() const override;
+    bool isSelfEvaluating() const override;
+    bool isNil() const override;
+    std::optional<std::string> asSymbol() const override;
+    std::vector<ValuePtr> toVector() const override;
+    double asNumber() const override;
+    bool isNumber() const override;
+    bool isList() const override;
+    bool isPair() const override;
+    bool isString() const override;
+    bool isProcedure() const override;
+    const std::string& getString() const override;
+
+    bool isBoolean() const override;
+    bool getValue() const override;
+    bool isSymbol() const override;
+    bool isTrue() const override;
+    bool operator==(const Value& other) const override;
+
+    std::string getType() const override;
+
+    const PersistentVector& getVector() const {
+        return vector_;
+    }
+    std::size_t contentHash() const;
+
+private:
+    PersistentVector vector_;
+};
+
+// 开放寻址（线性探测）的哈希表。键的比较方式在创建时确定：
+// Eqv 与 eq?/eqv? 一致（符号按名字、数字按值，其余按对象身份），
+// Equal 与 equal? 一致（使用 equalHash）。删除时留下墓碑，扩容时清除
+class HashTableValue : public Value {
+public:
+    enum class KeyEquality { Eqv, Equal };
+
+    explicit HashTableValue(KeyEquality equality);
+
+    std::string toString() const override;
+    bool isSelfEvaluating() const override;
+    bool isNil() const override;
+    std::optional<std::string> asSymbol() const override;
+    std::vector<ValuePtr> toVector() const override;
+    double asNumber() const override;
+    bool isNumber() const override;
+    bool isList() const override;
+    bool isPair() const override;
+    bool isString() const override;
+    bool isProcedure() const override;
+    const std::string& getString() const override;
+
+    bool isBoolean() const override;
+    bool getValue() const override;
+    bool isSymbol() const override;
+    bool isTrue() const override;
+    bool operator==(const Value& other) const override;
+
+    std::string getType() const override;
+
+    // 找不到时返回 nullptr
+    const ValuePtr* find(const ValuePtr& key) const;
+    void set(ValuePtr key, ValuePtr value);
+    bool remove(const ValuePtr& key);
+    void clear();
+    size_t size() const;
+
+    // 依次访问每个条目。回调中修改本表时，已经访问过或尚未访问的条目
+    // 可能被跳过或重复访问，但不会访问已释放的内存
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (size_t i = 0; i < slots_.size(); i++) {
+            if (slots_[i].state != SlotState::Full) continue;
+            ValuePtr key = slots_[i].key;
+            ValuePtr value = slots_[i].value;
+            fn(key, value);
+        }
+    }
+
+private:
+    enum class SlotState : unsigned char { Empty, Full, Deleted };
+    struct Slot {
+        ValuePtr key;
+        ValuePtr value;
+        size_t hash = 0;
+        SlotState state = SlotState::Empty;
+    };
+
+    size_t hashKey(const ValuePtr& key) const;
+    bool keysEqual(const ValuePtr& a, const ValuePtr& b) const;
+    // 返回键所在的槽位，不存在时返回 slots_.size()
+    size_t findSlot(const ValuePtr& key, size_t hash) const;
+    void rehash(size_t capacity);
+
+    KeyEquality equality_;
+    std::vector<Slot> slots_;  // 容量总是 2 的幂（或为空）
+    size_t size_ = 0;          // 有效条目数
+    size_t used_ = 0;          // 有效条目与墓碑的总数，决定何时扩容
+};
+
+// 按键排序的字典（omap），键为数字或字符串，结构见 btree.h。
+// 可以被修改，通常长期存活，因此总在对象池中创建
+class OrderedMapValue : public Value {
+public:
+    OrderedMapValue() = default;
+
+    std::string toString() const override;
+    bool isSelfEvaluating() const override;
+    bool isNil() const override;
+    std::optional<std::string> asSymbol() const override;
+    std::vector<ValuePtr> toVector() const override;
+    double asNumber() const override;
+    bool isNumber() const override;
+    bool isList() const override;
+    bool isPair() const override;
+    bool isString() const override;
+    bool isProcedure() const override;
+    const std::string& getString() const override;
+
+    bool isBoolean() const override;
+    bool getValue() const override;
+    bool isSymbol() const override;
+    bool isTrue() const override;
+    bool operator==(const Value& other) const override;
+
+    std::string getType() const override;
+
+    BTreeMap& getTree() {
+        return tree_;
+    }
+    const BTreeMap& getTree() const {
+        return tree_;
+    }
+
+private:
+    BTreeMap tree_;
+};
+
+// omap-range 产生的惰性列表：每个节点对应区间中的一个条目 (key . value)，
+// 取 cdr 时才在树中前进一步，不预先复制区间。遍历期间字典被修改时，
+// 按当前键重新定位，结果为修改后字典中紧随其后的条目
+class OrderedRangeValue : public Value {
+public:
+    // 从第一个不小于 lower 的键开始，到第一个不小于 upper 的键之前结束；
+    // lower/upper 为空句柄时不设该侧边界。区间为空时返回空表
+    static ValuePtr make(Ref<OrderedMapValue> map, const ValuePtr& lower,
+                         const ValuePtr& upper);
+
+    OrderedRangeValue(Ref<OrderedMapValue> map, BTreeMap::Position position,
+                      ValuePtr upper);
+    OrderedRangeValue(const OrderedRangeValue& other);  // 不复制已缓存的 car/cdr
+
+    std::string toString() const override;
+    bool isSelfEvaluating() const override;
+    bool isNil() const override;
+    std::optional<std::string> asSymbol() const override;
+    std::vector<ValuePtr> toVector() const override;
+    double asNumber() const override;
+    bool isNumber() const override;
+    bool isList() const override;
+    bool isPair() const override;
+    bool isString() const override;
+    bool isProcedure() const override;
+    const std::string& getString() const override;
+
+    bool isBoolean() const override;
+    bool getValue() const override;
+    bool isSymbol() const override;
+    bool isTrue() const override;
+    bool operator==(const Value& other) const override;
+
+    std::string getType() const override;
+
+    const ValuePtr& getCar() const override;
+    const ValuePtr& getCdr() const override;
+
+private:
+    // position 无效或已到达上界时返回空表
+    static ValuePtr fromPosition(const Ref<OrderedMapValue>& map,
+                                 BTreeMap::Position position,
+                                 const ValuePtr& upper);
+
+    Ref<OrderedMapValue> map_;
+    BTreeMap::Position position_;
+    std::uint64_t version_;  // 创建时字典的版本，不同则 position_ 已失效
+    ValuePtr key_;
+    ValuePtr value_;
+    ValuePtr upper_;
+    mutable ValuePtr car_;
+    mutable ValuePtr cdr_;
+};
+
+// 输出端口对象，由 open-output-file、open-output-string 等创建，
+// 相等性按对象身份比较
+class PortValue : public Value {
+public:
+    explicit PortValue(std::shared_ptr<OutputPort> port);
+
+    std::string toString() const override;
+    bool isSelfEvaluating() const override;
+    bool isNil() const override;
+    std::optional<std::string> asSymbol() const override;
+    std::vector<ValuePtr> toVector() const override;
+    double asNumber() const override;
+    bool isNumber() const override;
+    bool isList() const override;
+    bool isPair() const override;
+    bool isString() const override;
+    bool isProcedure() const override;
+    const std::string& getString() const override;
+
+    bool isBoolean() const override;
+    bool getValue() const override;
+    bool isSymbol() const override;
+    bool isTrue() const override;
+    bool operator==(const Value& other) const override;
+
+    std::string getType() const override;
+
+    const std::shared_ptr<OutputPort>& getPort() const {
+        return port_;
+    }
+
+private:
+    std::shared_ptr<OutputPort> port_;
+};
+
+// 惰性整数区间：start, start+step, ... 共 count 个元素，count 至少为 1
+// 表现为一个正常列表，car/cdr 时按需产生元素，不预先构造 PairValue
+class RangeValue : public Value {
+public:
+    RangeValue(double start, double step, size_t count);
+    RangeValue(const RangeValue& other);  // 不复制已缓存的 car/cdr
+
+    std::string toString() const override;
+    bool isSelfEvaluating() const override;
+    bool isNil() const override;
+    std::optional<std::string> asSymbol() const override;
+    std::vector<ValuePtr> toVector() const override;
+    double asNumber() const override;
+    bool isNumber() const override;
+    bool isList() const override;
+    bool isPair() const override;
+    bool isString() const override;
+    bool isProcedure() const override;
+    const std::string& getString() const override;
+
+    bool isBoolean() const override;
+    bool getValue() const override;
+    bool isSymbol() const override;
+    bool isTrue() const override;
+    bool operator==(const Value& other) const override;
+
+    std::string getType() const override;
+
+    const ValuePtr& getCar() const override;
+    const ValuePtr& getCdr() const override;
+    size_t size() const;
+    double at(size_t index) const;
+
+private:
+    double start_;
+    double step_;
+    size_t count_;
+    // car/cdr 第一次被访问时才创建
+    mutable ValuePtr car_;
+    mutable ValuePtr cdr_;
+};
+
+// CDR 编码的紧凑列表：连续的元素存放在一块共享的连续存储中
+// 本节点表示从 offset 开始的后缀，取 cdr 时才按需产生新的视图节点
+class CompactListValue : public Value {
+public:
+    using Block = std::vector<ValuePtr>;
+
+    CompactListValue(std::shared_ptr<const Block> block, size_t offset,
+                     ValuePtr tail);
+    // 由元素构造列表，元素为空时直接返回 tail（默认为空表）
+    static ValuePtr fromVector(Block elements, ValuePtr tail = nullptr);
+
+    std::string toString() const override;
+    bool isSelfEvaluating() const override;
+    bool isNil() const override;
+    std::optional<std::string> asSymbol() const override;
+    std::vector<ValuePtr> toVector() const override;
+    double asNumber() const override;
+    bool isNumber() const override;
+    bool isList() const override;
+    bool isPair() const override;
+    bool isString() const override;
+    bool isProcedure() const override;
+    const std::string& getString() const override;
+
+    bool isBoolean() const override;
+    bool getValue() const override;
+    bool isSymbol() const override;
+    bool isTrue() const override;
+    bool operator==(const Value& other) const override;
+
+    std::string getType() const override;
+
+    const ValuePtr& getCar() const override;
+    const ValuePtr& getCdr() const override;
+    // 本段中的元素（不含 tail）
+    const ValuePtr* begin() const;
+    const ValuePtr* end() const;
+    size_t size() const;
+    const ValuePtr& getTail() const;
+
+    const HashCache& hashCache() const {
+        return hash_;
+    }
+
+private:
+    std::shared_ptr<const Block> block_;
+    size_t offset_;
+    ValuePtr tail_;
+    mutable ValuePtr cdr_;  // 第一次取 cdr 时才拆分出的视图节点
+    HashCache hash_;        // equalHash 的缓存（本节点表示的整个后缀）
+};
+
+// 沿 car/cdr 链遍历列表的前向迭代器，不复制元素、不增减引用计数。
+// 紧凑列表直接按块遍历，区间按下标产生元素，都不会创建 cdr 视图节点。
+// 遍历到结尾时若遇到非空表的值（非正规列表），递增操作抛出 LispError；
+// 以 allowImproper 构造时改为正常结束，结尾的值由 tail() 取得
+class ListIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = ValuePtr;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const ValuePtr*;
+    using reference = const ValuePtr&;
+
+    ListIterator() = default;  // 结束位置
+    explicit ListIterator(const Value* list, bool allowImproper = false)
+        : allowImproper_(allowImproper) {
+        enter(list);
+    }
+
+    reference operator*() const {
+        return kind_ == Kind::Range ? item_ : *cur_;
+    }
+    pointer operator->() const {
+        return &**this;
+    }
+    ListIterator& operator++() {
+        // 紧凑列表块内只需移动指针，其余情况交给 advance
+        if (kind_ != Kind::Compact || ++cur_ == last_) advance();
+        return *this;
+    }
+    ListIterator operator++(int) {
+        ListIterator old = *this;
+        ++*this;
+        return old;
+    }
+    bool operator==(const ListIterator& other) const {
+        if (kind_ == Kind::End || other.kind_ == Kind::End) {
+            return kind_ == other.kind_;
+        }
+        return node_ == other.node_ && cur_ == other.cur_ &&
+               index_ == other.index_;
+    }
+    // 遍历结束后列表结尾的值：正规列表为空表
+    const Value* tail() const {
+        return kind_ == Kind::End && node_ ? node_ : makeNil().get();
+    }
+
+private:
+    enum class Kind { End, Pair, Compact, Range };
+
+    // 进入一个新的节点，确定它的遍历方式
+    void enter(const Value* node);
+    void advance();
+
+    Kind kind_ = Kind::End;
+    bool allowImproper_ = false;
+    const Value* node_ = nullptr;  // 当前节点，结束后为结尾的值
+    const ValuePtr* cur_ = nullptr;   // 序对的 car 或紧凑列表中的当前元素
+    const ValuePtr* last_ = nullptr;  // 紧凑列表本段的结尾
+    size_t index_ = 0;                // 区间中的下标
+    ValuePtr item_;                   // 区间中当前位置的元素
+};
+
+// 列表的只读视图，可直接用于范围 for 循环
+class ListView {
+public:
+    explicit ListView(ValuePtr list) : list_(std::move(list)) {}
+
+    ListIterator begin() const {
+        return ListIterator(list_.get());
+    }
+    ListIterator end() const {
+        return ListIterator();
+    }
+    bool empty() const {
+        return !list_->isPair();
+    }
+    size_t size() const;
+    std::vector<ValuePtr> toVector() const;
+
+private:
+    ValuePtr list_;
+};